@@ -74,7 +74,15 @@ build_main() {
     # clean the target folder for any previous compilation
     safe_rm -rf ${TARGET}
 
-    gcc -Wall -Werror \
+    # The bench build counts every heap allocation, those of libc included; the release build does not
+    BENCH_CFLAGS=
+    BENCH_LIBS=
+    if [ "$1" = "bench" ]; then
+        BENCH_CFLAGS=-DLOG_BENCH_MALLOC
+        BENCH_LIBS=-ldl
+    fi
+
+    gcc -O2 -Wall -Werror -pthread ${BENCH_CFLAGS} \
         src/check-tunnel.c \
         src/copy-folder.c \
         src/copy-if-not-exists.c \
@@ -82,14 +90,39 @@ build_main() {
         src/fix-docroot.c \
         src/get-file-permission.c \
         src/handle-exit.c \
+        src/hook.c \
+        src/io-policy.c \
         src/life-line.c \
+        src/log-archive.c \
+        src/log-async.c \
+        src/log-bench.c \
+        src/log-binary.c \
+        src/log-dedup.c \
+        src/log-flight.c \
+        src/log-forward.c \
+        src/log-level.c \
         src/log-message.c \
+        src/log-pipe.c \
+        src/log-query.c \
+        src/log-server.c \
+        src/log-sink.c \
+        src/log-spill.c \
+        src/log-stats.c \
+        src/log-sync.c \
         src/main.c \
         src/make-directory.c \
+        src/reaper.c \
         src/remove-old-log.c \
         src/set-file-permission.c \
+        src/startup.c \
+        src/supervise.c \
         src/sync-data-folder.c \
         src/sync-key.c \
+        src/task.c \
+        src/tunnel-probe.c \
+        src/tunnel.c \
+        src/wait-ms.c \
+        ${BENCH_LIBS} \
         -o ${TARGET}
 
     if [ $? -ne 0 ]; then
@@ -106,9 +139,22 @@ build_main() {
     elif [ "$1" = clean ]; then
         safe_rm -rf ${TARGET_DIR}/*
         echo "Folder ${TARGET_DIR} has been cleared!"
+    elif [ "$1" = "bench" ]; then
+        echo "Build successful! Please run '${TARGET} bench'"
     elif [ "$1" = "test" ]; then
         # Set the necessary variables
         tests/test.sh ${TARGET} tests/test-cases.txt
+        tests/test-reaper.sh ${TARGET}
+        tests/test-forward.sh ${TARGET}
+        tests/test-log-pipe.sh ${TARGET}
+        tests/test-log-cat.sh ${TARGET}
+        tests/test-ready.sh ${TARGET}
+        tests/test-log-async.sh ${TARGET}
+        tests/test-log-socket.sh ${TARGET}
+        tests/test-spill.sh ${TARGET}
+        tests/test-run.sh ${TARGET}
+        tests/test-dedup.sh ${TARGET}
+        tests/test-log-query.sh ${TARGET}
     elif [ "$1" = "compress" ]; then
         # create the target directory if it doesn't exist
         mkdir -p ${EXPORT_DIR}
@@ -1,5 +1,6 @@
 #include "copy-folder.h"
 #include "copy-if-not-exists.h"
+#include "log-level.h"
 #include "log-message.h"
 
 /**
@@ -38,7 +39,7 @@
  * @note #include <limits.h> // for PATH_MAX
  *
  * @see copy_if_not_exist() to copy a file if it does not exist in the destination folder.
- * @see log_message_w_thread() to log error messages to the log file.
+ * @see LOG_ERROR() to log error messages to the log file.
  * 
  * @date 2023-06-06
  * @author Cloudgen Wong
@@ -46,17 +47,11 @@
 void copyFolder(const char* sourceFolder, const char* destinationFolder, const char* thread_name, int debug_mode) {
   DIR* dir;
   struct dirent* entry;
-  char *s = NULL;
-  int len;
 
   // Open the source folder
   dir = opendir(sourceFolder);
   if (!dir) {
-    len = snprintf(NULL, 0, "Failed to open source folder: %s", sourceFolder) + 1;
-    s = malloc(len);
-    snprintf(s, len, "Failed to open source folder: %s", sourceFolder);
-    log_message_w_thread(thread_name, s);
-    free(s);
+    LOG_ERROR(LOG_MODULE_COPY, thread_name, "Failed to open source folder: %s", sourceFolder);
     return;
   }
 
@@ -64,11 +59,7 @@ void copyFolder(const char* sourceFolder, const char* destinationFolder, const c
   struct stat st;
   if (stat(destinationFolder, &st) == -1) {
     if (mkdir(destinationFolder, 0755) == -1) {
-      len = snprintf(NULL, 0, "Failed to create destination folder: %s", destinationFolder) + 1;
-      s = malloc(len);
-      snprintf(s, len, "Failed to create destination folder: %s", destinationFolder);
-      log_message_w_thread(thread_name, s);
-      free(s);
+      LOG_ERROR(LOG_MODULE_COPY, thread_name, "Failed to create destination folder: %s", destinationFolder);
       closedir(dir);
       return;
     }
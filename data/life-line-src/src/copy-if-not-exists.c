@@ -1,5 +1,8 @@
+/* O_DIRECT */
+#define _GNU_SOURCE
 #include "copy-if-not-exists.h"
-#include "get-file-permission.h"
+#include "io-policy.h"
+#include "log-level.h"
 #include "log-message.h"
 #include "set-file-permission.h"
 
@@ -11,18 +14,47 @@
  * @date 2023-05-11
  */
 
+/*
+ * Copy through an aligned buffer, for descriptors opened with O_DIRECT. The tail that is not a
+ * whole number of blocks is written after clearing O_DIRECT.
+ */
+static off_t copy_direct(int fd_src, int fd_dst) {
+  void *buf;
+  off_t done = 0;
+  if (posix_memalign(&buf, IO_POLICY_DIRECT_ALIGN, IO_POLICY_DIRECT_BUFFER) != 0) {
+    return -1;
+  }
+  for (;;) {
+    ssize_t num_read = read(fd_src, buf, IO_POLICY_DIRECT_BUFFER);
+    if (num_read <= 0) {
+      free(buf);
+      return num_read < 0 ? -1 : done;
+    }
+    if (num_read % IO_POLICY_DIRECT_ALIGN != 0) {
+      fcntl(fd_dst, F_SETFL, fcntl(fd_dst, F_GETFL) & ~O_DIRECT);
+    }
+    if (write(fd_dst, buf, num_read) != num_read) {
+      free(buf);
+      return -1;
+    }
+    done += num_read;
+  }
+}
+
 /**
  * @brief Copies a source file to a destination file if the destination file does not exist.
  * 
  * @details This function checks if the destination file exists. If the destination file does not exist,
  * it copies the contents of the source file to the destination file. It also sets the appropriate permissions
  * for the destination file and logs the relevant messages.
+ *
+ * The copy follows the I/O policy of io-policy.h: the source is read sequentially and dropped
+ * from the page cache, a large destination is synced and dropped too, and files of at least
+ * LL_IO_DIRECT bytes are copied with O_DIRECT.
  * 
  * @note #include <sys/stat.h>, for stat
  * @note #include <fcntl.h>, for open, O_RDONLY, O_CREAT, O_WRONLY
  * @note #include <unistd.h>, for read, write, close
- * @note #include <stdio.h>, for snprintf
- * @note #include <stdlib.h>, for malloc
  * @note #include <sys/types.h>, for ssize_t
  * @note #include <sys/stat.h>, for chmod, S_IRUSR, S_IWUSR
  * 
@@ -34,7 +66,7 @@
  * @return int Returns 0 if the file is successfully copied or if the destination file already exists, 
  * and returns 1 if there is an error during the copying process.
  * 
- * @see debug_log_message_w_thread - Function to log debug messages with thread name
+ * @see LOG_DEBUG - Log a debug message, formatted only when the copy module is at debug level
  * 
  * @author Cloudgen Wong
  * @date 2023-05-11
@@ -42,78 +74,79 @@
 int copy_if_not_exist(const char *src_path, const char *dst_path, const char* thread_name, int debug_mode) {
   struct stat buffer;
   int fd_src, fd_dst;
-  char *s = NULL;
-  int len;
 
   // Check if the destination file exists
   if (stat(dst_path, &buffer) != 0) {
     // If the destination file doesn't exist, copy the source file to the destination
     fd_src = open(src_path, O_RDONLY);
     if (fd_src == -1) {
-      len = snprintf(NULL, 0, "Source file: %s not exists  ..No Action..", src_path);
-      s = malloc(len + 1);
-      snprintf(s, len + 1, "Source file: %s not exists  ..No Action..", src_path);
-      debug_log_message_w_thread(debug_mode, thread_name, s);
+      LOG_DEBUG(LOG_MODULE_COPY, debug_mode, thread_name, "Source file: %s not exists  ..No Action..", src_path);
       return 1;
     }
 
-    fd_dst = open(dst_path, O_CREAT | O_WRONLY, S_IRUSR | S_IWUSR);
+    struct stat src_st;
+    int direct = fstat(fd_src, &src_st) == 0 && io_policy_direct(src_st.st_size);
+    fd_dst = open(dst_path, O_CREAT | O_WRONLY | (direct ? O_DIRECT : 0), S_IRUSR | S_IWUSR);
+    if (fd_dst == -1 && direct && errno == EINVAL) {
+      // The file system does not support O_DIRECT
+      direct = 0;
+      fd_dst = open(dst_path, O_CREAT | O_WRONLY, S_IRUSR | S_IWUSR);
+    }
     if (fd_dst == -1) {
-      len = snprintf(NULL, 0, "Create %s ..Failed..", dst_path);
-      s = malloc(len + 1);
-      snprintf(s, len + 1, "Create %s ..Failed..", dst_path);
-      debug_log_message_w_thread(debug_mode, thread_name, s);
+      LOG_DEBUG(LOG_MODULE_COPY, debug_mode, thread_name, "Create %s ..Failed..", dst_path);
       close(fd_src);
       return 1;
     }
 
     // Copy the contents of the source file to the destination file
-    char buf[BUFSIZ];
-    ssize_t num_read;
-    while ((num_read = read(fd_src, buf, BUFSIZ)) > 0) {
-      if (write(fd_dst, buf, num_read) != num_read) {
-        len = snprintf(NULL, 0, "Write to %s ..Failed..", dst_path);
-        s = malloc(len + 1);
-        snprintf(s, len + 1, "Write to %s ..Failed..", dst_path);
-        debug_log_message_w_thread(debug_mode, thread_name, s);
-        close(fd_src);
-        close(fd_dst);
-        return 1;
+    off_t copied = 0;
+    if (direct && fcntl(fd_src, F_SETFL, O_DIRECT) == 0) {
+      copied = copy_direct(fd_src, fd_dst);
+    } else {
+      char buf[BUFSIZ];
+      ssize_t num_read;
+      if (direct) {
+        fcntl(fd_dst, F_SETFL, 0);
+        direct = 0;
+      }
+      io_policy_source(IO_PATH_COPY, fd_src);
+      while ((num_read = read(fd_src, buf, BUFSIZ)) > 0) {
+        if (write(fd_dst, buf, num_read) != num_read) {
+          copied = -1;
+          break;
+        }
+        copied += num_read;
       }
     }
+    if (copied < 0) {
+      LOG_DEBUG(LOG_MODULE_COPY, debug_mode, thread_name, "Write to %s ..Failed..", dst_path);
+      close(fd_src);
+      close(fd_dst);
+      return 1;
+    }
+    io_policy_read(IO_PATH_COPY, fd_src, copied);
+    io_policy_written(IO_PATH_COPY, copied);
+    if (direct) {
+      io_policy_direct_copied(IO_PATH_COPY, copied);
+    } else if (copied >= IO_POLICY_SYNC_MIN && !io_policy_keep_cache()) {
+      fdatasync(fd_dst);
+      io_policy_synced(IO_PATH_COPY, fd_dst);
+    }
 
     close(fd_src);
     close(fd_dst);
   } else {
-    len = snprintf(NULL, 0, "Target already exists: %s ..No Action..", dst_path);
-    s = malloc(len + 1);
-    snprintf(s, len + 1, "Target already exists: %s ..No Action..", dst_path);
-    debug_log_message_w_thread(debug_mode, thread_name, s);
-    free(s);
+    LOG_TRACE(LOG_MODULE_COPY, debug_mode, thread_name, "Target already exists: %s ..No Action..", dst_path);
     return 1;
   }
   // Get the source file attributes
   struct stat st;
   if (stat(src_path, &st) == -1) {
-    len = snprintf(NULL, 0,  "Get destination file attributes: %s ..Failed..", src_path);
-    s = malloc(len + 1);
-    snprintf(s, len + 1, "Get destination file attributes: %s ..Failed..", src_path);
-    debug_log_message_w_thread(debug_mode, thread_name, s);
-    free(s);
+    LOG_DEBUG(LOG_MODULE_COPY, debug_mode, thread_name, "Get destination file attributes: %s ..Failed..", src_path);
     return 1;
   } else {
     // Set the destination file attributes to match the source file
-    int permission = getPermissions(src_path, thread_name, debug_mode);
-    if (permission == -1) {
-      len = snprintf(NULL, 0,  "Get destination file %s permissions: %04o ..Failed..", dst_path, permission);
-      s = malloc(len + 1);
-      snprintf(s, len + 1, "Get destination file %s permissions: %04o ..Failed..", dst_path, permission);
-      debug_log_message_w_thread(debug_mode, thread_name, s);
-      free(s);
-      return 1;
-    } else {
-      setFilePermissions(dst_path, permission, thread_name, debug_mode);
-    }
+    setFilePermissions(dst_path, st.st_mode & 07777, thread_name, debug_mode);
   }
   return 0;
 }
\ No newline at end of file
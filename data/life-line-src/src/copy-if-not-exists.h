@@ -1,6 +1,7 @@
 #ifndef COPY_IF_NOT_EXISTS_H
 #define COPY_IF_NOT_EXISTS_H
 
+#include <errno.h>
 #include <fcntl.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -9,7 +10,7 @@
 
 /**
  * @note #include <sys/stat.h>, for stat
- * @note #include <fcntl.h>, for open, O_RDONLY, O_CREAT, O_WRONLY
+ * @note #include <fcntl.h>, for open, O_RDONLY, O_CREAT, O_WRONLY, O_DIRECT
  * @note #include <unistd.h>, for read, write, close
  * @note #include <stdio.h>, for snprintf
  * @note #include <stdlib.h>, for malloc
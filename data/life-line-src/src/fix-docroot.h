@@ -1,10 +1,20 @@
 #ifndef FIX_DOCROOT_H
 #define FIX_DOCROOT_H
 
-#include <stdlib.h> // for access(), system()
+#include <ftw.h> // for nftw()
+#include <stdlib.h> // for access()
+#include <string.h> // for strncmp()
+#include <strings.h> // for strcasecmp()
+#include <sys/stat.h> // for chmod()
+#include <unistd.h> // for chown(), unlink()
 
 /**
- * @note #include <stdlib.h> // for access(), system()
+ * @note #include <ftw.h> // for nftw()
+#include <stdlib.h> // for access()
+#include <string.h> // for strncmp()
+#include <strings.h> // for strcasecmp()
+#include <sys/stat.h> // for chmod()
+#include <unistd.h> // for chown(), unlink()
  *
  * @author Cloudgen Wong
  * @date 2023-06-26
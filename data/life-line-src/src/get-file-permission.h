@@ -3,9 +3,10 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <sys/stat.h>
 
 /**
- * @note #include <stdio.h> // for FILE, fscanf, popen, pclose
+ * @note #include <sys/stat.h> // for stat
  * @note #include <stdlib.h> // for malloc, free
  *
  * @author Cloudgen Wong
@@ -1,6 +1,14 @@
 #include "display-signal-message.h"
 #include "handle-exit.h"
+#include "log-async.h"
+#include "log-flight.h"
+#include "log-forward.h"
 #include "log-message.h"
+#include "log-server.h"
+#include "log-sink.h"
+#include "startup.h"
+#include "supervise.h"
+#include "tunnel.h"
 
 /**
  * @file handle-exit.c
@@ -20,18 +28,43 @@
  * @note #include <stdlib.h>, for exit
  *
  * @see display_signal_message
+ * @see supervise_stop
+ * @see log_async_drain
  * @see exit
  *
  * @return void
  *
- * @details This function is called when the program receives an exit signal. It displays a message indicating the type of signal received and exits the program.
+ * @details This function is called when the program receives an exit signal. It displays a
+ * message indicating the type of signal received, then shuts down in this order:
+ *
+ * - It removes READY_FILE.
+ * - It stops the supervised application and logs the rest of its output.
+ * - It stops the ssh of the tunnel, then the log socket.
+ * - It drains the asynchronous log queue.
+ * - It waits for the log collector to acknowledge the records sent to it.
+ * - It writes the lines held while the log volume was unwritable.
+ * - It reports the binary log records that could not be written.
+ * - It marks the flight recorder clean and exits the program.
+ *
+ * The daemon runs it in the reaper thread, which reads SIGINT and SIGTERM from a signalfd, so
+ * the logging and the exit() are not made inside a signal handler; it is only installed as one
+ * by signal_exit() when that thread could not be started.
  *
  * @date 2023-03-05
  * @author Cloudgen Wong
  */
 void handle_exit(int sig) {
   display_signal_message(sig);
+  startup_not_ready();
+  supervise_stop();
+  tunnel_stop();
+  log_server_stop();
   log_message("====== State: .*MAIN_LOOP* -> *END*.......... ======");
+  log_async_drain();
+  log_forward_drain();
+  log_sink_flush_spill(1);
+  log_report_unwritten("Thread_main");
+  log_flight_stop();
   exit(0);
 }
 
@@ -54,6 +87,7 @@ void handle_exit(int sig) {
  * @note #include <signal.h> // for signal, SIGINT, SIGTERM
  *
  * @see handle_exit() for the signal handler function.
+ * @see reaper_start(), which takes the signals in a thread instead.
  *
  * @author Cloudgen Wong
  * @date 2023-06-06
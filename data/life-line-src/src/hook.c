@@ -0,0 +1,314 @@
+#include "hook.h"
+#include "log-level.h"
+#include "project.h"
+#include "task.h"
+
+/**
+ * @file hook.c
+ * @brief The check-tunnel and start-tunnel hooks, kept current with inotify and run concurrently
+ *
+ * checkTunnel() used to build and access() 22 paths every 30 seconds: check-tunnel and
+ * check-tunnel0 to check-tunnel9 in /usr/bin and /usr/local/bin, and ran the hooks found one
+ * after another. The two directories are now read once, and an inotify watch on each keeps the
+ * registry current: a hook installed, removed, renamed or made executable is taken at the next
+ * check, without a scan. Any number may follow the name, check-tunnel20 as well as
+ * check-tunnel0.
+ *
+ * hook_run() runs the hooks of a kind at most LL_HOOK_PARALLEL at a time, the calling thread
+ * being one of the runners, so that the 20 tunnels of a gateway are checked within one interval.
+ * Each hook goes through task_run(), with its deadline and its output in the log.
+ *
+ * Without inotify, or for a directory that cannot be watched, the directory is read again at
+ * every call, as the access() calls did before.
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+
+static const char *hook_dirs[] = { TUNNEL_HOOK_DIR1, TUNNEL_HOOK_DIR2 };
+static const char *hook_names[HOOK_KIND_COUNT] = { TUNNEL_CHECK_HOOK, TUNNEL_START_HOOK };
+#define HOOK_DIRS ((int)(sizeof(hook_dirs) / sizeof(hook_dirs[0])))
+
+static pthread_mutex_t hook_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct hook *hooks = NULL;
+static int count = 0;
+static int capacity = 0;
+static int initialized = 0;
+static int inotify_fd = -1;
+static int watches[HOOK_DIRS] = { -1, -1 };
+
+/* The hooks of a batch of hook_run(), taken by the runners one at a time */
+struct hook_batch {
+  struct hook *hooks;
+  int count;
+  int next;
+  int failures;
+  const char *thread_name;
+};
+
+/* Tell whether a file name is a hook: its kind, and its number or -1 */
+static int hook_match(const char *name, enum hook_kind *kind, long *number) {
+  int k;
+  for (k = 0; k < HOOK_KIND_COUNT; k++) {
+    size_t len = strlen(hook_names[k]);
+    const char *p = name + len;
+    if (strncmp(name, hook_names[k], len) != 0) {
+      continue;
+    }
+    if (*p == '\0') {
+      *kind = (enum hook_kind)k;
+      *number = -1;
+      return 1;
+    }
+    if (strspn(p, "0123456789") == strlen(p) && strlen(p) <= 9) {
+      *kind = (enum hook_kind)k;
+      *number = atol(p);
+      return 1;
+    }
+  }
+  return 0;
+}
+
+static int hook_compare(const void *a, const void *b) {
+  const struct hook *x = a, *y = b;
+  if (x->kind != y->kind) {
+    return x->kind < y->kind ? -1 : 1;
+  }
+  if (x->number != y->number) {
+    return x->number < y->number ? -1 : 1;
+  }
+  return x->dir - y->dir;
+}
+
+static void hook_remove(int index) {
+  memmove(&hooks[index], &hooks[index + 1], (count - index - 1) * sizeof(struct hook));
+  count--;
+}
+
+/* Add, keep or drop a file of a hook directory, after whether it is executable; with the lock */
+static void hook_update(int dir, const char *name) {
+  char path[HOOK_PATH_MAX];
+  enum hook_kind kind;
+  long number;
+  int i, executable;
+  if (!hook_match(name, &kind, &number) || snprintf(path, sizeof(path), "%s%s", hook_dirs[dir], name) >=
+      (int)sizeof(path)) {
+    return;
+  }
+  executable = access(path, X_OK) == 0;
+  for (i = 0; i < count; i++) {
+    if (strcmp(hooks[i].path, path) == 0) {
+      if (!executable) {
+        hook_remove(i);
+      }
+      return;
+    }
+  }
+  if (!executable) {
+    return;
+  }
+  if (count == capacity) {
+    int grown = capacity == 0 ? 16 : capacity * 2;
+    struct hook *p = realloc(hooks, grown * sizeof(struct hook));
+    if (p == NULL) {
+      return;
+    }
+    hooks = p;
+    capacity = grown;
+  }
+  hooks[count].kind = kind;
+  hooks[count].dir = dir;
+  hooks[count].number = number;
+  memcpy(hooks[count].path, path, sizeof(path));
+  count++;
+  qsort(hooks, count, sizeof(struct hook), hook_compare);
+}
+
+/* Read a hook directory again; with the lock */
+static void hook_scan(int dir) {
+  struct dirent *entry;
+  DIR *d;
+  int i;
+  for (i = count - 1; i >= 0; i--) {
+    if (hooks[i].dir == dir) {
+      hook_remove(i);
+    }
+  }
+  d = opendir(hook_dirs[dir]);
+  if (d == NULL) {
+    return;
+  }
+  while ((entry = readdir(d)) != NULL) {
+    hook_update(dir, entry->d_name);
+  }
+  closedir(d);
+}
+
+static void hook_watch(int dir) {
+  if (inotify_fd >= 0) {
+    watches[dir] = inotify_add_watch(inotify_fd, hook_dirs[dir],
+      IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_ATTRIB | IN_ONLYDIR);
+  }
+}
+
+/* Bring the registry up to date: the first call scans, the next ones read the inotify events */
+static void hook_refresh(void) {
+  char buf[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+  const struct inotify_event *event;
+  ssize_t n;
+  char *p;
+  int dir;
+  if (!initialized) {
+    initialized = 1;
+    inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    for (dir = 0; dir < HOOK_DIRS; dir++) {
+      hook_watch(dir);
+      hook_scan(dir);
+    }
+    return;
+  }
+  for (dir = 0; dir < HOOK_DIRS; dir++) {
+    if (watches[dir] < 0) {
+      // Not watched: created since, or no inotify at all
+      hook_watch(dir);
+      hook_scan(dir);
+    }
+  }
+  while (inotify_fd >= 0 && (n = read(inotify_fd, buf, sizeof(buf))) > 0) {
+    for (p = buf; p < buf + n; p += sizeof(struct inotify_event) + event->len) {
+      event = (const struct inotify_event *)p;
+      if (event->mask & IN_Q_OVERFLOW) {
+        for (dir = 0; dir < HOOK_DIRS; dir++) {
+          hook_scan(dir);
+        }
+        continue;
+      }
+      for (dir = 0; dir < HOOK_DIRS && watches[dir] != event->wd; dir++) {
+      }
+      if (dir == HOOK_DIRS) {
+        continue;
+      }
+      if (event->mask & IN_IGNORED) {
+        // The directory is gone
+        watches[dir] = -1;
+        hook_scan(dir);
+      } else if (event->len > 0) {
+        hook_update(dir, event->name);
+      }
+    }
+  }
+}
+
+static void *hook_runner(void *arg) {
+  struct hook_batch *batch = arg;
+  int i;
+  while ((i = __atomic_fetch_add(&batch->next, 1, __ATOMIC_ACQ_REL)) < batch->count) {
+    char *argv[] = { batch->hooks[i].path, NULL };
+    struct task t = { batch->hooks[i].path, argv, 0, LOG_MODULE_TUNNEL, batch->thread_name };
+    if (task_run(&t, NULL) != 0) {
+      __atomic_add_fetch(&batch->failures, 1, __ATOMIC_ACQ_REL);
+    }
+    LOG_INFO(LOG_MODULE_TUNNEL, batch->thread_name, "Tunnel: %s has been checked.", batch->hooks[i].path);
+  }
+  return NULL;
+}
+
+/**
+ * @brief Tell whether check-tunnel or start-tunnel itself is installed.
+ *
+ * @param kind HOOK_CHECK or HOOK_START.
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+int hook_exists(enum hook_kind kind) {
+  int i, found = 0;
+  pthread_mutex_lock(&hook_lock);
+  hook_refresh();
+  for (i = 0; i < count && !found; i++) {
+    found = hooks[i].kind == kind && hooks[i].number < 0;
+  }
+  pthread_mutex_unlock(&hook_lock);
+  return found;
+}
+
+/**
+ * @brief The number of hooks of a kind installed, check-tunnel itself included.
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+int hook_count(enum hook_kind kind) {
+  int i, n = 0;
+  pthread_mutex_lock(&hook_lock);
+  hook_refresh();
+  for (i = 0; i < count; i++) {
+    n += hooks[i].kind == kind;
+  }
+  pthread_mutex_unlock(&hook_lock);
+  return n;
+}
+
+/**
+ * @brief Run the hooks of a kind, at most LL_HOOK_PARALLEL at a time.
+ *
+ * @param kind HOOK_CHECK or HOOK_START.
+ * @param with_base Whether to run check-tunnel or start-tunnel itself, the one of /usr/bin
+ * rather than the one of /usr/local/bin, besides the numbered hooks of both directories.
+ * @param thread_name The thread logging the hooks.
+ * @param ran Receives the number of hooks run, unless NULL.
+ *
+ * @return The number of hooks that failed to start or exited with a non-zero status.
+ *
+ * @details Returns once every hook has ended, or was killed at its deadline.
+ *
+ * @see task_run()
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+int hook_run(enum hook_kind kind, int with_base, const char *thread_name, int *ran) {
+  pthread_t tids[HOOK_PARALLEL_MAX];
+  struct hook_batch batch;
+  const char *env = getenv("LL_HOOK_PARALLEL");
+  int parallel = env != NULL && atoi(env) > 0 ? atoi(env) : HOOK_PARALLEL;
+  int i, base = 0, started = 0;
+  batch.hooks = NULL;
+  batch.count = 0;
+  batch.next = 0;
+  batch.failures = 0;
+  batch.thread_name = thread_name;
+  pthread_mutex_lock(&hook_lock);
+  hook_refresh();
+  if (count > 0) {
+    batch.hooks = malloc(count * sizeof(struct hook));
+  }
+  for (i = 0; i < count && batch.hooks != NULL; i++) {
+    if (hooks[i].kind != kind || (hooks[i].number < 0 && (!with_base || base++ > 0))) {
+      continue;
+    }
+    batch.hooks[batch.count++] = hooks[i];
+  }
+  pthread_mutex_unlock(&hook_lock);
+  if (ran != NULL) {
+    *ran = batch.count;
+  }
+  if (parallel > HOOK_PARALLEL_MAX) {
+    parallel = HOOK_PARALLEL_MAX;
+  }
+  if (parallel > batch.count) {
+    parallel = batch.count;
+  }
+  // The calling thread is a runner as well
+  for (i = 1; i < parallel; i++) {
+    if (pthread_create(&tids[started], NULL, hook_runner, &batch) == 0) {
+      started++;
+    }
+  }
+  hook_runner(&batch);
+  for (i = 0; i < started; i++) {
+    pthread_join(tids[i], NULL);
+  }
+  free(batch.hooks);
+  return batch.failures;
+}
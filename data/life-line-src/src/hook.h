@@ -0,0 +1,52 @@
+#ifndef HOOK_H
+#define HOOK_H
+
+/**
+ * @file hook.h
+ * @brief The check-tunnel and start-tunnel hooks, kept current with inotify and run concurrently
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+
+#include <dirent.h>
+#include <errno.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+/* The hooks running at once; LL_HOOK_PARALLEL sets it */
+#define HOOK_PARALLEL 8
+#define HOOK_PARALLEL_MAX 64
+#define HOOK_PATH_MAX (sizeof("/usr/local/bin/") + NAME_MAX)
+
+enum hook_kind {
+  HOOK_CHECK,     /* check-tunnel, check-tunnelN */
+  HOOK_START,     /* start-tunnel, start-tunnelN */
+  HOOK_KIND_COUNT
+};
+
+struct hook {
+  enum hook_kind kind;
+  int dir;                    /* the index of the hook directory, 0 for TUNNEL_HOOK_DIR1 */
+  long number;                /* N of check-tunnelN, -1 for check-tunnel itself */
+  char path[HOOK_PATH_MAX];
+};
+
+/**
+ * @note #include <sys/inotify.h>, for inotify_init1, inotify_add_watch
+ * @note #include <dirent.h>, for opendir
+ * @note #include <pthread.h>, for pthread_create
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+int hook_exists(enum hook_kind kind);
+int hook_run(enum hook_kind kind, int with_base, const char *thread_name, int *ran);
+int hook_count(enum hook_kind kind);
+
+#endif /* HOOK_H */
@@ -0,0 +1,209 @@
+/* sync_file_range() */
+#define _GNU_SOURCE
+#include "io-policy.h"
+
+/**
+ * @file io-policy.c
+ * @brief Keep the log writes and the folder copies from filling the page cache
+ *
+ * Log lines and copied files are written once and rarely read back, yet every page of them
+ * stays cached and evicts the working set of the app sharing the container. Copy sources are
+ * read with POSIX_FADV_SEQUENTIAL and POSIX_FADV_NOREUSE and dropped once read, and written
+ * files are advised with POSIX_FADV_DONTNEED once they have been synced (the kernel only drops
+ * clean pages). Files that are not synced get their writeback started instead, and the pages
+ * cleaned by the previous one are dropped.
+ *
+ * LL_IO_CACHE=keep turns the advice off; LL_IO_DIRECT=SIZE copies the files of at least SIZE
+ * bytes (with a K, M or G suffix) with O_DIRECT instead.
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+
+static int keep_cache = 0;
+static off_t direct_min = 0;
+static struct io_counters counters[IO_PATH_MAX];
+
+static const char *const path_names[] = {"log", "sink", "copy"};
+
+static void count(unsigned long long *counter, off_t value) {
+  __atomic_fetch_add(counter, (unsigned long long)value, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief Apply LL_IO_CACHE ("keep" or "drop", the default) and LL_IO_DIRECT.
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+void io_policy_init_from_env(void) {
+  const char *cache = getenv("LL_IO_CACHE");
+  const char *direct = getenv("LL_IO_DIRECT");
+  if (cache != NULL) {
+    keep_cache = strcmp(cache, "keep") == 0;
+  }
+  if (direct != NULL && *direct) {
+    char *end;
+    long long size = strtoll(direct, &end, 10);
+    if (*end == 'K' || *end == 'k') {
+      size *= 1024;
+    } else if (*end == 'M' || *end == 'm') {
+      size *= 1024 * 1024;
+    } else if (*end == 'G' || *end == 'g') {
+      size *= 1024 * 1024 * 1024;
+    }
+    direct_min = size > 0 ? (off_t)size : 0;
+  }
+}
+
+/**
+ * @brief Tell whether written files keep their pages in the cache (LL_IO_CACHE=keep).
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+int io_policy_keep_cache(void) {
+  return keep_cache;
+}
+
+/**
+ * @brief Tell whether a file of this size is copied with O_DIRECT.
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+int io_policy_direct(off_t size) {
+  return direct_min > 0 && size >= direct_min;
+}
+
+/**
+ * @brief Announce a file that is about to be read once from start to end.
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+void io_policy_source(enum io_path path, int fd) {
+  (void)path;
+  if (keep_cache) {
+    return;
+  }
+  posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+  posix_fadvise(fd, 0, 0, POSIX_FADV_NOREUSE);
+}
+
+/**
+ * @brief Count a file read through, and drop its pages.
+ *
+ * @param path The write path the read belongs to.
+ * @param fd The file.
+ * @param len The bytes read.
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+void io_policy_read(enum io_path path, int fd, off_t len) {
+  count(&counters[path].read, len);
+  if (!keep_cache && posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED) == 0) {
+    count(&counters[path].drops, 1);
+  }
+}
+
+/**
+ * @brief Count bytes written.
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+void io_policy_written(enum io_path path, off_t len) {
+  count(&counters[path].written, len);
+}
+
+/**
+ * @brief Drop the pages of a file once it has been synced.
+ *
+ * @param path The write path.
+ * @param fd The file, just synced by the caller.
+ *
+ * @details The whole file is advised: pages dirtied meanwhile stay cached and go at a later
+ * call.
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+void io_policy_synced(enum io_path path, int fd) {
+  count(&counters[path].syncs, 1);
+  if (!keep_cache && posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED) == 0) {
+    count(&counters[path].drops, 1);
+  }
+}
+
+/**
+ * @brief Drop the pages of a file that is not synced.
+ *
+ * @param path The write path.
+ * @param fd The file.
+ *
+ * @details The writeback of the dirty pages is started without waiting for it, and the pages
+ * already written back, e.g. by the previous call, are dropped. Called about once a minute per
+ * file, a log keeps a minute or two of lines in the cache.
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+void io_policy_writeback(enum io_path path, int fd) {
+  if (keep_cache) {
+    return;
+  }
+  sync_file_range(fd, 0, 0, SYNC_FILE_RANGE_WRITE);
+  if (posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED) == 0) {
+    count(&counters[path].drops, 1);
+  }
+}
+
+/**
+ * @brief Count bytes copied with O_DIRECT, which never entered the page cache.
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+void io_policy_direct_copied(enum io_path path, off_t len) {
+  count(&counters[path].direct, len);
+}
+
+/**
+ * @brief Read the counters of a write path.
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+void io_policy_counters(enum io_path path, struct io_counters *out) {
+  out->written = __atomic_load_n(&counters[path].written, __ATOMIC_RELAXED);
+  out->read = __atomic_load_n(&counters[path].read, __ATOMIC_RELAXED);
+  out->drops = __atomic_load_n(&counters[path].drops, __ATOMIC_RELAXED);
+  out->direct = __atomic_load_n(&counters[path].direct, __ATOMIC_RELAXED);
+  out->syncs = __atomic_load_n(&counters[path].syncs, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief Describe the I/O of every write path since the start.
+ *
+ * @param buf Receives "cache drop" or "cache keep", then per path e.g. "; sink: 0 KB read,
+ * 5120 KB written, 40 syncs, 62 drops, 0 KB direct".
+ * @param size The size of buf.
+ *
+ * @return The length of the text, as snprintf().
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+int io_policy_report(char *buf, size_t size) {
+  int len = snprintf(buf, size, "cache %s", keep_cache ? "keep" : "drop");
+  int i;
+  for (i = 0; i < IO_PATH_MAX && len >= 0 && (size_t)len < size; i++) {
+    struct io_counters c;
+    io_policy_counters(i, &c);
+    len += snprintf(buf + len, size - len, "; %s: %llu KB read, %llu KB written, %llu syncs, %llu drops, %llu KB direct",
+      path_names[i], c.read / 1024, c.written / 1024, c.syncs, c.drops, c.direct / 1024);
+  }
+  return len;
+}
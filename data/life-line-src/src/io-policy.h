@@ -0,0 +1,60 @@
+#ifndef IO_POLICY_H
+#define IO_POLICY_H
+
+/**
+ * @file io-policy.h
+ * @brief Keep the log writes and the folder copies from filling the page cache
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+/* Copies of files at least this large are synced, so that their pages can be dropped */
+#define IO_POLICY_SYNC_MIN (1024 * 1024)
+/* O_DIRECT copies go through an aligned buffer of this size */
+#define IO_POLICY_DIRECT_ALIGN 4096
+#define IO_POLICY_DIRECT_BUFFER (1024 * 1024)
+
+enum io_path {
+  IO_PATH_LOG,   /* logMessageWithLogName(): open, append, close */
+  IO_PATH_SINK,  /* the log files kept open by the log sink */
+  IO_PATH_COPY,  /* copy_if_not_exist() and copyFolder() */
+  IO_PATH_MAX
+};
+
+struct io_counters {
+  unsigned long long written;   /* bytes written */
+  unsigned long long read;      /* bytes read */
+  unsigned long long drops;     /* POSIX_FADV_DONTNEED advices on written or read files */
+  unsigned long long direct;    /* bytes copied with O_DIRECT */
+  unsigned long long syncs;
+};
+
+/**
+ * @note #include <fcntl.h>, for posix_fadvise, sync_file_range, O_DIRECT
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+void io_policy_init_from_env(void);
+int io_policy_keep_cache(void);
+int io_policy_direct(off_t size);
+void io_policy_source(enum io_path path, int fd);
+void io_policy_read(enum io_path path, int fd, off_t len);
+void io_policy_written(enum io_path path, off_t len);
+void io_policy_synced(enum io_path path, int fd);
+void io_policy_writeback(enum io_path path, int fd);
+void io_policy_direct_copied(enum io_path path, off_t len);
+void io_policy_counters(enum io_path path, struct io_counters *counters);
+int io_policy_report(char *buf, size_t size);
+
+#endif /* IO_POLICY_H */
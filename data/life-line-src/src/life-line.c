@@ -1,10 +1,21 @@
 #include "check-tunnel.h"
 #include "copy-folder.h"
+#include "io-policy.h"
 #include "life-line.h"
+#include "log-archive.h"
+#include "log-forward.h"
+#include "log-level.h"
 #include "log-message.h"
+#include "log-sink.h"
+#include "log-sync.h"
 #include "project.h"
+#include "reaper.h"
 #include "remove-old-log.h"
+#include "startup.h"
+#include "supervise.h"
 #include "sync-key.h"
+#include "tunnel.h"
+#include "tunnel-probe.h"
 
 /**
  * @file life-line.c
@@ -14,12 +25,34 @@
  * @date 2023-06-06
  */
 
+static void stage_keys(const char *thread_name, int debug_mode) {
+  syncKey(DATA_PRIVATE_KEY, DATA_PUBLIC_KEY, ROOT_PRIVATE_KEY, ROOT_PUBLIC_KEY, thread_name, debug_mode);
+  LOG_INFO(LOG_MODULE_KEY, thread_name, "Time for checking ssh keys synchronization.");
+}
+
+static void stage_tunnel(const char *thread_name, int debug_mode) {
+  startTunnel(ROOT_PRIVATE_KEY, TUNNEL_CONF, thread_name, debug_mode);
+  LOG_INFO(LOG_MODULE_TUNNEL, thread_name, "Starting SSH tunnel.");
+}
+
+static void stage_copy(const char *thread_name, int debug_mode) {
+  copyFolder(ROOT_DATA, DATA_ROOT, thread_name, debug_mode);
+}
+
+enum life_line_stage { STAGE_KEYS, STAGE_TUNNEL, STAGE_COPY };
+
+static const struct startup_stage life_line_stages[] = {
+  [STAGE_KEYS] = { "keys", stage_keys, 0 },
+  [STAGE_TUNNEL] = { "tunnel", stage_tunnel, STARTUP_AFTER(STAGE_KEYS) },
+  [STAGE_COPY] = { "copy", stage_copy, 0 }
+};
+
 /**
  * @brief Perform a series of operations to establish a secure connection and synchronize data.
  * 
  * This function executes a series of steps to establish a secure connection and synchronize data.
- * It first synchronizes the private and public keys, then starts an SSH tunnel, and finally
- * copies a folder from the root to the data directory. The function provides support for
+ * It synchronizes the private and public keys, then starts an SSH tunnel, while it copies a
+ * folder from the root to the data directory. The function provides support for
  * multi-threading by specifying the thread name and debug mode.
  *
  * @param thread_name The name of the thread executing the function.
@@ -27,30 +60,28 @@
  *
  * @return The return value indicating the status of the function execution.
  *
- * @details The function calls the syncKey() function to synchronize the private and public keys
- * using the provided key file paths. It then logs a message indicating the time for checking
- * SSH key synchronization using the log_message_w_thread() function. Next, it starts an SSH tunnel
- * by calling the startTunnel() function with the root private key, SSH configuration file, thread name,
- * and debug mode. A log message is written to indicate the start of the SSH tunnel. Finally, the function
- * calls the copyFolder() function to copy a folder from the root directory to the data directory.
+ * @details The steps are the stages of a graph run by startup_run(): the syncKey() stage
+ * comes first, the startTunnel() stage after it, since the tunnel uses the root private key,
+ * and the copyFolder() stage of ROOT_DATA to DATA_ROOT runs alongside both, so that a large
+ * seed folder no longer delays the tunnel. Once every stage is done, startup_ready() writes
+ * READY_FILE and notifies NOTIFY_SOCKET.
  *
  * @note This function requires the following include files:
  * N/A
  *
  * @see syncKey() function for synchronizing keys
- * @see log_message_w_thread() function for writing log messages with thread name
+ * @see LOG_INFO() macro for writing log messages with thread name
  * @see startTunnel() function for starting an SSH tunnel
  * @see copyFolder() function for copying folders
+ * @see startup_run() function for running the stages
  *
  * @author Cloudgen Wong
  * @date 2023-06-06
  */
 int life_line(const char* thread_name, int debug_mode) {
-  syncKey(DATA_PRIVATE_KEY, DATA_PUBLIC_KEY, ROOT_PRIVATE_KEY, ROOT_PUBLIC_KEY, thread_name, debug_mode);
-  log_message_w_thread(thread_name,"Time for checking ssh keys synchronization.");
-  startTunnel(ROOT_PRIVATE_KEY, TUNNEL_CONF, thread_name, debug_mode);
-  log_message_w_thread(thread_name,"Starting SSH tunnel.");
-  copyFolder(ROOT_DATA, DATA_ROOT, thread_name, debug_mode);
+  startup_not_ready();
+  startup_run(life_line_stages, sizeof(life_line_stages) / sizeof(life_line_stages[0]), thread_name, debug_mode);
+  startup_ready(thread_name);
   return 0;
 }
 
@@ -66,19 +97,25 @@ int life_line(const char* thread_name, int debug_mode) {
  *
  * @return The return value indicating the status of the function execution.
  *
- * @details The function initializes a counter variable and enters an infinite loop. In each iteration,
- * it increments the counter and checks if it exceeds 300. If the condition is met, it logs a message
- * indicating the time for removing old logs using the log_message_w_thread() function and calls the
- * remove_old_logs_with_debug() function to remove the logs. The counter is then reset to 0. Additionally,
- * the function checks if the counter is divisible by 10, 20, or 30, and performs corresponding operations
- * of checking SSH key synchronization, fixing folders, and checking the SSH tunnel, respectively. Each
- * operation is accompanied by a log message. Finally, the function sleeps for 1 second before continuing
- * to the next iteration of the loop.
+ * @details The function initializes a counter variable and enters an infinite loop. In each
+ * iteration, it increments the counter and checks if it exceeds 300. If the condition is met, it
+ * logs a message indicating the time for removing old logs using the LOG_INFO() macro and calls
+ * the remove_old_logs_with_debug() function to remove the logs, then log_archive_start() to
+ * compress the logs of the previous days in the background, and logs the fsyncs and commit
+ * latency of the LL_LOG_SYNC durability mode so far. The counter is then reset to 0.
+ * Additionally, the function checks if the counter is divisible by 10, 20, or 30, and performs
+ * corresponding operations of checking SSH key synchronization, fixing folders, and checking the
+ * SSH tunnel, respectively. The tunnel is checked when tunnel_probe_due() says so: 2 seconds after
+ * a failure, and up to 5 minutes apart while the probe finds it healthy. Each operation is
+ * accompanied by a log message. Finally, the function sleeps for 1 second before continuing to
+ * the next iteration of the loop.
+ *
+ * The first iteration logs the time taken by the start-up; see startup_tick().
  *
  * @note This function requires the following include files:
  * @note #include <unistd.h> // for sleep() function
  *
- * @see log_message_w_thread() function for writing log messages with thread name
+ * @see LOG_INFO() macro for writing log messages with thread name
  * @see remove_old_logs_with_debug() function for removing old logs
  * @see syncKey() function for synchronizing keys
  * @see fixDocRoot() function for fixing folders
@@ -90,22 +127,53 @@ int life_line(const char* thread_name, int debug_mode) {
 int life_line_loop(const char* thread_name, int debug_mode) {
   int counter = 0;
   while (1) {
+    if (startup_tick(thread_name)) {
+      return 0;
+    }
     counter++;
     if (counter >= 3600) {
-      log_message_w_thread(thread_name,"3600s: Time for removing Old Log.");
+      char report[400];
+      LOG_INFO(LOG_MODULE_LOG, thread_name, "3600s: Time for removing Old Log.");
       remove_old_logs_with_debug(DATA_LOG, ".log", thread_name, debug_mode);
+      log_archive_start(thread_name, debug_mode);
+      if (log_sync_mode() != LOG_SYNC_NONE) {
+        log_sync_report(report, sizeof(report));
+        LOG_INFO(LOG_MODULE_LOG, thread_name, "3600s: Log sync %s", report);
+      }
+      io_policy_report(report, sizeof(report));
+      LOG_INFO(LOG_MODULE_LOG, thread_name, "3600s: I/O %s", report);
+      if (log_forward_active()) {
+        log_forward_report(report, sizeof(report));
+        LOG_INFO(LOG_MODULE_LOG, thread_name, "3600s: Log forwarding %s", report);
+      }
+      if (reaper_active()) {
+        LOG_INFO(LOG_MODULE_MAIN, thread_name, "3600s: %lu orphaned processes reaped", reaper_orphans());
+      }
+      if (supervise_active()) {
+        supervise_report(report, sizeof(report));
+        LOG_INFO(LOG_MODULE_MAIN, thread_name, "3600s: Supervised %s", report);
+      }
+      if (tunnel_active()) {
+        tunnel_report(report, sizeof(report));
+        LOG_INFO(LOG_MODULE_TUNNEL, thread_name, "3600s: Tunnel %s", report);
+      }
       counter = 0;
     }
     if (counter % 10 == 0) {
-      log_message_w_thread(thread_name,"10s: Time for checking ssh keys synchronization.");
+      log_level_reload(thread_name);
+      log_flush_repeated(1);
+      log_sink_flush_spill(0);
+      log_report_unwritten(thread_name);
+      LOG_INFO(LOG_MODULE_KEY, thread_name, "10s: Time for checking ssh keys synchronization.");
       syncKey(DATA_PRIVATE_KEY, DATA_PUBLIC_KEY, ROOT_PRIVATE_KEY, ROOT_PUBLIC_KEY, thread_name, debug_mode);
     }
     if (counter % 10 == 5) {
-      log_message_w_thread(thread_name,"10s: Time for fix folder.");
+      LOG_INFO(LOG_MODULE_DOCROOT, thread_name, "10s: Time for fix folder.");
       fixDocRoot(thread_name, debug_mode);
     }
-    if (counter % 30 == 0) {
-      log_message_w_thread(thread_name,"30s: Time for checking SSH tunnel.");
+    if (tunnel_probe_due(time(NULL))) {
+      LOG_INFO(LOG_MODULE_TUNNEL, thread_name, "%ds: Time for checking SSH tunnel.",
+        tunnel_probe_interval() > 0 ? tunnel_probe_interval() : TUNNEL_PROBE_SECONDS);
       checkTunnel(ROOT_PRIVATE_KEY, TUNNEL_CONF, thread_name, debug_mode);
     }
     sleep(1);
@@ -113,41 +181,34 @@ int life_line_loop(const char* thread_name, int debug_mode) {
   return 0;
 }
 
+/* The applets of life-line, each a symbolic link to it in /usr/bin */
+static const char *short_links[] = {
+  "ll-log-file", "ll-pid-file", "ll-log-msg", "ll-remove-old-log", "ll-sync-key", "ll-log-cat",
+  "ll-log-query", "ll-log-stats", "ll-log-pipe", "ll-fix-docroot"
+};
+
 /**
- * @note #include <stdlib.h> // for system()
- * @note #include <unistd.h> // for access()
+ * @note #include <fcntl.h> // for open(), O_DIRECTORY
+ * @note #include <unistd.h> // for faccessat(), symlinkat()
+ *
+ * @details Runs at every start of the container: /usr/bin is opened once, and every link is
+ * created with one symlinkat() relative to it, which fails with EEXIST when it is there
+ * already. No chdir(), no ln process.
  */
 void lifeLifeShortLink(const char* thread_name, int debug_mode) {
-  if (access("/usr/bin/life-line", X_OK) == 0) {
-    if(!access("/usr/bin/ll-log-file", X_OK) == 0) {
-      chdir("/usr/bin");
-      system("ln -s life-line ll-log-file");
-      log_message_w_thread(thread_name, "Short link for ll-log-file ..Created..");
-    }
-    if(!access("/usr/bin/ll-pid-file", X_OK) == 0) {
-      chdir("/usr/bin");
-      system("ln -s life-line ll-pid-file");
-      log_message_w_thread(thread_name, "Short link for ll-pid-file ..Created..");
-    }
-    if(!access("/usr/bin/ll-log-msg", X_OK) == 0) {
-      chdir("/usr/bin");
-      system("ln -s life-line ll-log-msg");
-      log_message_w_thread(thread_name, "Short link for ll-log-msg ..Created..");
-    }
-    if(!access("/usr/bin/ll-remove-old-log", X_OK) == 0) {
-      chdir("/usr/bin");
-      system("ln -s life-line ll-remove-old-log");
-      log_message_w_thread(thread_name, "Short link for ll-remove-old-log ..Created..");
-    }
-    if(!access("/usr/bin/ll-sync-key", X_OK) == 0) {
-      chdir("/usr/bin");
-      system("ln -s life-line ll-sync-key");
-      log_message_w_thread(thread_name, "Short link for ll-sync-key ..Created..");
-    }
-    if(!access("/usr/bin/ll-fix-docroot", X_OK) == 0) {
-      chdir("/usr/bin");
-      system("ln -s life-line ll-fix-docroot");
-      log_message_w_thread(thread_name, "Short link for ll-fix-docroot ..Created..");
+  size_t i;
+  int dir = open("/usr/bin", O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  if (dir < 0) {
+    return;
+  }
+  if (faccessat(dir, "life-line", X_OK, 0) == 0) {
+    for (i = 0; i < sizeof(short_links) / sizeof(short_links[0]); i++) {
+      if (symlinkat("life-line", dir, short_links[i]) == 0) {
+        LOG_INFO(LOG_MODULE_MAIN, thread_name, "Short link for %s ..Created..", short_links[i]);
+      } else if (errno != EEXIST) {
+        LOG_WARN(LOG_MODULE_MAIN, thread_name, "Short link for %s ..Failed.. (%s)", short_links[i], strerror(errno));
+      }
     }
   }
-}
\ No newline at end of file
+  close(dir);
+}
@@ -2,7 +2,10 @@
 #define LIFE_LINE_H
 
 
+#include <errno.h>
+#include <fcntl.h>
 #include <stdlib.h> 
+#include <string.h>
 #include <unistd.h> 
 
 /**
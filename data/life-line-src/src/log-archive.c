@@ -0,0 +1,392 @@
+#include "log-archive.h"
+#include "log-binary.h"
+#include "log-level.h"
+#include "log-message.h"
+#include "log-sink.h"
+#include "project.h"
+#include "reaper.h"
+
+/**
+ * @file log-archive.c
+ * @brief Compress the daily log files in the background once their date has rolled over
+ *
+ * The compression runs in zstd (or gzip when zstd is not installed) as a child process at the
+ * lowest CPU and I/O priority, streaming from the log file to the archive, so the daemon's
+ * memory stays bounded whatever the size of a day's log.
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+
+struct archive_tool {
+  char path[PATH_MAX];
+  const char *ext;
+  int zstd;
+};
+
+static int archive_running = 0;
+static int archive_debug_mode = 0;
+
+static int find_in_path(const char *name, char *out, size_t size) {
+  const char *path = getenv("PATH");
+  const char *p;
+  if (path == NULL || *path == 0) {
+    path = "/usr/local/bin:/usr/bin:/bin";
+  }
+  for (p = path; *p; ) {
+    size_t len = strcspn(p, ":");
+    if (len > 0 && (size_t)snprintf(out, size, "%.*s/%s", (int)len, p, name) < size && access(out, X_OK) == 0) {
+      return 0;
+    }
+    p += len;
+    if (*p == ':') {
+      p++;
+    }
+  }
+  return -1;
+}
+
+static int find_tool(struct archive_tool *tool) {
+  if (find_in_path("zstd", tool->path, sizeof(tool->path)) == 0) {
+    tool->ext = ".zst";
+    tool->zstd = 1;
+    return 0;
+  }
+  if (find_in_path("gzip", tool->path, sizeof(tool->path)) == 0) {
+    tool->ext = ".gz";
+    tool->zstd = 0;
+    return 0;
+  }
+  return -1;
+}
+
+/*
+ * Spawn the tool without forking the daemon, then lower its CPU and I/O priority from here; the
+ * first instants of the tool, before it reads the log, run at the daemon's priority.
+ */
+static int run_low_priority(char *const argv[], int in_fd, int out_fd) {
+  posix_spawn_file_actions_t actions;
+  posix_spawnattr_t attr;
+  int status;
+  pid_t pid;
+  posix_spawn_file_actions_init(&actions);
+  if (in_fd >= 0) {
+    posix_spawn_file_actions_adddup2(&actions, in_fd, STDIN_FILENO);
+  }
+  if (out_fd >= 0) {
+    posix_spawn_file_actions_adddup2(&actions, out_fd, STDOUT_FILENO);
+  }
+  posix_spawnattr_init(&attr);
+  pid = reaper_spawn(argv[0], &actions, &attr, argv);
+  posix_spawnattr_destroy(&attr);
+  posix_spawn_file_actions_destroy(&actions);
+  if (pid < 0) {
+    return -1;
+  }
+  setpriority(PRIO_PROCESS, pid, LOG_ARCHIVE_NICE);
+#ifdef SYS_ioprio_set
+  // IOPRIO_WHO_PROCESS, IOPRIO_CLASS_IDLE
+  syscall(SYS_ioprio_set, 1, pid, 3 << 13);
+#endif
+  while (reaper_waitpid(pid, &status, 0) < 0) {
+    if (errno != EINTR) {
+      return -1;
+    }
+  }
+  return (WIFEXITED(status) && WEXITSTATUS(status) == 0) ? 0 : -1;
+}
+
+static const char *find_date(const char *name) {
+  size_t len = strlen(name);
+  size_t i;
+  for (i = 0; i + 10 <= len; i++) {
+    const char *p = name + i;
+    if (p[0] >= '0' && p[0] <= '9' && p[1] >= '0' && p[1] <= '9' && p[2] >= '0' && p[2] <= '9' &&
+        p[3] >= '0' && p[3] <= '9' && p[4] == '-' && p[5] >= '0' && p[5] <= '9' &&
+        p[6] >= '0' && p[6] <= '9' && p[7] == '-' && p[8] >= '0' && p[8] <= '9' && p[9] >= '0' && p[9] <= '9') {
+      return p;
+    }
+  }
+  return NULL;
+}
+
+static int ends_with(const char *name, const char *suffix) {
+  size_t len = strlen(name);
+  size_t suffix_len = strlen(suffix);
+  return len >= suffix_len && strcmp(name + len - suffix_len, suffix) == 0;
+}
+
+/**
+ * @brief Tell whether a file name is a compressed daily log.
+ *
+ * @param name The file name.
+ *
+ * @return 1 for *.log.zst and *.log.gz (or .llb for the binary format), 0 otherwise.
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+int log_archive_is_archive(const char *name) {
+  return ends_with(name, ".log.zst") || ends_with(name, ".log.gz") ||
+    ends_with(name, LOG_BINARY_EXT ".zst") || ends_with(name, LOG_BINARY_EXT ".gz");
+}
+
+static int archive_file(const char *dir, const char *name, const struct stat *st, const struct archive_tool *tool,
+    const char *thread_name, int debug_mode) {
+  char src[PATH_MAX], tmp[PATH_MAX], dst[PATH_MAX];
+  char *argv[8];
+  int argc = 0;
+  int in_fd, out_fd, rc;
+  struct timespec times[2];
+  if ((size_t)snprintf(src, sizeof(src), "%s/%s", dir, name) >= sizeof(src) ||
+      (size_t)snprintf(dst, sizeof(dst), "%s%s", src, tool->ext) >= sizeof(dst) ||
+      (size_t)snprintf(tmp, sizeof(tmp), "%s.tmp", dst) >= sizeof(tmp)) {
+    return -1;
+  }
+  in_fd = open(src, O_RDONLY | O_CLOEXEC);
+  if (in_fd < 0) {
+    return -1;
+  }
+  out_fd = open(tmp, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (out_fd < 0) {
+    close(in_fd);
+    LOG_DEBUG(LOG_MODULE_LOG, debug_mode, thread_name, "Creating archive: %s ..Failed..", tmp);
+    return -1;
+  }
+  argv[argc++] = (char *)tool->path;
+  argv[argc++] = "-q";
+  argv[argc++] = "-c";
+  argv[argc++] = LOG_ARCHIVE_LEVEL;
+  if (tool->zstd && access(LOG_ARCHIVE_DICT, R_OK) == 0) {
+    argv[argc++] = "-D";
+    argv[argc++] = LOG_ARCHIVE_DICT;
+  }
+  argv[argc] = NULL;
+  rc = run_low_priority(argv, in_fd, out_fd);
+  close(in_fd);
+  if (rc == 0) {
+    // Retention counts from the day of the log, not from the day of the compression
+    times[0] = st->st_atim;
+    times[1] = st->st_mtim;
+    futimens(out_fd, times);
+  }
+  if (close(out_fd) != 0) {
+    rc = -1;
+  }
+  if (rc != 0 || rename(tmp, dst) != 0) {
+    unlink(tmp);
+    LOG_DEBUG(LOG_MODULE_LOG, debug_mode, thread_name, "Archiving file: %s ..Failed..", src);
+    return -1;
+  }
+  unlink(src);
+  // The offsets of the sidecar index only apply to the uncompressed file
+  if ((size_t)snprintf(tmp, sizeof(tmp), "%s" LOG_SINK_INDEX_EXT, src) < sizeof(tmp)) {
+    unlink(tmp);
+  }
+  LOG_DEBUG(LOG_MODULE_LOG, debug_mode, thread_name, "Archiving file: %s -> %s", src, dst);
+  return 0;
+}
+
+static int archive_dir(const char *dir, const struct archive_tool *tool, const char *today, time_t now,
+    const char *thread_name, int debug_mode) {
+  DIR *d = opendir(dir);
+  struct dirent *entry;
+  int count = 0;
+  if (d == NULL) {
+    LOG_DEBUG(LOG_MODULE_LOG, debug_mode, thread_name, "Error opening directory: %s", dir);
+    return 0;
+  }
+  while ((entry = readdir(d)) != NULL) {
+    if (entry->d_name[0] == '.') {
+      continue;
+    }
+    if (entry->d_type == DT_DIR) {
+      char subdirectory[PATH_MAX];
+      if ((size_t)snprintf(subdirectory, sizeof(subdirectory), "%s/%s", dir, entry->d_name) < sizeof(subdirectory)) {
+        count += archive_dir(subdirectory, tool, today, now, thread_name, debug_mode);
+      }
+    } else if (entry->d_type == DT_REG && (ends_with(entry->d_name, ".log") || ends_with(entry->d_name, LOG_BINARY_EXT))) {
+      // Only dated daily logs: other programs may still be appending to an undated one
+      const char *date = find_date(entry->d_name);
+      char path[PATH_MAX];
+      struct stat statbuf;
+      if (date == NULL || strncmp(date, today, 10) == 0) {
+        continue;
+      }
+      if ((size_t)snprintf(path, sizeof(path), "%s/%s", dir, entry->d_name) >= sizeof(path) ||
+          stat(path, &statbuf) != 0 || difftime(now, statbuf.st_mtime) < LOG_ARCHIVE_IDLE) {
+        continue;
+      }
+      if (archive_file(dir, entry->d_name, &statbuf, tool, thread_name, debug_mode) == 0) {
+        count++;
+      }
+    }
+  }
+  closedir(d);
+  return count;
+}
+
+/**
+ * @brief Compress the daily log files under a directory whose date has rolled over.
+ *
+ * This function walks the directory recursively and replaces every dated *.log file that is not
+ * of the current day, and has not been written for LOG_ARCHIVE_IDLE seconds, by a .log.zst
+ * archive (.log.gz when zstd is not installed). When LOG_ARCHIVE_DICT exists, zstd compresses
+ * with that dictionary. The archive keeps the modification time of the log file, so that
+ * remove_old_logs_with_debug() applies DAYSTODELETEARCHIVES from the day of the log.
+ *
+ * @param dir The directory to scan.
+ * @param thread_name The name of the thread, for the log messages.
+ * @param debug_mode The debug mode flag.
+ *
+ * @return The number of files archived.
+ *
+ * @note This function requires the following include files:
+ * @note #include <dirent.h>, for opendir, readdir, closedir
+ * @note #include <sys/wait.h>, for waitpid
+ * @note #include <sys/resource.h>, for setpriority
+ *
+ * @see log_archive_start()
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+int log_archive_dir(const char *dir, const char *thread_name, int debug_mode) {
+  struct archive_tool tool;
+  char today[11];
+  struct tm tm;
+  time_t now = time(NULL);
+  if (find_tool(&tool) != 0) {
+    LOG_DEBUG(LOG_MODULE_LOG, debug_mode, thread_name, "Archiving logs: zstd and gzip ..Not Found..");
+    return 0;
+  }
+  localtime_r(&now, &tm);
+  strftime(today, sizeof(today), "%Y-%m-%d", &tm);
+  return archive_dir(dir, &tool, today, now, thread_name, debug_mode);
+}
+
+static void *log_archive_thread(void *arg) {
+  const char *thread_name = "Thread_log_archive";
+  int count;
+  (void)arg;
+  LOG_DEBUG(LOG_MODULE_LOG, archive_debug_mode, thread_name, "..Started..");
+  count = log_archive_dir(DATA_LOG, thread_name, archive_debug_mode);
+  if (count > 0) {
+    LOG_INFO(LOG_MODULE_LOG, thread_name, "%d log files ..Archived..", count);
+  }
+  __atomic_store_n(&archive_running, 0, __ATOMIC_RELEASE);
+  return NULL;
+}
+
+/**
+ * @brief Archive the rotated log files under DATA_LOG in a background thread.
+ *
+ * At most one archiving pass runs at a time; a call made while one is running does nothing.
+ *
+ * @param thread_name The name of the calling thread, for the log message.
+ * @param debug_mode The debug mode flag.
+ *
+ * @return 0 if a pass is running, 1 if the thread cannot be created.
+ *
+ * @note This function requires the following include files:
+ * @note #include <pthread.h>, for pthread_create
+ *
+ * @see log_archive_dir()
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+int log_archive_start(const char *thread_name, int debug_mode) {
+  pthread_t tid;
+  if (__atomic_exchange_n(&archive_running, 1, __ATOMIC_ACQ_REL)) {
+    return 0;
+  }
+  archive_debug_mode = debug_mode;
+  if (pthread_create(&tid, NULL, log_archive_thread, NULL) != 0) {
+    __atomic_store_n(&archive_running, 0, __ATOMIC_RELEASE);
+    LOG_ERROR(LOG_MODULE_LOG, thread_name, "Log archive thread ..Failed..");
+    return 1;
+  }
+  pthread_detach(tid);
+  return 0;
+}
+
+static void collect_logs(const char *dir, char **paths, int *count, int max) {
+  DIR *d = opendir(dir);
+  struct dirent *entry;
+  if (d == NULL) {
+    return;
+  }
+  while (*count < max && (entry = readdir(d)) != NULL) {
+    char path[PATH_MAX];
+    if (entry->d_name[0] == '.' ||
+        (size_t)snprintf(path, sizeof(path), "%s/%s", dir, entry->d_name) >= sizeof(path)) {
+      continue;
+    }
+    if (entry->d_type == DT_DIR) {
+      collect_logs(path, paths, count, max);
+    } else if (entry->d_type == DT_REG && ends_with(entry->d_name, ".log")) {
+      paths[*count] = strdup(path);
+      if (paths[*count] != NULL) {
+        (*count)++;
+      }
+    }
+  }
+  closedir(d);
+}
+
+/**
+ * @brief Train the zstd dictionary used for the log archives.
+ *
+ * This function hands up to LOG_ARCHIVE_TRAIN_FILES uncompressed log files under DATA_LOG to
+ * `zstd --train` and stores the result as LOG_ARCHIVE_DICT. An existing dictionary is never
+ * replaced, as the archives compressed with it cannot be read without it.
+ *
+ * @param thread_name The name of the calling thread, for the log messages.
+ *
+ * @return 0 on success, 1 otherwise.
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+int log_archive_train(const char *thread_name) {
+  struct archive_tool tool;
+  char *argv[LOG_ARCHIVE_TRAIN_FILES + 10];
+  char **files;
+  int count = 0;
+  int argc = 0;
+  int rc, i;
+  if (find_tool(&tool) != 0 || !tool.zstd) {
+    LOG_ERROR(LOG_MODULE_LOG, thread_name, "Training log dictionary: zstd ..Not Found..");
+    return 1;
+  }
+  if (access(LOG_ARCHIVE_DICT, F_OK) == 0) {
+    LOG_ERROR(LOG_MODULE_LOG, thread_name, "Training log dictionary: " LOG_ARCHIVE_DICT " ..Exists..");
+    return 1;
+  }
+  argv[argc++] = tool.path;
+  argv[argc++] = "-q";
+  argv[argc++] = "--train";
+  argv[argc++] = "-B4096";
+  argv[argc++] = LOG_ARCHIVE_DICT_SIZE;
+  argv[argc++] = "-o";
+  argv[argc++] = LOG_ARCHIVE_DICT ".tmp";
+  files = argv + argc;
+  collect_logs(DATA_LOG, files, &count, LOG_ARCHIVE_TRAIN_FILES);
+  argv[argc + count] = NULL;
+  if (count == 0) {
+    LOG_ERROR(LOG_MODULE_LOG, thread_name, "Training log dictionary: no log files ..Failed..");
+    return 1;
+  }
+  rc = run_low_priority(argv, -1, -1);
+  for (i = 0; i < count; i++) {
+    free(files[i]);
+  }
+  if (rc != 0 || rename(LOG_ARCHIVE_DICT ".tmp", LOG_ARCHIVE_DICT) != 0) {
+    unlink(LOG_ARCHIVE_DICT ".tmp");
+    LOG_ERROR(LOG_MODULE_LOG, thread_name, "Training log dictionary: " LOG_ARCHIVE_DICT " ..Failed..");
+    return 1;
+  }
+  LOG_INFO(LOG_MODULE_LOG, thread_name, "Training log dictionary: %d files -> " LOG_ARCHIVE_DICT " ..Done..", count);
+  return 0;
+}
@@ -0,0 +1,50 @@
+#ifndef LOG_ARCHIVE_H
+#define LOG_ARCHIVE_H
+
+/**
+ * @file log-archive.h
+ * @brief Compress the daily log files in the background once their date has rolled over
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <pthread.h>
+#include <spawn.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+/* The log files of the current day stay uncompressed, older ones only once idle this long */
+#define LOG_ARCHIVE_IDLE 3600
+#define LOG_ARCHIVE_NICE 19
+#define LOG_ARCHIVE_LEVEL "-9"
+/* Samples handed to zstd --train */
+#define LOG_ARCHIVE_TRAIN_FILES 256
+#define LOG_ARCHIVE_DICT_SIZE "--maxdict=65536"
+
+/**
+ * @note #include <sys/wait.h>, for waitpid
+ * @note #include <sys/resource.h>, for setpriority
+ * @note #include <spawn.h>, for posix_spawn
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+int log_archive_is_archive(const char *name);
+int log_archive_dir(const char *dir, const char *thread_name, int debug_mode);
+int log_archive_start(const char *thread_name, int debug_mode);
+int log_archive_train(const char *thread_name);
+
+#endif /* LOG_ARCHIVE_H */
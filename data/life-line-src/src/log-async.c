@@ -0,0 +1,380 @@
+#include "log-async.h"
+#include "project.h"
+#include "wait-ms.h"
+
+/**
+ * @file log-async.c
+ * @brief Hand log lines to a background flusher thread through a bounded ring buffer
+ *
+ * The ring is a bounded multi-producer queue: each slot carries a sequence number, producers
+ * claim a position with a compare-and-swap on enqueue_pos and publish the slot by storing
+ * pos + 1 into its sequence. The flusher thread is the consumer; it copies up to
+ * LOG_ASYNC_BATCH records out of the ring, hands their slots back to the producers at once and
+ * writes runs of the same stream with one writev(). A slow write thus never holds a slot: the
+ * slot a full ring needs next always holds the oldest queued record, which
+ * LOG_OVERFLOW_DROP_OLDEST can discard.
+ *
+ * A producer counts itself in `pushing` before it looks at `stopping`, so once the flusher has
+ * seen `stopping` it only has to wait for `pushing` to fall to 0 and for dequeue_pos to reach
+ * enqueue_pos: every slot claimed by then has been published and written.
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+
+static struct log_async_slot ring[LOG_ASYNC_SLOTS];
+static struct log_async_slot batch[LOG_ASYNC_BATCH];
+static size_t enqueue_pos = 0;
+static size_t dequeue_pos = 0;
+static unsigned long dropped = 0;
+static unsigned long dropped_reported = 0;
+static int running = 0;
+static int stopping = 0;
+static int flusher_done = 0;
+static int flusher_sleeping = 0;
+static int pushing = 0;
+static enum log_overflow overflow_policy = LOG_OVERFLOW_BLOCK;
+static pthread_t flusher_tid;
+static pthread_mutex_t wake_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t wake_cond = PTHREAD_COND_INITIALIZER;
+
+#define LOG_ASYNC_MASK (LOG_ASYNC_SLOTS - 1)
+
+/**
+ * @brief Claim the next free slot of the ring.
+ *
+ * @return The claimed slot, or NULL when the ring is full.
+ */
+static struct log_async_slot *ring_claim(size_t *claimed) {
+  size_t pos = __atomic_load_n(&enqueue_pos, __ATOMIC_RELAXED);
+  for (;;) {
+    struct log_async_slot *slot = &ring[pos & LOG_ASYNC_MASK];
+    size_t seq = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+    long dif = (long)seq - (long)pos;
+    if (dif == 0) {
+      if (__atomic_compare_exchange_n(&enqueue_pos, &pos, pos + 1, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+        *claimed = pos;
+        return slot;
+      }
+    } else if (dif < 0) {
+      return NULL;
+    } else {
+      pos = __atomic_load_n(&enqueue_pos, __ATOMIC_RELAXED);
+    }
+  }
+}
+
+/**
+ * @brief Take the oldest published slot out of the ring.
+ *
+ * The slot stays owned by the caller until ring_release() is called for it.
+ *
+ * @return The slot, or NULL when nothing is published.
+ */
+static struct log_async_slot *ring_take(size_t *taken) {
+  size_t pos = __atomic_load_n(&dequeue_pos, __ATOMIC_RELAXED);
+  for (;;) {
+    struct log_async_slot *slot = &ring[pos & LOG_ASYNC_MASK];
+    size_t seq = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+    long dif = (long)seq - (long)(pos + 1);
+    if (dif == 0) {
+      if (__atomic_compare_exchange_n(&dequeue_pos, &pos, pos + 1, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+        *taken = pos;
+        return slot;
+      }
+    } else if (dif < 0) {
+      return NULL;
+    } else {
+      pos = __atomic_load_n(&dequeue_pos, __ATOMIC_RELAXED);
+    }
+  }
+}
+
+static void ring_release(struct log_async_slot *slot, size_t pos) {
+  __atomic_store_n(&slot->seq, pos + LOG_ASYNC_SLOTS, __ATOMIC_RELEASE);
+}
+
+static void wake_flusher(void) {
+  if (__atomic_load_n(&flusher_sleeping, __ATOMIC_SEQ_CST)) {
+    pthread_mutex_lock(&wake_lock);
+    pthread_cond_signal(&wake_cond);
+    pthread_mutex_unlock(&wake_lock);
+  }
+}
+
+static void report_drops(void) {
+  char timestamp[32];
+  char line[160];
+  unsigned long count = __atomic_load_n(&dropped, __ATOMIC_RELAXED);
+  time_t t;
+  struct tm tm;
+  int len;
+  if (count == dropped_reported) {
+    return;
+  }
+  t = time(NULL);
+  localtime_r(&t, &tm);
+  strftime(timestamp, sizeof(timestamp), "%Y-%m-%d %H:%M:%S", &tm);
+  len = snprintf(line, sizeof(line), "%s %s@%s #%d ]   «Thread_log» %lu log records ..Dropped..\n",
+    timestamp, APP_NAME, APP_VERSION, (int)getpid(), count - dropped_reported);
+  log_sink_write(APP, 0, line, len);
+  dropped_reported = count;
+}
+
+/**
+ * @brief Write one batch of queued records.
+ *
+ * @return The number of records written.
+ */
+static int flush_batch(void) {
+  struct log_async_slot *slot;
+  struct iovec iov[LOG_ASYNC_BATCH];
+  size_t pos;
+  int n = 0;
+  int i, start;
+  while (n < LOG_ASYNC_BATCH && (slot = ring_take(&pos)) != NULL) {
+    memcpy(batch[n].app, slot->app, strlen(slot->app) + 1);
+    memcpy(batch[n].line, slot->line, slot->len);
+    batch[n].len = slot->len;
+    batch[n].debug_mode = slot->debug_mode;
+    ring_release(slot, pos);
+    n++;
+  }
+  start = 0;
+  while (start < n) {
+    size_t total = 0;
+    int count = 0;
+    for (i = start; i < n; i++) {
+      if (batch[i].debug_mode != batch[start].debug_mode || strcmp(batch[i].app, batch[start].app) != 0) {
+        break;
+      }
+      iov[count].iov_base = batch[i].line;
+      iov[count].iov_len = batch[i].len;
+      total += batch[i].len;
+      count++;
+    }
+    log_sink_writev(batch[start].app, batch[start].debug_mode, iov, count, total);
+    start = i;
+  }
+  return n;
+}
+
+/**
+ * @brief Tell whether the flusher may exit: no producer is pushing and every claimed slot was
+ * written.
+ *
+ * @details Past LOG_ASYNC_DRAIN_TIMEOUT ms of stopping, the slots still claimed by a producer
+ * are counted as dropped, and reported, instead of being waited for.
+ */
+static int flusher_drained(struct timespec *stop_deadline) {
+  struct timespec now;
+  size_t left;
+  if (__atomic_load_n(&pushing, __ATOMIC_SEQ_CST) == 0 &&
+    __atomic_load_n(&dequeue_pos, __ATOMIC_SEQ_CST) == __atomic_load_n(&enqueue_pos, __ATOMIC_SEQ_CST)) {
+    return 1;
+  }
+  if (stop_deadline->tv_sec == 0) {
+    deadline_ms(stop_deadline, LOG_ASYNC_DRAIN_TIMEOUT);
+  }
+  clock_gettime(CLOCK_REALTIME, &now);
+  if (now.tv_sec < stop_deadline->tv_sec ||
+    (now.tv_sec == stop_deadline->tv_sec && now.tv_nsec < stop_deadline->tv_nsec)) {
+    sched_yield();
+    return 0;
+  }
+  left = __atomic_load_n(&enqueue_pos, __ATOMIC_SEQ_CST) - __atomic_load_n(&dequeue_pos, __ATOMIC_SEQ_CST);
+  __atomic_add_fetch(&dropped, left, __ATOMIC_RELAXED);
+  report_drops();
+  return 1;
+}
+
+static void *log_flusher(void *arg) {
+  struct timespec deadline;
+  struct timespec stop_deadline = { 0, 0 };
+  (void)arg;
+  for (;;) {
+    if (flush_batch() > 0) {
+      continue;
+    }
+    report_drops();
+    if (__atomic_load_n(&stopping, __ATOMIC_SEQ_CST)) {
+      if (flusher_drained(&stop_deadline)) {
+        break;
+      }
+      continue;
+    }
+    __atomic_store_n(&flusher_sleeping, 1, __ATOMIC_SEQ_CST);
+    pthread_mutex_lock(&wake_lock);
+    if (__atomic_load_n(&dequeue_pos, __ATOMIC_SEQ_CST) == __atomic_load_n(&enqueue_pos, __ATOMIC_SEQ_CST)
+      && !__atomic_load_n(&stopping, __ATOMIC_SEQ_CST)) {
+      deadline_ms(&deadline, 100);
+      pthread_cond_timedwait(&wake_cond, &wake_lock, &deadline);
+    }
+    pthread_mutex_unlock(&wake_lock);
+    __atomic_store_n(&flusher_sleeping, 0, __ATOMIC_SEQ_CST);
+  }
+  __atomic_store_n(&flusher_done, 1, __ATOMIC_SEQ_CST);
+  return NULL;
+}
+
+/**
+ * @brief Start the asynchronous logging mode.
+ *
+ * This function starts the flusher thread. From then on log_async_push() queues the formatted
+ * log lines and the flusher writes them with writev(), so a slow /data volume no longer stalls
+ * the main loop.
+ *
+ * @param policy What a producer does when the ring is full.
+ *
+ * @return 0 on success, 1 if the flusher thread cannot be created.
+ *
+ * @note This function requires the following include files:
+ * @note #include <pthread.h>, for pthread_create
+ *
+ * @see log_async_drain()
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+int log_async_start(enum log_overflow policy) {
+  size_t i;
+  if (running) {
+    return 0;
+  }
+  for (i = 0; i < LOG_ASYNC_SLOTS; i++) {
+    ring[i].seq = i;
+  }
+  enqueue_pos = 0;
+  dequeue_pos = 0;
+  stopping = 0;
+  pushing = 0;
+  flusher_done = 0;
+  overflow_policy = policy;
+  if (pthread_create(&flusher_tid, NULL, log_flusher, NULL) != 0) {
+    return 1;
+  }
+  __atomic_store_n(&running, 1, __ATOMIC_SEQ_CST);
+  return 0;
+}
+
+/**
+ * @brief Start the asynchronous logging mode when LL_LOG_ASYNC is set.
+ *
+ * LL_LOG_ASYNC selects the overflow policy: "block", "drop-oldest" or "drop".
+ * Any other non-empty value selects "block".
+ *
+ * @return 0 if the mode is off or started, 1 if the flusher thread cannot be created.
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+int log_async_start_from_env(void) {
+  const char *mode = getenv("LL_LOG_ASYNC");
+  if (mode == NULL || mode[0] == 0 || strcmp(mode, "0") == 0 || strcmp(mode, "off") == 0) {
+    return 0;
+  }
+  if (strcmp(mode, "drop-oldest") == 0) {
+    return log_async_start(LOG_OVERFLOW_DROP_OLDEST);
+  } else if (strcmp(mode, "drop") == 0) {
+    return log_async_start(LOG_OVERFLOW_DROP);
+  }
+  return log_async_start(LOG_OVERFLOW_BLOCK);
+}
+
+int log_async_enabled(void) {
+  return __atomic_load_n(&running, __ATOMIC_ACQUIRE);
+}
+
+/**
+ * @brief Queue a formatted log line for the flusher thread.
+ *
+ * @param app The application name of the log stream.
+ * @param debug_mode Selects the debug log stream.
+ * @param line The formatted line, including the trailing newline.
+ * @param len The length of the line.
+ *
+ * @return 0 if the line was queued or dropped by the overflow policy, -1 if the caller
+ * must write the line itself (async mode off, or the line does not fit in a slot).
+ *
+ * @details When the ring is full the overflow policy decides: LOG_OVERFLOW_BLOCK yields until
+ * the flusher frees a slot, LOG_OVERFLOW_DROP_OLDEST takes the oldest queued record out of the
+ * ring and discards it, LOG_OVERFLOW_DROP discards the new record. Every discarded record is
+ * counted and the flusher logs the count.
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+int log_async_push(const char *app, int debug_mode, const char *line, int len) {
+  struct log_async_slot *slot;
+  size_t pos;
+  if (!log_async_enabled() || len > LOG_LINE_MAX || strlen(app) >= LOG_SINK_APP_MAX) {
+    return -1;
+  }
+  __atomic_add_fetch(&pushing, 1, __ATOMIC_SEQ_CST);
+  if (__atomic_load_n(&stopping, __ATOMIC_SEQ_CST)) {
+    __atomic_sub_fetch(&pushing, 1, __ATOMIC_SEQ_CST);
+    return -1;
+  }
+  while ((slot = ring_claim(&pos)) == NULL) {
+    if (overflow_policy == LOG_OVERFLOW_DROP) {
+      __atomic_add_fetch(&dropped, 1, __ATOMIC_RELAXED);
+      __atomic_sub_fetch(&pushing, 1, __ATOMIC_SEQ_CST);
+      wake_flusher();
+      return 0;
+    } else if (overflow_policy == LOG_OVERFLOW_DROP_OLDEST) {
+      size_t old;
+      struct log_async_slot *victim = ring_take(&old);
+      if (victim != NULL) {
+        ring_release(victim, old);
+        __atomic_add_fetch(&dropped, 1, __ATOMIC_RELAXED);
+      }
+    } else {
+      wake_flusher();
+      sched_yield();
+    }
+  }
+  memcpy(slot->app, app, strlen(app) + 1);
+  memcpy(slot->line, line, len);
+  slot->len = len;
+  slot->debug_mode = debug_mode;
+  __atomic_store_n(&slot->seq, pos + 1, __ATOMIC_RELEASE);
+  __atomic_sub_fetch(&pushing, 1, __ATOMIC_SEQ_CST);
+  wake_flusher();
+  return 0;
+}
+
+unsigned long log_async_dropped(void) {
+  return __atomic_load_n(&dropped, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief Write out everything queued and stop the flusher thread.
+ *
+ * After this call logging is synchronous again, so messages logged on the way out are still
+ * written. The flusher exits once every record a producer has claimed a slot for is written,
+ * and the wait for it is bounded by LOG_ASYNC_DRAIN_TIMEOUT.
+ *
+ * @see handle_exit()
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+void log_async_drain(void) {
+  struct timespec pause = { 0, 1000000L };
+  int waited = 0;
+  if (!log_async_enabled()) {
+    return;
+  }
+  __atomic_store_n(&stopping, 1, __ATOMIC_SEQ_CST);
+  pthread_mutex_lock(&wake_lock);
+  pthread_cond_signal(&wake_cond);
+  pthread_mutex_unlock(&wake_lock);
+  while (!__atomic_load_n(&flusher_done, __ATOMIC_SEQ_CST) && waited < LOG_ASYNC_DRAIN_TIMEOUT) {
+    nanosleep(&pause, NULL);
+    waited++;
+  }
+  if (__atomic_load_n(&flusher_done, __ATOMIC_SEQ_CST)) {
+    pthread_join(flusher_tid, NULL);
+  }
+  __atomic_store_n(&running, 0, __ATOMIC_SEQ_CST);
+}
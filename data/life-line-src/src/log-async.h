@@ -0,0 +1,55 @@
+#ifndef LOG_ASYNC_H
+#define LOG_ASYNC_H
+
+/**
+ * @file log-async.h
+ * @brief Hand log lines to a background flusher thread through a bounded ring buffer
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/uio.h>
+#include <time.h>
+
+#include "log-message.h"
+#include "log-sink.h"
+
+#define LOG_ASYNC_SLOTS 256           /* must be a power of 2 */
+#define LOG_ASYNC_BATCH 64            /* records per writev() */
+#define LOG_ASYNC_DRAIN_TIMEOUT 2000  /* ms to wait for the flusher on exit */
+
+enum log_overflow {
+  LOG_OVERFLOW_BLOCK,        /* wait for the flusher to free a slot */
+  LOG_OVERFLOW_DROP_OLDEST,  /* discard the oldest queued record */
+  LOG_OVERFLOW_DROP          /* discard the new record and count it */
+};
+
+struct log_async_slot {
+  size_t seq;
+  int debug_mode;
+  int len;
+  char app[LOG_SINK_APP_MAX];
+  char line[LOG_LINE_MAX];
+};
+
+/**
+ * @note #include <pthread.h>, for pthread_create, pthread_cond_timedwait
+ * @note #include <sys/uio.h>, for writev
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+int log_async_start(enum log_overflow policy);
+int log_async_start_from_env(void);
+int log_async_enabled(void);
+int log_async_push(const char *app, int debug_mode, const char *line, int len);
+unsigned long log_async_dropped(void);
+void log_async_drain(void);
+
+#endif /* LOG_ASYNC_H */
@@ -0,0 +1,304 @@
+/* RTLD_NEXT */
+#define _GNU_SOURCE
+#include "log-async.h"
+#include "log-bench.h"
+#include "log-dedup.h"
+#include "log-message.h"
+#include "log-sink.h"
+#include "log-sync.h"
+#include "project.h"
+
+/**
+ * @file log-bench.c
+ * @brief Measure the throughput of the log writing paths
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+
+static unsigned long bench_allocs = 0;
+
+#ifdef LOG_BENCH_MALLOC
+/*
+ * `sh build.sh bench` defines LOG_BENCH_MALLOC: malloc() and its kin are then interposed, so
+ * that the allocations made inside libc (fopen, localtime, stdio buffers) are counted along
+ * with those of life-line itself. The release build carries no counter.
+ *
+ * dlsym() may allocate before the real functions are known: those few allocations come from
+ * a static buffer, which free() and realloc() recognize.
+ */
+static void *(*real_malloc)(size_t);
+static void *(*real_calloc)(size_t, size_t);
+static void *(*real_realloc)(void *, size_t);
+static void (*real_free)(void *);
+static char bench_bootstrap[4096] __attribute__((aligned(16)));
+static size_t bench_bootstrap_used = 0;
+static int bench_resolving = 0;
+
+static int bench_in_bootstrap(const void *ptr) {
+  return (const char *)ptr >= bench_bootstrap && (const char *)ptr < bench_bootstrap + sizeof(bench_bootstrap);
+}
+
+static void *bench_bootstrap_alloc(size_t size) {
+  void *p;
+  size = (size + 15) & ~(size_t)15;
+  if (size > sizeof(bench_bootstrap) - bench_bootstrap_used) {
+    return NULL;
+  }
+  p = bench_bootstrap + bench_bootstrap_used;
+  bench_bootstrap_used += size;
+  return p;
+}
+
+static int bench_resolve(void) {
+  if (__atomic_load_n(&real_malloc, __ATOMIC_ACQUIRE) != NULL) {
+    return 1;
+  }
+  if (bench_resolving) {
+    return 0;
+  }
+  bench_resolving = 1;
+  real_calloc = (void *(*)(size_t, size_t))dlsym(RTLD_NEXT, "calloc");
+  real_realloc = (void *(*)(void *, size_t))dlsym(RTLD_NEXT, "realloc");
+  real_free = (void (*)(void *))dlsym(RTLD_NEXT, "free");
+  __atomic_store_n(&real_malloc, (void *(*)(size_t))dlsym(RTLD_NEXT, "malloc"), __ATOMIC_RELEASE);
+  bench_resolving = 0;
+  return real_malloc != NULL;
+}
+
+void *malloc(size_t size) {
+  if (!bench_resolve()) {
+    return bench_bootstrap_alloc(size);
+  }
+  __atomic_add_fetch(&bench_allocs, 1, __ATOMIC_RELAXED);
+  return real_malloc(size);
+}
+
+void *calloc(size_t nmemb, size_t size) {
+  if (!bench_resolve()) {
+    // The static buffer is zeroed and never reused
+    return nmemb != 0 && size > (size_t)-1 / nmemb ? NULL : bench_bootstrap_alloc(nmemb * size);
+  }
+  __atomic_add_fetch(&bench_allocs, 1, __ATOMIC_RELAXED);
+  return real_calloc(nmemb, size);
+}
+
+void *realloc(void *ptr, size_t size) {
+  void *p;
+  if (bench_in_bootstrap(ptr)) {
+    size_t left = bench_bootstrap + sizeof(bench_bootstrap) - (char *)ptr;
+    p = malloc(size);
+    if (p != NULL) {
+      memcpy(p, ptr, size < left ? size : left);
+    }
+    return p;
+  }
+  if (!bench_resolve()) {
+    return ptr == NULL ? bench_bootstrap_alloc(size) : NULL;
+  }
+  __atomic_add_fetch(&bench_allocs, 1, __ATOMIC_RELAXED);
+  return real_realloc(ptr, size);
+}
+
+void free(void *ptr) {
+  if (ptr == NULL || bench_in_bootstrap(ptr) || !bench_resolve()) {
+    return;
+  }
+  real_free(ptr);
+}
+#endif
+
+static double elapsed_seconds(const struct timespec *start) {
+  struct timespec end;
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  return (end.tv_sec - start->tv_sec) + (end.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+/**
+ * @brief Write log lines the way logMessage() did before the log sink existed.
+ *
+ * Every line rebuilds the log directory, runs make_directory(), formats a dated filename
+ * and does fopen/fprintf/fclose.
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+static void log_bench_legacy(int lines, char *app, char *appName) {
+  int i;
+  int pid = (int)getpid();
+  for (i = 0; i < lines; i++) {
+    char *log_dir = prepareLogDir(DATA_LOG, app);
+    char *filename = logFilenameWithTimeStamp(0, log_dir, app);
+    logMessageWithLogName(0, 1, filename, pid, app, appName, "Thread_bench", "Benchmark line through the open/append/close path.");
+    free(filename);
+    free(log_dir);
+  }
+}
+
+static void log_bench_sink(int lines, char *app, char *appName) {
+  int i;
+  for (i = 0; i < lines; i++) {
+    logMessage(1, 0, app, appName, "Thread_bench", "Benchmark line through the cached log sink.");
+  }
+}
+
+static void log_bench_printf(int lines, char *app, char *appName) {
+  int i;
+  for (i = 0; i < lines; i++) {
+    log_printf(app, appName, 0, "Thread_bench", "Benchmark line %d of %d through %s.", i, lines, "log_printf");
+  }
+}
+
+struct bench_writer {
+  pthread_t tid;
+  int lines;
+};
+
+static void *log_bench_writer(void *arg) {
+  struct bench_writer *writer = arg;
+  char line[] = "2026-10-17 00:00:00 " APP_NAME " #0 ]   «Thread_bench» Benchmark line through the durability modes.\n";
+  int i;
+  for (i = 0; i < writer->lines; i++) {
+    log_sink_write(LOG_BENCH_APP, 0, line, sizeof(line) - 1);
+  }
+  return NULL;
+}
+
+/*
+ * Append through the sink from LOG_BENCH_WRITERS threads in each durability mode, and print the
+ * fsyncs and commit latency next to the throughput.
+ */
+static void log_bench_sync(int lines) {
+  static const struct {
+    const char *name;
+    enum log_sync_mode mode;
+    int interval;
+  } modes[] = {
+    {"sync-none", LOG_SYNC_NONE, -1},
+    {"sync-period", LOG_SYNC_PERIODIC, 100},
+    {"sync-group", LOG_SYNC_GROUP, -1},
+    {"sync-record", LOG_SYNC_RECORD, -1},
+  };
+  struct bench_writer writers[LOG_BENCH_WRITERS];
+  enum log_sync_mode saved = log_sync_mode();
+  size_t m;
+  int i;
+  for (m = 0; m < sizeof(modes) / sizeof(modes[0]); m++) {
+    struct timespec start;
+    char report[160];
+    double seconds;
+    log_sync_configure(modes[m].mode, modes[m].interval);
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (i = 0; i < LOG_BENCH_WRITERS; i++) {
+      writers[i].lines = lines / LOG_BENCH_WRITERS;
+      pthread_create(&writers[i].tid, NULL, log_bench_writer, &writers[i]);
+    }
+    for (i = 0; i < LOG_BENCH_WRITERS; i++) {
+      pthread_join(writers[i].tid, NULL);
+    }
+    seconds = elapsed_seconds(&start);
+    if (modes[m].mode == LOG_SYNC_PERIODIC) {
+      // Let a round of the syncer thread cover the lines
+      usleep((modes[m].interval + 50) * 1000);
+    }
+    log_sync_report(report, sizeof(report));
+    printf("%-12s %10d lines %10.0f lines/sec  %s\n", modes[m].name, lines / LOG_BENCH_WRITERS * LOG_BENCH_WRITERS,
+      lines / LOG_BENCH_WRITERS * LOG_BENCH_WRITERS / seconds, report);
+  }
+  log_sync_configure(saved, 0);
+}
+
+static void log_bench_report(const char *path, int lines, double seconds, unsigned long allocs, const char *note) {
+#ifdef LOG_BENCH_MALLOC
+  printf("%-12s %10d lines %10.0f lines/sec %6.2f allocs/line%s\n", path, lines, lines / seconds,
+    (double)allocs / lines, note);
+#else
+  (void)allocs;
+  printf("%-12s %10d lines %10.0f lines/sec%s\n", path, lines, lines / seconds, note);
+#endif
+}
+
+/**
+ * @brief Measure the lines per second of the log writing paths.
+ *
+ * This function writes the same number of lines through the legacy open/append/close path,
+ * through the cached log sink, through the printf-style API and through the asynchronous
+ * flusher, into DATA_LOG/ll-log-bench/, and prints the throughput of each path, and its heap
+ * allocations per line, libc's included, in the binary of `sh build.sh bench`. The next run
+ * repeats the line with the duplicate suppression on, which gives the cost of a suppressed log
+ * call. The last runs append from several threads in each LL_LOG_SYNC durability mode, and
+ * print the fsyncs per second and the commit latency of each.
+ *
+ * @param lines The number of lines to write through each path.
+ *
+ * @return 0 on success.
+ *
+ * @note This function requires the following include files:
+ * @note #include <time.h>, for clock_gettime
+ *
+ * @see logMessage()
+ * @see log_printf()
+ * @see log_sink_write()
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+int log_bench(int lines) {
+  struct timespec start;
+  double legacy, sink, printf_path, async, dedup;
+  unsigned long legacy_allocs, sink_allocs, printf_allocs, async_allocs, dedup_allocs;
+  char app[] = LOG_BENCH_APP;
+  char appName[] = APP_NAME;
+  if (lines <= 0) {
+    lines = LOG_BENCH_LINES;
+  }
+  // Every path writes the same line over and over: measure the writes, not the suppression
+  log_dedup_configure(0, 0);
+  // Warm up the sinks, the time stamp cache and the timezone
+  log_bench_sink(1, app, appName);
+  log_bench_printf(1, app, appName);
+
+  legacy_allocs = bench_allocs;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  log_bench_legacy(lines, app, appName);
+  legacy = elapsed_seconds(&start);
+  legacy_allocs = bench_allocs - legacy_allocs;
+
+  sink_allocs = bench_allocs;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  log_bench_sink(lines, app, appName);
+  sink = elapsed_seconds(&start);
+  sink_allocs = bench_allocs - sink_allocs;
+
+  printf_allocs = bench_allocs;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  log_bench_printf(lines, app, appName);
+  printf_path = elapsed_seconds(&start);
+  printf_allocs = bench_allocs - printf_allocs;
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  log_async_start(LOG_OVERFLOW_BLOCK);
+  async_allocs = bench_allocs;
+  log_bench_sink(lines, app, appName);
+  async_allocs = bench_allocs - async_allocs;
+  log_async_drain();
+  async = elapsed_seconds(&start);
+
+  log_dedup_configure(LOG_DEDUP_BURST, LOG_DEDUP_PERIOD);
+  dedup_allocs = bench_allocs;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  log_bench_sink(lines, app, appName);
+  dedup = elapsed_seconds(&start);
+  dedup_allocs = bench_allocs - dedup_allocs;
+  log_flush_repeated(0);
+  log_async_drain();
+
+  log_bench_report("open-append", lines, legacy, legacy_allocs, "");
+  log_bench_report("log-sink", lines, sink, sink_allocs, "");
+  log_bench_report("log-printf", lines, printf_path, printf_allocs, "");
+  log_bench_report("log-async", lines, async, async_allocs, " (drained)");
+  log_bench_report("log-dedup", lines, dedup, dedup_allocs, " (repeats suppressed)");
+  printf("speedup: %.1fx\n", legacy / sink);
+  log_bench_sync(lines);
+  return 0;
+}
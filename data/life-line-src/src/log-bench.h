@@ -0,0 +1,33 @@
+#ifndef LOG_BENCH_H
+#define LOG_BENCH_H
+
+/**
+ * @file log-bench.h
+ * @brief Measure the throughput of the log writing paths
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+
+#include <dlfcn.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define LOG_BENCH_APP "ll-log-bench"
+#define LOG_BENCH_LINES 100000
+/* Threads appending at once in the durability runs, so that a group commit has a group */
+#define LOG_BENCH_WRITERS 4
+
+/**
+ * @note #include <time.h>, for clock_gettime
+ * @note #include <dlfcn.h>, for dlsym, in the build of `sh build.sh bench`
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+int log_bench(int lines);
+
+#endif /* LOG_BENCH_H */
@@ -0,0 +1,568 @@
+#include "log-binary.h"
+#include "log-message.h"
+#include "project.h"
+
+/**
+ * @file log-binary.c
+ * @brief Compact binary log records: varint fields, interned names and CRC checked blocks
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+
+static int binary_enabled = 0;
+/* Slicing-by-8 tables: crc_table[0] is the classic byte table */
+static uint32_t crc_table[8][256];
+static pthread_once_t crc_once = PTHREAD_ONCE_INIT;
+
+static int crc_hardware = 0;
+
+static void crc_init(void) {
+  uint32_t i, j;
+#if defined(__x86_64__)
+  __builtin_cpu_init();
+  crc_hardware = __builtin_cpu_supports("sse4.2");
+#endif
+  for (i = 0; i < 256; i++) {
+    uint32_t c = i;
+    for (j = 0; j < 8; j++) {
+      c = (c & 1) ? 0x82F63B78U ^ (c >> 1) : c >> 1;
+    }
+    crc_table[0][i] = c;
+  }
+  for (i = 0; i < 256; i++) {
+    for (j = 1; j < 8; j++) {
+      crc_table[j][i] = (crc_table[j - 1][i] >> 8) ^ crc_table[0][crc_table[j - 1][i] & 0xFF];
+    }
+  }
+}
+
+/**
+ * @brief Select the binary format when LL_LOG_FORMAT is "binary".
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+void log_binary_init_from_env(void) {
+  const char *value = getenv("LL_LOG_FORMAT");
+  binary_enabled = (value != NULL && strcmp(value, "binary") == 0);
+}
+
+int log_binary_enabled(void) {
+  return binary_enabled;
+}
+
+#if defined(__x86_64__)
+/* The SSE4.2 crc32 instruction computes CRC-32C, eight bytes at a time */
+__attribute__((target("sse4.2")))
+static uint32_t crc32c_sse42(uint32_t c, const unsigned char *data, size_t len) {
+  uint64_t c64 = c;
+  size_t i;
+  for (i = 0; i + 8 <= len; i += 8) {
+    uint64_t word;
+    memcpy(&word, data + i, sizeof(word));
+    c64 = __builtin_ia32_crc32di(c64, word);
+  }
+  c = (uint32_t)c64;
+  for (; i < len; i++) {
+    c = __builtin_ia32_crc32qi(c, data[i]);
+  }
+  return c;
+}
+#endif
+
+/**
+ * @brief Compute the CRC-32C (Castagnoli) of a buffer.
+ *
+ * On x86-64 processors with SSE4.2 the crc32 instruction does the work; elsewhere eight bytes
+ * are folded per step with the slicing-by-8 tables. Either way the checksum stays a small part
+ * of the cost of a block.
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+uint32_t log_binary_crc32(const unsigned char *data, size_t len) {
+  uint32_t c = 0xFFFFFFFFU;
+  size_t i;
+  pthread_once(&crc_once, crc_init);
+#if defined(__x86_64__)
+  if (crc_hardware) {
+    return crc32c_sse42(c, data, len) ^ 0xFFFFFFFFU;
+  }
+#endif
+  for (i = 0; i + 8 <= len; i += 8) {
+    uint32_t lo = c ^ (data[i] | (data[i + 1] << 8) | (data[i + 2] << 16) | ((uint32_t)data[i + 3] << 24));
+    c = crc_table[7][lo & 0xFF] ^ crc_table[6][(lo >> 8) & 0xFF] ^ crc_table[5][(lo >> 16) & 0xFF] ^
+      crc_table[4][lo >> 24] ^ crc_table[3][data[i + 4]] ^ crc_table[2][data[i + 5]] ^
+      crc_table[1][data[i + 6]] ^ crc_table[0][data[i + 7]];
+  }
+  for (; i < len; i++) {
+    c = crc_table[0][(c ^ data[i]) & 0xFF] ^ (c >> 8);
+  }
+  return c ^ 0xFFFFFFFFU;
+}
+
+size_t log_binary_put_varint(unsigned char *out, uint64_t value) {
+  size_t n = 0;
+  while (value >= 0x80) {
+    out[n++] = (unsigned char)(value | 0x80);
+    value >>= 7;
+  }
+  out[n++] = (unsigned char)value;
+  return n;
+}
+
+/**
+ * @brief Read a varint and advance the cursor.
+ *
+ * @return 0 on success, -1 if the varint is truncated or longer than 64 bits.
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+int log_binary_get_varint(const unsigned char **p, const unsigned char *end, uint64_t *value) {
+  uint64_t v = 0;
+  int shift = 0;
+  while (*p < end && shift < 64) {
+    unsigned char b = *(*p)++;
+    v |= (uint64_t)(b & 0x7F) << shift;
+    if (!(b & 0x80)) {
+      *value = v;
+      return 0;
+    }
+    shift += 7;
+  }
+  return -1;
+}
+
+/**
+ * @brief Build the pending form of a binary log record.
+ *
+ * @param out The buffer receiving the record.
+ * @param size The size of the buffer; the message is truncated to fit.
+ * @param t The time of the record.
+ * @param pid The pid written in the record.
+ * @param app_name The application name written in the record.
+ * @param version The version, or "" for none.
+ * @param thread The name of the thread, or "" for none.
+ * @param msg The message.
+ * @param msg_len The length of the message.
+ *
+ * @return The length of the record, or -1 if the names do not fit.
+ *
+ * @see log_binary_block()
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+int log_binary_pending(unsigned char *out, size_t size, time_t t, int pid, const char *app_name,
+    const char *version, const char *thread, const char *msg, size_t msg_len) {
+  size_t app_len = strlen(app_name) + 1;
+  size_t version_len = strlen(version) + 1;
+  size_t thread_len = strlen(thread) + 1;
+  size_t n = 0;
+  if (size < 1 + 20 + app_len + version_len + thread_len) {
+    return -1;
+  }
+  out[n++] = LOG_BINARY_PENDING;
+  n += log_binary_put_varint(out + n, (uint64_t)t);
+  n += log_binary_put_varint(out + n, (uint64_t)(unsigned int)pid);
+  memcpy(out + n, app_name, app_len);
+  n += app_len;
+  memcpy(out + n, version, version_len);
+  n += version_len;
+  memcpy(out + n, thread, thread_len);
+  n += thread_len;
+  if (msg_len > size - n) {
+    msg_len = size - n;
+  }
+  memcpy(out + n, msg, msg_len);
+  return (int)(n + msg_len);
+}
+
+/* The names interned in the block being encoded */
+struct log_binary_names {
+  int count;
+  char name[LOG_BINARY_NAMES][LOG_BINARY_NAME_MAX];
+};
+
+/*
+ * Return the id of a name, interning it first when it is new to the block. A full table starts
+ * over from id 1, as a DEFINE may rebind an id.
+ */
+static uint64_t intern(struct log_binary_names *names, const char *name, unsigned char *out, size_t *n) {
+  size_t len = strlen(name);
+  int i;
+  if (len == 0) {
+    return 0;
+  }
+  if (len >= LOG_BINARY_NAME_MAX) {
+    len = LOG_BINARY_NAME_MAX - 1;
+  }
+  for (i = 0; i < names->count; i++) {
+    if (strncmp(names->name[i], name, len) == 0 && names->name[i][len] == 0) {
+      return i + 1;
+    }
+  }
+  if (names->count == LOG_BINARY_NAMES) {
+    names->count = 0;
+  }
+  i = names->count++;
+  memcpy(names->name[i], name, len);
+  names->name[i][len] = 0;
+  out[(*n)++] = LOG_BINARY_DEFINE;
+  *n += log_binary_put_varint(out + *n, i + 1);
+  *n += log_binary_put_varint(out + *n, len);
+  memcpy(out + *n, name, len);
+  *n += len;
+  return i + 1;
+}
+
+/**
+ * @brief Encode pending records into one block, which defines the names it uses.
+ *
+ * @param iov The pending records (see LOG_BINARY_PENDING).
+ * @param iovcnt The number of records.
+ * @param out The buffer receiving the block, at least LOG_BINARY_BLOCK_MAX bytes.
+ * @param size The size of the buffer.
+ * @param used Receives the number of records encoded, at least 1 unless a record is malformed.
+ *
+ * @return The length of the block, 0 if no record could be encoded.
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+size_t log_binary_block(const struct iovec *iov, int iovcnt, unsigned char *out, size_t size, int *used) {
+  struct log_binary_names block_names;
+  struct log_binary_names *names = &block_names;
+  unsigned char *payload = out + LOG_BINARY_HEADER_MAX;
+  size_t room = size - LOG_BINARY_HEADER_MAX;
+  size_t n = 0;
+  size_t header = 0;
+  uint64_t previous = 0;
+  uint32_t crc;
+  int i;
+  // Other processes append to the same file with their own ids: nothing is carried over
+  names->count = 0;
+  for (i = 0; i < iovcnt; i++) {
+    const unsigned char *p = iov[i].iov_base;
+    const unsigned char *end = p + iov[i].iov_len;
+    const char *app_name, *version, *thread;
+    uint64_t t, pid, app_id, version_id, thread_id;
+    size_t msg_len, need;
+    if (p == end || *p++ != LOG_BINARY_PENDING || log_binary_get_varint(&p, end, &t) != 0 ||
+        log_binary_get_varint(&p, end, &pid) != 0) {
+      break;
+    }
+    app_name = (const char *)p;
+    version = memchr(app_name, 0, end - p);
+    thread = version ? memchr(version + 1, 0, end - (const unsigned char *)version - 1) : NULL;
+    p = thread ? memchr(thread + 1, 0, end - (const unsigned char *)thread - 1) : NULL;
+    if (p == NULL) {
+      break;
+    }
+    version++;
+    thread++;
+    p++;
+    msg_len = end - p;
+    // Names, ids, varints and the message, in the worst case
+    need = 3 * (LOG_BINARY_NAME_MAX + 12) + 6 * 10 + msg_len;
+    if (n + need > room) {
+      break;
+    }
+    app_id = intern(names, app_name, payload, &n);
+    version_id = intern(names, version, payload, &n);
+    thread_id = intern(names, thread, payload, &n);
+    payload[n++] = LOG_BINARY_ENTRY;
+    if (i == 0) {
+      n += log_binary_put_varint(payload + n, t);
+    } else {
+      // Threads may hand records slightly out of order: zigzag keeps a negative delta short
+      int64_t delta = (int64_t)(t - previous);
+      n += log_binary_put_varint(payload + n, ((uint64_t)delta << 1) ^ (uint64_t)(delta >> 63));
+    }
+    n += log_binary_put_varint(payload + n, pid);
+    n += log_binary_put_varint(payload + n, app_id);
+    n += log_binary_put_varint(payload + n, version_id);
+    n += log_binary_put_varint(payload + n, thread_id);
+    n += log_binary_put_varint(payload + n, msg_len);
+    memcpy(payload + n, p, msg_len);
+    n += msg_len;
+    previous = t;
+  }
+  *used = i;
+  if (i == 0) {
+    return 0;
+  }
+  // Move the header right in front of the payload
+  {
+    unsigned char head[LOG_BINARY_HEADER_MAX];
+    head[header++] = LOG_BINARY_SYNC0;
+    head[header++] = LOG_BINARY_SYNC1;
+    header += log_binary_put_varint(head + header, n);
+    crc = log_binary_crc32(payload, n);
+    head[header++] = crc & 0xFF;
+    head[header++] = (crc >> 8) & 0xFF;
+    head[header++] = (crc >> 16) & 0xFF;
+    head[header++] = (crc >> 24) & 0xFF;
+    memmove(out, head, header);
+    memmove(out + header, payload, n);
+  }
+  return header + n;
+}
+
+struct cat_names {
+  char name[LOG_BINARY_NAMES + 1][LOG_BINARY_NAME_MAX];
+};
+
+struct cat_options {
+  int json;
+  const char *thread;  /* -t: only the records of this thread */
+  const char *grep;    /* -g: only the records whose message contains this text */
+  size_t grep_len;
+};
+
+static int cat_contains(const char *msg, size_t len, const char *text, size_t text_len) {
+  const char *p = msg;
+  const char *end = msg + len;
+  if (text_len == 0) {
+    return 1;
+  }
+  while ((size_t)(end - p) >= text_len && (p = memchr(p, text[0], end - p - text_len + 1)) != NULL) {
+    if (memcmp(p, text, text_len) == 0) {
+      return 1;
+    }
+    p++;
+  }
+  return 0;
+}
+
+static const char *cat_name(const struct cat_names *names, uint64_t id) {
+  if (id == 0) {
+    return "";
+  }
+  return id <= LOG_BINARY_NAMES && names->name[id][0] ? names->name[id] : "?";
+}
+
+static void cat_json_string(const char *s, size_t len, FILE *out) {
+  size_t i;
+  putc('"', out);
+  for (i = 0; i < len; i++) {
+    unsigned char c = (unsigned char)s[i];
+    if (c == '"' || c == '\\') {
+      putc('\\', out);
+      putc(c, out);
+    } else if (c == '\n') {
+      fputs("\\n", out);
+    } else if (c == '\t') {
+      fputs("\\t", out);
+    } else if (c < 0x20) {
+      fprintf(out, "\\u%04x", c);
+    } else {
+      putc(c, out);
+    }
+  }
+  putc('"', out);
+}
+
+static void cat_entry(int json, time_t t, uint64_t pid, const char *app, const char *version, const char *thread,
+    const char *msg, size_t msg_len, FILE *out) {
+  const char *stamp = logTimestamp(t);
+  if (json) {
+    fprintf(out, "{\"time\":\"%s\",\"epoch\":%lld,\"app\":", stamp, (long long)t);
+    cat_json_string(app, strlen(app), out);
+    if (*version) {
+      fputs(",\"version\":", out);
+      cat_json_string(version, strlen(version), out);
+    }
+    fprintf(out, ",\"pid\":%llu", (unsigned long long)pid);
+    if (*thread) {
+      fputs(",\"thread\":", out);
+      cat_json_string(thread, strlen(thread), out);
+    }
+    fputs(",\"msg\":", out);
+    cat_json_string(msg, msg_len, out);
+    fputs("}\n", out);
+    return;
+  }
+  // The text format of logMessageWithPid()
+  fprintf(out, "%s %s%s%s #%llu ] ", stamp, app, *version ? "@" : "", version, (unsigned long long)pid);
+  if (*thread) {
+    fprintf(out, "  «%s» ", thread);
+  }
+  fwrite(msg, 1, msg_len, out);
+  putc('\n', out);
+}
+
+static int cat_payload(const unsigned char *p, const unsigned char *end, struct cat_names *names,
+    const struct cat_options *opt, FILE *out) {
+  uint64_t t = 0;
+  int first = 1;
+  while (p < end) {
+    unsigned char type = *p++;
+    if (type == LOG_BINARY_DEFINE) {
+      uint64_t id, len;
+      if (log_binary_get_varint(&p, end, &id) != 0 || log_binary_get_varint(&p, end, &len) != 0 ||
+          id == 0 || id > LOG_BINARY_NAMES || len >= LOG_BINARY_NAME_MAX || len > (uint64_t)(end - p)) {
+        return -1;
+      }
+      memcpy(names->name[id], p, len);
+      names->name[id][len] = 0;
+      p += len;
+    } else if (type == LOG_BINARY_ENTRY) {
+      uint64_t delta, pid, app_id, version_id, thread_id, len;
+      if (log_binary_get_varint(&p, end, &delta) != 0 || log_binary_get_varint(&p, end, &pid) != 0 ||
+          log_binary_get_varint(&p, end, &app_id) != 0 || log_binary_get_varint(&p, end, &version_id) != 0 ||
+          log_binary_get_varint(&p, end, &thread_id) != 0 || log_binary_get_varint(&p, end, &len) != 0 ||
+          len > (uint64_t)(end - p)) {
+        return -1;
+      }
+      t = first ? delta : t + ((delta >> 1) ^ (~(delta & 1) + 1));
+      first = 0;
+      // The filters look at the fields as stored: a skipped record is never formatted
+      if ((opt->thread == NULL || strcmp(cat_name(names, thread_id), opt->thread) == 0) &&
+          (opt->grep == NULL || cat_contains((const char *)p, len, opt->grep, opt->grep_len))) {
+        cat_entry(opt->json, (time_t)t, pid, cat_name(names, app_id), cat_name(names, version_id),
+          cat_name(names, thread_id), (const char *)p, len, out);
+      }
+      p += len;
+    } else {
+      return -1;
+    }
+  }
+  return 0;
+}
+
+/*
+ * Decode one file. A block with a bad CRC, or cut short, is reported on stderr and skipped by
+ * scanning for the next sync bytes from just after its own: its length may be the damaged
+ * part, so the bytes it claims may hold valid blocks. A file read from a pipe cannot go back,
+ * and resumes after the bytes claimed. The names start over with every block, except in an
+ * LLB1 file.
+ */
+static int cat_file(FILE *in, const char *name, const struct cat_options *opt, FILE *out) {
+  struct cat_names names;
+  unsigned char magic[sizeof(LOG_BINARY_MAGIC) - 1];
+  unsigned char *payload = malloc(LOG_BINARY_BLOCK_MAX);
+  int bad = 0;
+  int resyncing = 0;
+  int per_block;
+  int c;
+  if (payload == NULL) {
+    return 1;
+  }
+  memset(&names, 0, sizeof(names));
+  if (fread(magic, 1, sizeof(magic), in) != sizeof(magic) || (memcmp(magic, LOG_BINARY_MAGIC, sizeof(magic)) != 0 &&
+      memcmp(magic, LOG_BINARY_MAGIC_V1, sizeof(magic)) != 0)) {
+    fprintf(stderr, "ll-log-cat: %s: not a binary log file\n", name);
+    free(payload);
+    return 1;
+  }
+  per_block = memcmp(magic, LOG_BINARY_MAGIC, sizeof(magic)) == 0;
+  while ((c = getc(in)) != EOF) {
+    unsigned char crc_bytes[4];
+    uint64_t len = 0;
+    int shift = 0;
+    int cut;
+    uint32_t crc;
+    off_t resume;
+    if (c != LOG_BINARY_SYNC0 || (c = getc(in)) != LOG_BINARY_SYNC1) {
+      if (c == LOG_BINARY_SYNC0) {
+        ungetc(c, in);
+      }
+      continue;
+    }
+    resume = ftello(in);
+    while ((c = getc(in)) != EOF && shift < 64) {
+      len |= (uint64_t)(c & 0x7F) << shift;
+      shift += 7;
+      if (!(c & 0x80)) {
+        break;
+      }
+    }
+    cut = c == EOF || len > LOG_BINARY_BLOCK_MAX || fread(crc_bytes, 1, 4, in) != 4 || fread(payload, 1, len, in) != len;
+    crc = cut ? 0 : crc_bytes[0] | (crc_bytes[1] << 8) | (crc_bytes[2] << 16) | ((uint32_t)crc_bytes[3] << 24);
+    if (cut || crc != log_binary_crc32(payload, len)) {
+      // A damaged stretch counts once, whatever the false sync bytes found within it
+      if (!resyncing) {
+        bad++;
+      }
+      resyncing = 1;
+      if ((resume < 0 || fseeko(in, resume, SEEK_SET) != 0) && cut) {
+        break;
+      }
+      continue;
+    }
+    resyncing = 0;
+    if (per_block) {
+      memset(&names, 0, sizeof(names));
+    }
+    if (cat_payload(payload, payload + len, &names, opt, out) != 0) {
+      bad++;
+    }
+  }
+  free(payload);
+  if (bad) {
+    fprintf(stderr, "ll-log-cat: %s: %d damaged blocks skipped\n", name, bad);
+  }
+  return bad ? 1 : 0;
+}
+
+/**
+ * @brief The ll-log-cat applet: decode binary log files to the text format or to JSON lines.
+ *
+ * Usage: ll-log-cat [-j|--json] [-t thread] [-g text] [file...]; without a file it reads the
+ * standard input. -t and -g keep the records of a thread, or whose message contains a text.
+ *
+ * @return 0 if every file decoded cleanly, 1 otherwise.
+ *
+ * @see log_binary_block()
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+int log_cat(int argc, char *argv[]) {
+  struct cat_options opt;
+  int rc = 0;
+  int files = 0;
+  int i;
+  memset(&opt, 0, sizeof(opt));
+  for (i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "-j") == 0 || strcmp(argv[i], "--json") == 0) {
+      opt.json = 1;
+    } else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) {
+      opt.thread = argv[++i];
+    } else if (strcmp(argv[i], "-g") == 0 && i + 1 < argc) {
+      opt.grep = argv[++i];
+      opt.grep_len = strlen(opt.grep);
+    } else if (argv[i][0] == '-' && argv[i][1] != 0) {
+      printf("ll-log-cat [-j|--json] [-t thread] [-g text] [file...]\n");
+      return strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0 ? 0 : 1;
+    }
+  }
+  for (i = 1; i < argc; i++) {
+    FILE *in;
+    if (strcmp(argv[i], "-t") == 0 || strcmp(argv[i], "-g") == 0) {
+      i++;
+      continue;
+    }
+    if (argv[i][0] == '-' && argv[i][1] != 0) {
+      continue;
+    }
+    files++;
+    in = strcmp(argv[i], "-") == 0 ? stdin : fopen(argv[i], "rb");
+    if (in == NULL) {
+      fprintf(stderr, "ll-log-cat: %s: cannot open\n", argv[i]);
+      rc = 1;
+      continue;
+    }
+    rc |= cat_file(in, argv[i], &opt, stdout);
+    if (in != stdin) {
+      fclose(in);
+    }
+  }
+  if (files == 0) {
+    rc = cat_file(stdin, "-", &opt, stdout);
+  }
+  return rc;
+}
@@ -0,0 +1,73 @@
+#ifndef LOG_BINARY_H
+#define LOG_BINARY_H
+
+/**
+ * @file log-binary.h
+ * @brief Compact binary log records: varint fields, interned names and CRC checked blocks
+ *
+ * A binary log file (APP-YYYY-MM-DD.llb) starts with LOG_BINARY_MAGIC and holds blocks:
+ *
+ *     0xB1 0x0C | varint payload length | CRC-32C of the payload (little endian) | payload
+ *
+ * The payload is a sequence of records:
+ *
+ *     LOG_BINARY_DEFINE  varint id, varint length, name       (interns an app, version or thread)
+ *     LOG_BINARY_ENTRY   varint time delta, varint pid, varint app id, varint version id,
+ *                        varint thread id, varint length, message
+ *
+ * The first entry of a block carries the absolute time in seconds, the next ones the zigzag
+ * encoded delta to the previous entry. Id 0 stands for no version or no thread. Names are
+ * interned per block: a block defines every name it uses, so that it decodes alone whichever
+ * process appended it, and a DEFINE may rebind an id within the block. In the LLB1 files of
+ * the first version, the ids of a DEFINE held until the end of the file.
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+#include <time.h>
+
+#define LOG_BINARY_MAGIC "LLB2"
+#define LOG_BINARY_MAGIC_V1 "LLB1"
+#define LOG_BINARY_SYNC0 0xB1
+#define LOG_BINARY_SYNC1 0x0C
+#define LOG_BINARY_DEFINE 0x01
+#define LOG_BINARY_ENTRY 0x02
+#define LOG_BINARY_EXT ".llb"
+/* A block header is at most 2 sync bytes, a 10 byte varint and the CRC */
+#define LOG_BINARY_HEADER_MAX 16
+#define LOG_BINARY_BLOCK_MAX (64 * 1024)
+#define LOG_BINARY_NAMES 64
+#define LOG_BINARY_NAME_MAX 64
+
+/*
+ * A record on its way from logMessageWithPid() to the sink, through the flusher ring or the
+ * log socket, is a LOG_BINARY_PENDING byte (text lines never start with one), the varint time,
+ * the varint pid, the app name, version and thread as NUL terminated strings, and the message.
+ */
+#define LOG_BINARY_PENDING 0x00
+
+/**
+ * @note #include <sys/uio.h>, for struct iovec
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+void log_binary_init_from_env(void);
+int log_binary_enabled(void);
+uint32_t log_binary_crc32(const unsigned char *data, size_t len);
+size_t log_binary_put_varint(unsigned char *out, uint64_t value);
+int log_binary_get_varint(const unsigned char **p, const unsigned char *end, uint64_t *value);
+int log_binary_pending(unsigned char *out, size_t size, time_t t, int pid, const char *app_name,
+    const char *version, const char *thread, const char *msg, size_t msg_len);
+size_t log_binary_block(const struct iovec *iov, int iovcnt, unsigned char *out, size_t size, int *used);
+int log_cat(int argc, char *argv[]);
+
+#endif /* LOG_BINARY_H */
@@ -0,0 +1,174 @@
+#include "log-dedup.h"
+
+/**
+ * @file log-dedup.c
+ * @brief Collapse repeated log messages into "last message repeated N times" summaries
+ *
+ * Every message is hashed together with its app, stream, pid and thread into a key, and each
+ * key owns a token bucket of LL_LOG_DEDUP tokens refilled over a period. A message is written
+ * while its bucket has a token; the repeats beyond that are only counted, and the count is
+ * written as a summary line before the message is written again, when the key is evicted from
+ * the table, or on a flush.
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+
+static struct log_dedup_entry entries[LOG_DEDUP_SLOTS];
+static int dedup_burst = LOG_DEDUP_BURST;
+static int dedup_period = LOG_DEDUP_PERIOD;
+static pthread_mutex_t dedup_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static uint64_t hash_bytes(uint64_t hash, const char *data, size_t len) {
+  size_t i;
+  for (i = 0; i < len; i++) {
+    hash ^= (unsigned char)data[i];
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+static uint64_t hash_string(uint64_t hash, const char *s) {
+  // Include the terminator so that ("ab", "c") and ("a", "bc") differ
+  return hash_bytes(hash, s, strlen(s) + 1);
+}
+
+static void emit_summary(struct log_dedup_entry *entry, log_dedup_emit emit) {
+  if (entry->repeated > 0) {
+    emit(entry);
+    entry->repeated = 0;
+  }
+}
+
+/**
+ * @brief Set the rate of the token buckets.
+ *
+ * @param burst The number of identical messages written in a row; 0 turns the suppression off.
+ * @param period The seconds it takes to refill a whole bucket.
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+void log_dedup_configure(int burst, int period) {
+  pthread_mutex_lock(&dedup_lock);
+  dedup_burst = (burst > 0 && period > 0) ? burst : 0;
+  dedup_period = period;
+  memset(entries, 0, sizeof(entries));
+  pthread_mutex_unlock(&dedup_lock);
+}
+
+/**
+ * @brief Apply the rate given in LL_LOG_DEDUP, as "burst/seconds" (e.g. "3/600") or "off".
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+void log_dedup_init_from_env(void) {
+  const char *value = getenv("LL_LOG_DEDUP");
+  int burst, period;
+  if (value == NULL) {
+    return;
+  }
+  if (strcmp(value, "off") == 0 || strcmp(value, "0") == 0) {
+    log_dedup_configure(0, 0);
+  } else if (sscanf(value, "%d/%d", &burst, &period) == 2) {
+    log_dedup_configure(burst, period);
+  }
+}
+
+/**
+ * @brief Decide whether a log message is written or counted as a repeat.
+ *
+ * @param use_version Whether the line carries the version, as given to logMessageWithPid().
+ * @param debug_mode Selects the debug log file when set.
+ * @param pid The pid written in the line.
+ * @param app The application name of the log file.
+ * @param app_name The application name written in the line.
+ * @param thread The name of the thread writing the line.
+ * @param msg The message, without the time stamp prefix.
+ * @param len The length of the message.
+ * @param emit Writes a pending summary: the one of this key before its message is written
+ * again, or the one of the key evicted from the slot.
+ *
+ * @return 1 if the message must be written, 0 if it is suppressed.
+ *
+ * @details The check is a hash of the message and a few comparisons under an uncontended
+ * mutex, so it runs on every log call; the line is only formatted if it is written.
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+int log_dedup_check(int use_version, int debug_mode, int pid, const char *app, const char *app_name,
+    const char *thread, const char *msg, size_t len, log_dedup_emit emit) {
+  struct log_dedup_entry *entry;
+  uint64_t key = 14695981039346656037ULL;
+  time_t now;
+  int pass = 1;
+  if (dedup_burst == 0) {
+    return 1;
+  }
+  key = hash_string(key, app);
+  key = hash_string(key, app_name);
+  key = hash_string(key, thread);
+  key = hash_bytes(key, (const char *)&pid, sizeof(pid));
+  key = hash_bytes(key, (const char *)&debug_mode, sizeof(debug_mode));
+  key = hash_bytes(key, msg, len);
+  if (key == 0) {
+    key = 1;
+  }
+  now = time(NULL);
+  pthread_mutex_lock(&dedup_lock);
+  entry = &entries[key % LOG_DEDUP_SLOTS];
+  if (entry->key != key) {
+    emit_summary(entry, emit);
+    entry->key = key;
+    entry->tokens = dedup_burst;
+    entry->refilled = now;
+    entry->use_version = use_version;
+    entry->debug_mode = debug_mode;
+    entry->pid = pid;
+    snprintf(entry->app, sizeof(entry->app), "%s", app);
+    snprintf(entry->app_name, sizeof(entry->app_name), "%s", app_name);
+    snprintf(entry->thread, sizeof(entry->thread), "%s", thread);
+    snprintf(entry->msg, sizeof(entry->msg), "%.*s", (int)len, msg);
+  } else if (now > entry->refilled) {
+    entry->tokens += (double)(now - entry->refilled) * dedup_burst / dedup_period;
+    if (entry->tokens > dedup_burst) {
+      entry->tokens = dedup_burst;
+    }
+    entry->refilled = now;
+  }
+  entry->last_seen = now;
+  if (entry->tokens >= 1) {
+    entry->tokens -= 1;
+    emit_summary(entry, emit);
+  } else {
+    entry->repeated++;
+    pass = 0;
+  }
+  pthread_mutex_unlock(&dedup_lock);
+  return pass;
+}
+
+/**
+ * @brief Write the pending summaries.
+ *
+ * @param idle_only When set, only the keys not seen for a whole period are flushed, so that a
+ * message that stopped repeating gets its summary; otherwise every pending summary is written,
+ * as done on a state change.
+ * @param emit Writes a summary line.
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+void log_dedup_flush(int idle_only, log_dedup_emit emit) {
+  int i;
+  time_t now = time(NULL);
+  pthread_mutex_lock(&dedup_lock);
+  for (i = 0; i < LOG_DEDUP_SLOTS; i++) {
+    if (!idle_only || now - entries[i].last_seen >= dedup_period) {
+      emit_summary(&entries[i], emit);
+    }
+  }
+  pthread_mutex_unlock(&dedup_lock);
+}
@@ -0,0 +1,57 @@
+#ifndef LOG_DEDUP_H
+#define LOG_DEDUP_H
+
+/**
+ * @file log-dedup.h
+ * @brief Collapse repeated log messages into "last message repeated N times" summaries
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define LOG_DEDUP_SLOTS 128
+#define LOG_DEDUP_NAME_MAX 64
+/* Start of the message quoted in the summary, as other messages may come in between */
+#define LOG_DEDUP_MSG_MAX 160
+/* Default of LL_LOG_DEDUP: a message may be written once per 600 seconds */
+#define LOG_DEDUP_BURST 1
+#define LOG_DEDUP_PERIOD 600
+
+struct log_dedup_entry {
+  uint64_t key;
+  double tokens;
+  time_t refilled;
+  time_t last_seen;
+  unsigned long repeated;
+  int debug_mode;
+  int use_version;
+  int pid;
+  char app[LOG_DEDUP_NAME_MAX];
+  char app_name[LOG_DEDUP_NAME_MAX];
+  char thread[LOG_DEDUP_NAME_MAX];
+  char msg[LOG_DEDUP_MSG_MAX];
+};
+
+/* Writes the summary of an entry whose repeated count is not 0 */
+typedef void (*log_dedup_emit)(const struct log_dedup_entry *entry);
+
+/**
+ * @note #include <pthread.h>, for pthread_mutex_lock
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+void log_dedup_configure(int burst, int period);
+void log_dedup_init_from_env(void);
+int log_dedup_check(int use_version, int debug_mode, int pid, const char *app, const char *app_name,
+    const char *thread, const char *msg, size_t len, log_dedup_emit emit);
+void log_dedup_flush(int idle_only, log_dedup_emit emit);
+
+#endif /* LOG_DEDUP_H */
@@ -0,0 +1,281 @@
+#include "log-flight.h"
+#include "log-level.h"
+#include "log-message.h"
+#include "project.h"
+
+/**
+ * @file log-flight.c
+ * @brief Keep the last log events of the daemon, whatever their level, in a memory mapped ring
+ *
+ * A writer takes the number of its event from the shared head with one atomic add and fills
+ * the slot of that number, clearing the slot's seq first and setting it last, so a slot cut
+ * short by a crash is recognised and skipped. A reader copies the slot and checks the seq again,
+ * so an event rewritten while it is read is skipped too. Nothing is locked, formatted beyond
+ * the message, or written to a file descriptor.
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+
+int log_flight_on = 0;
+static struct log_flight_header *flight = NULL;
+static struct log_flight_slot *flight_slots = NULL;
+static int flight_fd = -1;
+
+static const char *const level_names[] = {"ERROR", "WARN", "INFO", "DEBUG", "TRACE"};
+
+static size_t flight_size(void) {
+  return sizeof(struct log_flight_header) + LOG_FLIGHT_SLOTS * sizeof(struct log_flight_slot);
+}
+
+/* LL_LOG_FLIGHT names the ring file, or turns the recorder off */
+static const char *flight_path(void) {
+  const char *value = getenv("LL_LOG_FLIGHT");
+  if (value == NULL || *value == 0) {
+    return LOG_FLIGHT_FILE;
+  }
+  return strcmp(value, "off") == 0 || strcmp(value, "0") == 0 ? NULL : value;
+}
+
+static int flight_valid(const struct log_flight_header *h, size_t size) {
+  return memcmp(h->magic, LOG_FLIGHT_MAGIC, sizeof(LOG_FLIGHT_MAGIC)) == 0 &&
+    h->slot_size == sizeof(struct log_flight_slot) && h->slots > 0 && (h->slots & (h->slots - 1)) == 0 &&
+    sizeof(*h) + (size_t)h->slots * h->slot_size <= size;
+}
+
+static void flight_copy_name(char *dst, const char *src) {
+  size_t i;
+  for (i = 0; i < LOG_FLIGHT_NAME_MAX - 1 && src[i]; i++) {
+    dst[i] = src[i];
+  }
+  dst[i] = 0;
+}
+
+/* Print the complete events of a ring, oldest first, in the text log format */
+static int flight_print(const struct log_flight_header *h, FILE *out) {
+  const struct log_flight_slot *slots = (const struct log_flight_slot *)(h + 1);
+  uint64_t head = __atomic_load_n(&h->head, __ATOMIC_ACQUIRE);
+  uint64_t seq = head > h->slots ? head - h->slots : 0;
+  struct log_flight_slot e;
+  int count = 0;
+  for (; seq < head; seq++) {
+    const struct log_flight_slot *s = &slots[seq & (h->slots - 1)];
+    if (__atomic_load_n(&s->seq, __ATOMIC_ACQUIRE) != seq + 1) {
+      continue;
+    }
+    memcpy(&e, s, sizeof(e));
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    // A writer that took the slot during the copy has cleared its seq: the copy may be torn
+    if (__atomic_load_n(&s->seq, __ATOMIC_RELAXED) != seq + 1) {
+      continue;
+    }
+    fprintf(out, "%s %.*s #%d ] ", logTimestamp((time_t)e.time), LOG_FLIGHT_NAME_MAX, e.app_name, e.pid);
+    if (e.thread[0]) {
+      fprintf(out, "  «%.*s» ", LOG_FLIGHT_NAME_MAX, e.thread);
+    }
+    fprintf(out, "<%s> %.*s%s\n", e.level < sizeof(level_names) / sizeof(level_names[0]) ? level_names[e.level] : "?",
+      (int)(e.len < LOG_FLIGHT_MSG_MAX ? e.len : LOG_FLIGHT_MSG_MAX), e.msg, e.truncated ? "..." : "");
+    count++;
+  }
+  return count;
+}
+
+/**
+ * @brief Recover the ring of the previous run and start recording.
+ *
+ * @param thread_name The name of the calling thread, for the log message.
+ *
+ * @return The number of events recovered from an unclean exit, or -1 if the ring file cannot
+ * be mapped (the daemon then runs without it).
+ *
+ * @details The events left by a run that did not reach log_flight_stop() are written to
+ * DATA_LOG/life-line/life-line-flight-YYYY-MM-DD-HHMMSS.log and reported with a warning; the
+ * ring is then cleared and owned by this process.
+ *
+ * The owner holds an exclusive flock() on the ring file. When another process holds it, the
+ * ring is left alone, neither recovered nor recorded, and 0 is returned.
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+int log_flight_start(const char *thread_name) {
+  const char *path = flight_path();
+  size_t size = flight_size();
+  struct log_flight_header *h;
+  struct stat st;
+  int recovered = 0;
+  int fd;
+  if (path == NULL || flight != NULL) {
+    return 0;
+  }
+  fd = open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+  if (fd >= 0 && flock(fd, LOCK_EX | LOCK_NB) != 0 && errno == EWOULDBLOCK) {
+    // A second life-line, e.g. `life-line timing`: the ring is the running daemon's
+    close(fd);
+    LOG_INFO(LOG_MODULE_LOG, thread_name, "Flight recorder: %s is held by another process, not recording", path);
+    return 0;
+  }
+  if (fd < 0 || fstat(fd, &st) != 0 || ((size_t)st.st_size != size && ftruncate(fd, size) != 0)) {
+    if (fd >= 0) {
+      close(fd);
+    }
+    LOG_ERROR(LOG_MODULE_LOG, thread_name, "Flight recorder: %s ..Failed..", path);
+    return -1;
+  }
+  h = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (h == MAP_FAILED) {
+    close(fd);
+    LOG_ERROR(LOG_MODULE_LOG, thread_name, "Flight recorder: %s ..Failed..", path);
+    return -1;
+  }
+  if ((size_t)st.st_size == size && flight_valid(h, size) && !h->clean && h->head > 0) {
+    char dump[PATH_MAX];
+    char stamp[32];
+    time_t now = time(NULL);
+    struct tm tm;
+    FILE *out;
+    localtime_r(&now, &tm);
+    strftime(stamp, sizeof(stamp), "%Y-%m-%d-%H%M%S", &tm);
+    snprintf(dump, sizeof(dump), "%s/%s-flight-%s.log", LOG_DIR, APP, stamp);
+    out = fopen(dump, "w");
+    if (out != NULL) {
+      recovered = flight_print(h, out);
+      fclose(out);
+      LOG_WARN(LOG_MODULE_LOG, thread_name, "Flight recorder: %d events of pid %d, which did not exit cleanly, saved to %s",
+        recovered, h->pid, dump);
+    }
+  }
+  memset(h, 0, size);
+  memcpy(h->magic, LOG_FLIGHT_MAGIC, sizeof(LOG_FLIGHT_MAGIC));
+  h->slots = LOG_FLIGHT_SLOTS;
+  h->slot_size = sizeof(struct log_flight_slot);
+  h->pid = getpid();
+  // The lock lasts as long as the descriptor, that is until the exit
+  flight_fd = fd;
+  flight_slots = (struct log_flight_slot *)(h + 1);
+  flight = h;
+  __atomic_store_n(&log_flight_on, 1, __ATOMIC_RELEASE);
+  return recovered;
+}
+
+/**
+ * @brief Mark the ring as closed cleanly, so that the next start does not dump it.
+ *
+ * @details The mapping is kept: another thread may be writing its last event.
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+void log_flight_stop(void) {
+  if (flight == NULL) {
+    return;
+  }
+  __atomic_store_n(&log_flight_on, 0, __ATOMIC_RELEASE);
+  flight->clean = 1;
+}
+
+/**
+ * @brief Record one event.
+ *
+ * @param level The enum log_level of the event.
+ * @param pid The pid written in the line.
+ * @param app_name The application name written in the line.
+ * @param thread The name of the thread, or "".
+ * @param msg The message; the first LOG_FLIGHT_MSG_MAX bytes are kept.
+ * @param len The length of the message.
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+void log_flight_write(int level, int pid, const char *app_name, const char *thread, const char *msg, size_t len) {
+  struct log_flight_slot *s;
+  uint64_t seq;
+  if (!log_flight_active()) {
+    return;
+  }
+  seq = __atomic_fetch_add(&flight->head, 1, __ATOMIC_RELAXED);
+  s = &flight_slots[seq & (LOG_FLIGHT_SLOTS - 1)];
+  __atomic_store_n(&s->seq, 0, __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+  s->time = time(NULL);
+  s->pid = pid;
+  s->level = (uint8_t)level;
+  s->truncated = len > LOG_FLIGHT_MSG_MAX;
+  if (len > LOG_FLIGHT_MSG_MAX) {
+    len = LOG_FLIGHT_MSG_MAX;
+  }
+  s->len = (uint16_t)len;
+  memcpy(s->msg, msg, len);
+  flight_copy_name(s->app_name, app_name);
+  flight_copy_name(s->thread, thread);
+  __atomic_store_n(&s->seq, seq + 1, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief Record a printf-style event of the daemon that the log level filters out.
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+void log_flight_vprintf(int level, const char *thread, const char *fmt, va_list ap) {
+  char msg[LOG_FLIGHT_MSG_MAX + 1];
+  int len;
+  if (!log_flight_active()) {
+    return;
+  }
+  len = vsnprintf(msg, sizeof(msg), fmt, ap);
+  if (len >= 0) {
+    log_flight_write(level, logPid(), APP_NAME, thread, msg, len);
+  }
+}
+
+/**
+ * @brief Record a printf-style event of the daemon that the log level filters out.
+ *
+ * @see LOG_AT
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+void log_flight_printf(int level, const char *thread, const char *fmt, ...) {
+  va_list ap;
+  va_start(ap, fmt);
+  log_flight_vprintf(level, thread, fmt, ap);
+  va_end(ap);
+}
+
+/**
+ * @brief Print the events in the ring file, while the daemon keeps recording.
+ *
+ * @param out The stream to print to.
+ *
+ * @return The number of events printed, or -1 if there is no valid ring.
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+int log_flight_dump(FILE *out) {
+  const char *path = flight_path();
+  size_t size = flight_size();
+  const struct log_flight_header *h;
+  struct stat st;
+  int count = -1;
+  int fd = path == NULL ? -1 : open(path, O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return -1;
+  }
+  if (fstat(fd, &st) != 0 || (size_t)st.st_size < size) {
+    close(fd);
+    return -1;
+  }
+  h = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (h == MAP_FAILED) {
+    return -1;
+  }
+  if (flight_valid(h, size)) {
+    count = flight_print(h, out);
+  }
+  munmap((void *)h, size);
+  return count;
+}
@@ -0,0 +1,84 @@
+#ifndef LOG_FLIGHT_H
+#define LOG_FLIGHT_H
+
+/**
+ * @file log-flight.h
+ * @brief Keep the last log events of the daemon, whatever their level, in a memory mapped ring
+ *
+ * The ring lives in a file (LOG_FLIGHT_FILE, or LL_LOG_FLIGHT) shared with the page cache, so
+ * it outlives a killed process. The next start of the daemon dumps what an unclean exit left
+ * in it to DATA_LOG/life-line/life-line-flight-YYYY-MM-DD-HHMMSS.log.
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <time.h>
+#include <unistd.h>
+
+#define LOG_FLIGHT_MAGIC "LLFR1"
+#define LOG_FLIGHT_SLOTS 4096         /* must be a power of 2 */
+#define LOG_FLIGHT_NAME_MAX 32
+#define LOG_FLIGHT_MSG_MAX 168
+
+struct log_flight_header {
+  char magic[8];
+  uint32_t slots;
+  uint32_t slot_size;
+  uint32_t clean;     /* set by log_flight_stop(): nothing to recover */
+  int32_t pid;        /* of the process writing the ring */
+  uint64_t head;      /* the number of the next event */
+  char reserved[32];
+};
+
+struct log_flight_slot {
+  uint64_t seq;       /* the number of the event + 1 once complete, 0 while it is written */
+  int64_t time;       /* seconds since the epoch */
+  int32_t pid;
+  uint8_t level;      /* enum log_level */
+  uint8_t truncated;
+  uint16_t len;
+  char app_name[LOG_FLIGHT_NAME_MAX];
+  char thread[LOG_FLIGHT_NAME_MAX];
+  char msg[LOG_FLIGHT_MSG_MAX];
+};
+
+extern int log_flight_on;
+
+/**
+ * @brief Tell whether the events are being recorded; a single load, checked before formatting.
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+static inline int log_flight_active(void) {
+  return __atomic_load_n(&log_flight_on, __ATOMIC_RELAXED);
+}
+
+/**
+ * @note #include <sys/mman.h>, for mmap, msync
+ * @note #include <sys/file.h>, for flock
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+int log_flight_start(const char *thread_name);
+void log_flight_stop(void);
+void log_flight_write(int level, int pid, const char *app_name, const char *thread, const char *msg, size_t len);
+void log_flight_vprintf(int level, const char *thread, const char *fmt, va_list ap);
+void log_flight_printf(int level, const char *thread, const char *fmt, ...) __attribute__((format(printf, 3, 4)));
+int log_flight_dump(FILE *out);
+
+#endif /* LOG_FLIGHT_H */
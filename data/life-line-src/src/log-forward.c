@@ -0,0 +1,858 @@
+#include "log-forward.h"
+#include "log-binary.h"
+#include "project.h"
+#include "wait-ms.h"
+
+/**
+ * @file log-forward.c
+ * @brief Stream the log records to a collector over a Unix or TCP socket
+ *
+ * The text lines are read back from the log files. The sink tells the forwarder how far it has
+ * written the file of each stream (log_forward_written()), and the forwarder sends the lines
+ * from the cursor of the stream, a (file, offset) pair that moves on when the collector
+ * acknowledges them and is kept in LOG_FORWARD_CURSOR. While the collector is down the lines
+ * wait in the files, and a restarted daemon resumes from the cursor. The file of a stream that
+ * rotates meanwhile is read to its end before the next one.
+ *
+ * The records that are not in the files go through a byte ring instead: the binary records,
+ * whose files hold encoded blocks, and every record with LL_LOG_FORWARD_ONLY=1. A full ring
+ * holds the writers back for up to LOG_FORWARD_WAIT_MS while the collector is connected. Then,
+ * with LL_LOG_FORWARD_ONLY=1, the record is written to its file: the lines of that stream go
+ * to the file until the forwarder has read it back to its end, and nothing is dropped. A
+ * binary record the ring cannot take is only in its file, and counted.
+ *
+ * One frame is in flight at a time. A frame that is not acknowledged is sent again, unchanged,
+ * after the reconnection.
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+
+int log_forward_on = 0;
+static int forward_only = 0;
+static char forward_address[256];
+static unsigned char ring[LOG_FORWARD_BUFFER];
+static uint64_t ring_head = 0;    /* the first byte not acknowledged */
+static uint64_t ring_tail = 0;    /* the end of the last record */
+static uint64_t ring_records = 0; /* the records between them */
+static struct log_forward_stream streams[LOG_FORWARD_STREAMS];
+static int stream_count = 0;
+static uint64_t seq_acked = 0;    /* the number of the last acknowledged record */
+static uint64_t seq_next = 1;     /* the number of the next record sent */
+static int connected = 0;
+static int cursor_fd = -1;
+static pthread_mutex_t forward_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t forward_data = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t forward_room = PTHREAD_COND_INITIALIZER;
+
+/* The frame in flight, owned by the forwarder thread */
+static unsigned char frame[LOG_FORWARD_HEADER + LOG_FORWARD_FRAME_MAX];
+static size_t frame_len = 0;
+static uint32_t frame_count = 0;
+static int frame_stream = -1;     /* the stream of the lines, -1 for the records of the ring */
+static uint64_t frame_end = 0;    /* the ring position, or the file offset, after the frame */
+
+static unsigned long long forwarded = 0;
+static unsigned long long unforwarded = 0;
+static unsigned long skipped = 0;
+static unsigned long reconnects = 0;
+
+static void put_u32(unsigned char *p, uint32_t v) {
+  p[0] = v >> 24;
+  p[1] = v >> 16;
+  p[2] = v >> 8;
+  p[3] = v;
+}
+
+static void put_u64(unsigned char *p, uint64_t v) {
+  put_u32(p, v >> 32);
+  put_u32(p + 4, (uint32_t)v);
+}
+
+static uint32_t get_u32(const unsigned char *p) {
+  return (uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 8 | p[3];
+}
+
+static uint64_t get_u64(const unsigned char *p) {
+  return (uint64_t)get_u32(p) << 32 | get_u32(p + 4);
+}
+
+static void ring_put(uint64_t pos, const void *data, size_t len) {
+  size_t at = pos % LOG_FORWARD_BUFFER;
+  size_t first = len < LOG_FORWARD_BUFFER - at ? len : LOG_FORWARD_BUFFER - at;
+  memcpy(ring + at, data, first);
+  memcpy(ring, (const unsigned char *)data + first, len - first);
+}
+
+static void ring_get(uint64_t pos, void *data, size_t len) {
+  size_t at = pos % LOG_FORWARD_BUFFER;
+  size_t first = len < LOG_FORWARD_BUFFER - at ? len : LOG_FORWARD_BUFFER - at;
+  memcpy(data, ring + at, first);
+  memcpy((unsigned char *)data + first, ring, len - first);
+}
+
+/* The stream of an app, added when create is set and the table has room; with the lock */
+static struct log_forward_stream *stream_find(const char *app, int debug_mode, int create) {
+  struct log_forward_stream *s;
+  int i;
+  for (i = 0; i < stream_count; i++) {
+    if (streams[i].debug_mode == debug_mode && strcmp(streams[i].app, app) == 0) {
+      return &streams[i];
+    }
+  }
+  if (!create || stream_count == LOG_FORWARD_STREAMS || strlen(app) >= LOG_FORWARD_APP_MAX) {
+    return NULL;
+  }
+  s = &streams[stream_count++];
+  memset(s, 0, sizeof(*s));
+  strcpy(s->app, app);
+  s->debug_mode = debug_mode;
+  s->fd = -1;
+  return s;
+}
+
+/* Lines of the stream are in its files and not sent yet */
+static int stream_pending(const struct log_forward_stream *s) {
+  return s->paths > 1 || (s->paths == 1 && s->offset < s->written);
+}
+
+/* Anything to send; a stream read back to its end takes the ring again. With the lock. */
+static int forward_pending(void) {
+  int pending = ring_head != ring_tail;
+  int i;
+  for (i = 0; i < stream_count; i++) {
+    if (stream_pending(&streams[i])) {
+      pending = 1;
+    } else {
+      streams[i].behind = 0;
+    }
+  }
+  return pending;
+}
+
+/*
+ * LOG_FORWARD_CURSOR holds "ACKED SENT", the numbers of the last acknowledged and the last sent
+ * record, then "OFFSET<tab>DEBUG<tab>APP<tab>PATH" for every stream: the file being read and
+ * the end of its acknowledged lines. With the lock.
+ */
+static void cursor_save(void) {
+  static char text[64 + LOG_FORWARD_STREAMS * (48 + LOG_FORWARD_APP_MAX + LOG_FORWARD_PATH_MAX)];
+  int len, i;
+  if (cursor_fd < 0) {
+    return;
+  }
+  len = snprintf(text, sizeof(text), "%llu %llu\n", (unsigned long long)seq_acked, (unsigned long long)seq_next - 1);
+  for (i = 0; i < stream_count; i++) {
+    const struct log_forward_stream *s = &streams[i];
+    if (s->paths > 0 && strpbrk(s->app, "\t\n") == NULL && strpbrk(s->path[0], "\t\n") == NULL) {
+      len += snprintf(text + len, sizeof(text) - len, "%lld\t%d\t%s\t%s\n", (long long)s->offset, s->debug_mode,
+        s->app, s->path[0]);
+    }
+  }
+  if (pwrite(cursor_fd, text, len, 0) != len || ftruncate(cursor_fd, len) != 0) {
+    close(cursor_fd);
+    cursor_fd = -1;
+  }
+}
+
+static void cursor_load(void) {
+  static char text[64 + LOG_FORWARD_STREAMS * (48 + LOG_FORWARD_APP_MAX + LOG_FORWARD_PATH_MAX)];
+  unsigned long long acked, sent;
+  char *line, *next;
+  ssize_t len;
+  cursor_fd = open(LOG_FORWARD_CURSOR, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+  if (cursor_fd < 0) {
+    return;
+  }
+  len = pread(cursor_fd, text, sizeof(text) - 1, 0);
+  if (len <= 0) {
+    return;
+  }
+  text[len] = 0;
+  next = strchr(text, '\n');
+  if (sscanf(text, "%llu %llu", &acked, &sent) == 2 && sent >= acked) {
+    seq_acked = acked;
+    seq_next = sent + 1;
+  }
+  while (next != NULL) {
+    char *offset, *debug_mode, *app, *path;
+    struct log_forward_stream *s;
+    struct stat st;
+    line = next + 1;
+    next = strchr(line, '\n');
+    if (next != NULL) {
+      *next = 0;
+    }
+    offset = strtok(line, "\t");
+    debug_mode = strtok(NULL, "\t");
+    app = strtok(NULL, "\t");
+    path = strtok(NULL, "");
+    if (path == NULL || strlen(path) >= LOG_FORWARD_PATH_MAX || stat(path, &st) != 0 ||
+        (s = stream_find(app, atoi(debug_mode) != 0, 1)) == NULL) {
+      continue;
+    }
+    strcpy(s->path[0], path);
+    s->paths = 1;
+    // A file shorter than the cursor has been replaced since
+    s->offset = atoll(offset) <= st.st_size ? atoll(offset) : 0;
+    // Resume up to the end of the file: what was written while the daemon was down is sent too
+    s->written = st.st_size;
+  }
+}
+
+/*
+ * Resolve "unix:PATH" or "tcp:HOST:PORT" and connect to it, or listen on it for
+ * log_forward_collect().
+ */
+static int forward_socket(const char *address, int listening) {
+  int fd = -1;
+  if (strncmp(address, "unix:", 5) == 0) {
+    struct sockaddr_un addr;
+    if (strlen(address + 5) >= sizeof(addr.sun_path)) {
+      return -1;
+    }
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, address + 5);
+    fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+      return -1;
+    }
+    if (listening) {
+      unlink(addr.sun_path);
+    }
+    if ((listening ? bind(fd, (struct sockaddr *)&addr, sizeof(addr)) : connect(fd, (struct sockaddr *)&addr,
+        sizeof(addr))) != 0) {
+      close(fd);
+      return -1;
+    }
+  } else if (strncmp(address, "tcp:", 4) == 0) {
+    struct addrinfo hints, *res, *ai;
+    char host[256];
+    const char *port = strrchr(address + 4, ':');
+    size_t len = port == NULL ? 0 : (size_t)(port - (address + 4));
+    if (port == NULL || len >= sizeof(host)) {
+      return -1;
+    }
+    memcpy(host, address + 4, len);
+    host[len] = 0;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = listening ? AI_PASSIVE : 0;
+    if (getaddrinfo(len > 0 ? host : NULL, port + 1, &hints, &res) != 0) {
+      return -1;
+    }
+    for (ai = res; ai != NULL; ai = ai->ai_next) {
+      int one = 1;
+      fd = socket(ai->ai_family, ai->ai_socktype | SOCK_CLOEXEC, ai->ai_protocol);
+      if (fd < 0) {
+        continue;
+      }
+      if (listening) {
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+      }
+      if ((listening ? bind(fd, ai->ai_addr, ai->ai_addrlen) : connect(fd, ai->ai_addr, ai->ai_addrlen)) == 0) {
+        break;
+      }
+      close(fd);
+      fd = -1;
+    }
+    freeaddrinfo(res);
+    if (fd < 0) {
+      return -1;
+    }
+  } else {
+    errno = EINVAL;
+    return -1;
+  }
+  if (listening && listen(fd, 4) != 0) {
+    close(fd);
+    return -1;
+  }
+  if (!listening) {
+    struct timeval tv;
+    tv.tv_sec = LOG_FORWARD_ACK_TIMEOUT_MS / 1000;
+    tv.tv_usec = (LOG_FORWARD_ACK_TIMEOUT_MS % 1000) * 1000;
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+  }
+  return fd;
+}
+
+static int send_all(int fd, struct iovec *iov, int iovcnt) {
+  while (iovcnt > 0) {
+    struct msghdr msg;
+    ssize_t n;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = iov;
+    msg.msg_iovlen = iovcnt;
+    n = sendmsg(fd, &msg, MSG_NOSIGNAL);
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return -1;
+    }
+    while (iovcnt > 0 && (size_t)n >= iov->iov_len) {
+      n -= iov->iov_len;
+      iov++;
+      iovcnt--;
+    }
+    if (iovcnt > 0) {
+      iov->iov_base = (char *)iov->iov_base + n;
+      iov->iov_len -= n;
+    }
+  }
+  return 0;
+}
+
+static int recv_all(int fd, void *buf, size_t len) {
+  size_t done = 0;
+  while (done < len) {
+    ssize_t n = recv(fd, (char *)buf + done, len - done, 0);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      return -1;
+    }
+    done += n;
+  }
+  return 0;
+}
+
+static void frame_header(uint32_t count) {
+  put_u32(frame, frame_len - 4);
+  put_u64(frame + 4, seq_next);
+  put_u32(frame + 12, count);
+  frame_count = count;
+  seq_next += count;
+}
+
+/* Cut the next frame from the ring. Returns 0 when the ring is empty. */
+static int frame_from_ring(void) {
+  uint64_t start, end, pos;
+  uint32_t count = 0;
+  pthread_mutex_lock(&forward_lock);
+  start = ring_head;
+  end = ring_tail;
+  pthread_mutex_unlock(&forward_lock);
+  // The records before end do not change until they are acknowledged: cut the frame unlocked
+  for (pos = start; pos < end; count++) {
+    unsigned char rec[LOG_FORWARD_RECORD_HEADER];
+    uint64_t next;
+    ring_get(pos, rec, sizeof(rec));
+    next = pos + sizeof(rec) + rec[1] + get_u32(rec + 2);
+    if (count > 0 && next - start > LOG_FORWARD_FRAME_MAX) {
+      break;
+    }
+    pos = next;
+  }
+  if (count == 0) {
+    return 0;
+  }
+  ring_get(start, frame + LOG_FORWARD_HEADER, pos - start);
+  frame_len = LOG_FORWARD_HEADER + pos - start;
+  frame_stream = -1;
+  frame_end = pos;
+  frame_header(count);
+  return 1;
+}
+
+/*
+ * Cut the next frame from the lines of the first stream with lines not sent. Returns 0 when
+ * there is nothing to send yet, -1 when the stream moved on to its next file.
+ */
+static int frame_from_file(void) {
+  static char chunk[LOG_FORWARD_FRAME_MAX - LOG_FORWARD_RECORD_HEADER - LOG_FORWARD_APP_MAX];
+  struct log_forward_stream *s;
+  char app[LOG_FORWARD_APP_MAX];
+  size_t app_len, want, pos = 0, out = LOG_FORWARD_HEADER;
+  int64_t offset, written;
+  uint32_t count = 0;
+  ssize_t n;
+  int i, fd, last, debug_mode;
+  pthread_mutex_lock(&forward_lock);
+  for (i = 0; i < stream_count && !stream_pending(&streams[i]); i++) {
+  }
+  if (i == stream_count) {
+    pthread_mutex_unlock(&forward_lock);
+    return 0;
+  }
+  s = &streams[i];
+  if (s->fd < 0) {
+    s->fd = open(s->path[0], O_RDONLY | O_CLOEXEC);
+  }
+  fd = s->fd;
+  offset = s->offset;
+  written = s->written;
+  last = s->paths == 1;
+  debug_mode = s->debug_mode;
+  memcpy(app, s->app, sizeof(app));
+  pthread_mutex_unlock(&forward_lock);
+  want = last && written - offset < (int64_t)sizeof(chunk) ? (size_t)(written - offset) : sizeof(chunk);
+  n = fd < 0 ? -1 : pread(fd, chunk, want, offset);
+  if (n <= 0) {
+    pthread_mutex_lock(&forward_lock);
+    if (n < 0) {
+      // Removed or archived before it was read to its end
+      skipped++;
+    }
+    if (s->fd >= 0) {
+      close(s->fd);
+      s->fd = -1;
+    }
+    if (!last) {
+      memmove(&s->path[0], &s->path[1], (s->paths - 1) * sizeof(s->path[0]));
+      s->paths--;
+      s->offset = 0;
+    } else if (n < 0) {
+      s->paths = 0;
+    } else {
+      // The file is shorter than the sink knew
+      s->written = s->offset;
+    }
+    pthread_mutex_unlock(&forward_lock);
+    return -1;
+  }
+  app_len = strlen(app);
+  while (pos < (size_t)n) {
+    char *nl = memchr(chunk + pos, '\n', n - pos);
+    size_t len = nl != NULL ? (size_t)(nl - (chunk + pos)) + 1 : n - pos;
+    if (nl == NULL && !(pos == 0 && (size_t)n == sizeof(chunk)) && (last || (size_t)n == sizeof(chunk))) {
+      // The rest of a line still being written, or cut by the chunk; a line filling it goes as is
+      break;
+    }
+    if (out + LOG_FORWARD_RECORD_HEADER + app_len + len > sizeof(frame)) {
+      break;
+    }
+    frame[out] = debug_mode ? 1 : 0;
+    frame[out + 1] = app_len;
+    put_u32(frame + out + 2, len);
+    memcpy(frame + out + LOG_FORWARD_RECORD_HEADER, app, app_len);
+    memcpy(frame + out + LOG_FORWARD_RECORD_HEADER + app_len, chunk + pos, len);
+    out += LOG_FORWARD_RECORD_HEADER + app_len + len;
+    pos += len;
+    count++;
+  }
+  if (count == 0) {
+    return 0;
+  }
+  frame_len = out;
+  frame_stream = i;
+  frame_end = offset + pos;
+  frame_header(count);
+  return 1;
+}
+
+/* Send the frame in flight and wait for its acknowledgement */
+static int forward_frame(int fd) {
+  unsigned char ack[8];
+  struct iovec iov;
+  iov.iov_base = frame;
+  iov.iov_len = frame_len;
+  if (send_all(fd, &iov, 1) != 0 || recv_all(fd, ack, sizeof(ack)) != 0) {
+    return -1;
+  }
+  return get_u64(ack) == get_u64(frame + 4) + frame_count - 1 ? 0 : -1;
+}
+
+static void frame_acknowledged(void) {
+  pthread_mutex_lock(&forward_lock);
+  if (frame_stream < 0) {
+    ring_head = frame_end;
+    ring_records -= frame_count;
+  } else {
+    streams[frame_stream].offset = frame_end;
+  }
+  seq_acked = get_u64(frame + 4) + frame_count - 1;
+  forwarded += frame_count;
+  cursor_save();
+  pthread_cond_broadcast(&forward_room);
+  pthread_mutex_unlock(&forward_lock);
+  frame_len = 0;
+}
+
+static void *log_forwarder(void *arg) {
+  int delay = LOG_FORWARD_RETRY_MIN_MS;
+  int fd = -1;
+  (void)arg;
+  for (;;) {
+    int built;
+    if (fd < 0) {
+      fd = forward_socket(forward_address, 0);
+      if (fd < 0) {
+        sleep_ms(delay);
+        delay = delay * 2 < LOG_FORWARD_RETRY_MAX_MS ? delay * 2 : LOG_FORWARD_RETRY_MAX_MS;
+        continue;
+      }
+      delay = LOG_FORWARD_RETRY_MIN_MS;
+      pthread_mutex_lock(&forward_lock);
+      connected = 1;
+      reconnects++;
+      pthread_mutex_unlock(&forward_lock);
+      continue;
+    }
+    if (frame_len == 0) {
+      pthread_mutex_lock(&forward_lock);
+      while (!forward_pending()) {
+        pthread_cond_wait(&forward_data, &forward_lock);
+      }
+      pthread_mutex_unlock(&forward_lock);
+      built = frame_from_ring();
+      if (built == 0) {
+        built = frame_from_file();
+      }
+      if (built == 0) {
+        // Only the rest of a line still being written
+        sleep_ms(LOG_FORWARD_WAIT_MS);
+      }
+      if (built <= 0) {
+        continue;
+      }
+      pthread_mutex_lock(&forward_lock);
+      cursor_save();
+      pthread_mutex_unlock(&forward_lock);
+    }
+    if (forward_frame(fd) != 0) {
+      // The same frame goes again after the reconnection
+      close(fd);
+      fd = -1;
+      pthread_mutex_lock(&forward_lock);
+      connected = 0;
+      pthread_cond_broadcast(&forward_room);
+      pthread_mutex_unlock(&forward_lock);
+      continue;
+    }
+    frame_acknowledged();
+  }
+  return NULL;
+}
+
+/**
+ * @brief Start forwarding the records written by the log sink.
+ *
+ * @param address "unix:PATH" or "tcp:HOST:PORT" of the collector.
+ * @param only Write to the log files only the records the collector cannot take at once.
+ *
+ * @return 0 on success, 1 if the address is invalid or the thread cannot be started.
+ *
+ * @details The collector does not need to be up: the forwarder connects in the background and
+ * reconnects after LOG_FORWARD_RETRY_MIN_MS, doubled up to LOG_FORWARD_RETRY_MAX_MS. The
+ * streams of LOG_FORWARD_CURSOR resume from their offsets.
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+int log_forward_start(const char *address, int only) {
+  pthread_t tid;
+  if (log_forward_active()) {
+    return 0;
+  }
+  if ((strncmp(address, "unix:", 5) != 0 && strncmp(address, "tcp:", 4) != 0) ||
+      strlen(address) >= sizeof(forward_address)) {
+    return 1;
+  }
+  strcpy(forward_address, address);
+  forward_only = only;
+  cursor_load();
+  if (pthread_create(&tid, NULL, log_forwarder, NULL) != 0) {
+    return 1;
+  }
+  pthread_detach(tid);
+  __atomic_store_n(&log_forward_on, 1, __ATOMIC_RELEASE);
+  return 0;
+}
+
+/**
+ * @brief Start forwarding when LL_LOG_FORWARD names a collector.
+ *
+ * LL_LOG_FORWARD_ONLY=1 writes to the log files only what the collector cannot take at once.
+ *
+ * @return 0 if forwarding is off or started, 1 otherwise.
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+int log_forward_start_from_env(void) {
+  const char *address = getenv("LL_LOG_FORWARD");
+  const char *only = getenv("LL_LOG_FORWARD_ONLY");
+  if (address == NULL || *address == 0) {
+    return 0;
+  }
+  return log_forward_start(address, only != NULL && strcmp(only, "1") == 0);
+}
+
+/**
+ * @brief Tell whether the log files only hold what the collector could not take.
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+int log_forward_only(void) {
+  return log_forward_active() && forward_only;
+}
+
+/**
+ * @brief Queue for the collector the records that are not read back from the files.
+ *
+ * @param app The application name of the stream.
+ * @param debug_mode Set for the debug stream of the app.
+ * @param iov The complete lines, as handed to the log sink.
+ * @param iovcnt The number of lines.
+ *
+ * @return The number of leading lines taken care of; with LL_LOG_FORWARD_ONLY=1 the caller
+ * writes the others to the files.
+ *
+ * @details The text lines are left to the files, unless LL_LOG_FORWARD_ONLY=1. When the ring
+ * is full, the caller waits up to LOG_FORWARD_WAIT_MS for the collector to acknowledge a
+ * frame; it does not wait while the collector is disconnected. A line the ring cannot take
+ * then goes to its file, and so do the next lines of its stream until the forwarder has read
+ * the file back to its end.
+ *
+ * @see log_forward_written()
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+int log_forward_push(const char *app, int debug_mode, const struct iovec *iov, int iovcnt) {
+  struct log_forward_stream *s = NULL;
+  size_t app_len = strlen(app);
+  struct timespec deadline;
+  int waited = 0;
+  int i;
+  if (app_len >= LOG_FORWARD_APP_MAX) {
+    return 0;
+  }
+  pthread_mutex_lock(&forward_lock);
+  for (i = 0; i < iovcnt; i++) {
+    unsigned char rec[LOG_FORWARD_RECORD_HEADER];
+    size_t size = sizeof(rec) + app_len + iov[i].iov_len;
+    int binary = iov[i].iov_len > 0 && ((const unsigned char *)iov[i].iov_base)[0] == LOG_BINARY_PENDING;
+    if (!binary && !forward_only) {
+      // Read back from the file
+      continue;
+    }
+    if (!binary && s == NULL) {
+      s = stream_find(app, debug_mode, 1);
+    }
+    if (!binary && s != NULL && s->behind) {
+      break;
+    }
+    while (ring_tail - ring_head + size > LOG_FORWARD_BUFFER && size <= LOG_FORWARD_FRAME_MAX && connected) {
+      if (!waited) {
+        deadline_ms(&deadline, LOG_FORWARD_WAIT_MS);
+        waited = 1;
+      }
+      if (pthread_cond_timedwait(&forward_room, &forward_lock, &deadline) != 0) {
+        break;
+      }
+    }
+    if (size > LOG_FORWARD_FRAME_MAX || ring_tail - ring_head + size > LOG_FORWARD_BUFFER) {
+      if (binary) {
+        unforwarded++;
+      }
+      if (!forward_only) {
+        continue;
+      }
+      if (!binary && s != NULL) {
+        s->behind = 1;
+      }
+      break;
+    }
+    rec[0] = debug_mode ? 1 : 0;
+    rec[1] = app_len;
+    put_u32(rec + 2, iov[i].iov_len);
+    ring_put(ring_tail, rec, sizeof(rec));
+    ring_put(ring_tail + sizeof(rec), app, app_len);
+    ring_put(ring_tail + sizeof(rec) + app_len, iov[i].iov_base, iov[i].iov_len);
+    ring_tail += size;
+    ring_records++;
+  }
+  pthread_cond_signal(&forward_data);
+  pthread_mutex_unlock(&forward_lock);
+  return i;
+}
+
+/**
+ * @brief Tell the forwarder that text lines have been appended to the file of a stream.
+ *
+ * @param app The application name of the stream.
+ * @param debug_mode Set for the debug stream of the app.
+ * @param path The file written.
+ * @param start The offset of the first line written.
+ * @param end The size of the file after the lines.
+ *
+ * @details A stream new to the forwarder starts at start. A new file of a known stream, or
+ * its file created again, is read from its beginning once the previous file has been read to
+ * its end; at most LOG_FORWARD_PATHS files wait,
+ * the oldest waiting one being skipped beyond that.
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+void log_forward_written(const char *app, int debug_mode, const char *path, int64_t start, int64_t end) {
+  struct log_forward_stream *s;
+  if (strlen(path) >= LOG_FORWARD_PATH_MAX) {
+    return;
+  }
+  pthread_mutex_lock(&forward_lock);
+  s = stream_find(app, debug_mode, 1);
+  if (s == NULL) {
+    unforwarded++;
+  } else {
+    if (s->paths == 0) {
+      strcpy(s->path[0], path);
+      s->paths = 1;
+      s->offset = start;
+    } else if (strcmp(s->path[s->paths - 1], path) != 0 || start < s->written) {
+      // A new file, or one removed and created again under the same name
+      if (s->paths == LOG_FORWARD_PATHS) {
+        memmove(&s->path[1], &s->path[2], (LOG_FORWARD_PATHS - 2) * sizeof(s->path[0]));
+        s->paths--;
+        skipped++;
+      }
+      strcpy(s->path[s->paths++], path);
+    }
+    s->written = end;
+    pthread_cond_signal(&forward_data);
+  }
+  pthread_mutex_unlock(&forward_lock);
+}
+
+/**
+ * @brief Wait up to LOG_FORWARD_DRAIN_TIMEOUT for the collector to acknowledge every record.
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+void log_forward_drain(void) {
+  struct timespec deadline;
+  if (!log_forward_active()) {
+    return;
+  }
+  deadline_ms(&deadline, LOG_FORWARD_DRAIN_TIMEOUT);
+  pthread_mutex_lock(&forward_lock);
+  while (forward_pending() && connected) {
+    if (pthread_cond_timedwait(&forward_room, &forward_lock, &deadline) != 0) {
+      break;
+    }
+  }
+  pthread_mutex_unlock(&forward_lock);
+}
+
+/**
+ * @brief Describe the forwarding since the start.
+ *
+ * @param buf Receives e.g. "unix:/run/collector.sock: connected, 5230 records acknowledged,
+ * 12 waiting, 1 files behind, 0 not forwarded, 0 files skipped, 1 connections": the records
+ * waiting in the ring, the streams whose files have lines not acknowledged, the binary
+ * records left in their files only, and the files removed before they were read to the end.
+ * @param size The size of buf.
+ *
+ * @return The length of the text, as snprintf().
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+int log_forward_report(char *buf, size_t size) {
+  int behind = 0;
+  int len, i;
+  pthread_mutex_lock(&forward_lock);
+  for (i = 0; i < stream_count; i++) {
+    behind += stream_pending(&streams[i]);
+  }
+  len = snprintf(buf, size, "%s: %s, %llu records acknowledged, %llu waiting, %d files behind, %llu not forwarded, "
+    "%lu files skipped, %lu connections", forward_address, connected ? "connected" : "disconnected", forwarded,
+    (unsigned long long)ring_records, behind, unforwarded, skipped, reconnects);
+  pthread_mutex_unlock(&forward_lock);
+  return len;
+}
+
+/*
+ * Print the records of a frame, skipping those already printed, and acknowledge it.
+ */
+static int collect_frame(int fd, unsigned char *body, uint32_t len, uint64_t *last) {
+  uint64_t seq = get_u64(body);
+  uint32_t count = get_u32(body + 8);
+  unsigned char ack[8];
+  uint32_t pos = LOG_FORWARD_HEADER - 4;
+  uint32_t i;
+  struct iovec iov;
+  for (i = 0; i < count; i++, seq++) {
+    uint32_t line_len;
+    const char *app;
+    if (pos + LOG_FORWARD_RECORD_HEADER > len) {
+      return -1;
+    }
+    line_len = get_u32(body + pos + 2);
+    app = (const char *)body + pos + LOG_FORWARD_RECORD_HEADER;
+    if ((uint64_t)pos + LOG_FORWARD_RECORD_HEADER + body[pos + 1] + line_len > len) {
+      return -1;
+    }
+    if (seq > *last) {
+      const unsigned char *line = (const unsigned char *)app + body[pos + 1];
+      if (line_len > 0 && line[0] == LOG_BINARY_PENDING) {
+        printf("#%llu %.*s%s: <binary record, %u bytes>\n", (unsigned long long)seq, body[pos + 1], app,
+          body[pos] ? "[debug]" : "", line_len);
+      } else {
+        printf("#%llu %.*s%s: %.*s", (unsigned long long)seq, body[pos + 1], app, body[pos] ? "[debug]" : "",
+          (int)line_len, line);
+      }
+      *last = seq;
+    }
+    pos += LOG_FORWARD_RECORD_HEADER + body[pos + 1] + line_len;
+  }
+  fflush(stdout);
+  put_u64(ack, seq - 1);
+  iov.iov_base = ack;
+  iov.iov_len = sizeof(ack);
+  return send_all(fd, &iov, 1);
+}
+
+/**
+ * @brief A stand-in collector: print the records received on an address and acknowledge them.
+ *
+ * @param address "unix:PATH" or "tcp:HOST:PORT" to listen on.
+ *
+ * @return 1 if the address cannot be listened on; it runs until killed otherwise.
+ *
+ * @details Each record is printed once, prefixed with "#SEQ APP:" ("APP[debug]:" for the
+ * debug stream), even when the forwarder sends it again after a reconnection.
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+int log_forward_collect(const char *address) {
+  static unsigned char body[LOG_FORWARD_HEADER + LOG_FORWARD_FRAME_MAX];
+  uint64_t last = 0;
+  int server = forward_socket(address, 1);
+  if (server < 0) {
+    fprintf(stderr, "%s: cannot listen: %s\n", address, strerror(errno));
+    return 1;
+  }
+  fprintf(stderr, "%s: ..Listening..\n", address);
+  for (;;) {
+    int fd = accept(server, NULL, NULL);
+    if (fd < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return 1;
+    }
+    for (;;) {
+      unsigned char size[4];
+      uint32_t len;
+      if (recv_all(fd, size, sizeof(size)) != 0) {
+        break;
+      }
+      len = get_u32(size);
+      if (len < LOG_FORWARD_HEADER - 4 || len > sizeof(body) || recv_all(fd, body, len) != 0 ||
+          collect_frame(fd, body, len, &last) != 0) {
+        break;
+      }
+    }
+    close(fd);
+  }
+}
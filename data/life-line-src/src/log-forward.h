@@ -0,0 +1,101 @@
+#ifndef LOG_FORWARD_H
+#define LOG_FORWARD_H
+
+/**
+ * @file log-forward.h
+ * @brief Stream the log records to a collector over a Unix or TCP socket
+ *
+ * A frame carries a batch of records, all integers in network byte order:
+ *
+ *   u32 length of the rest of the frame
+ *   u64 sequence number of the first record
+ *   u32 number of records
+ *   then, per record: u8 debug_mode, u8 app length, u32 line length, app, line
+ *
+ * A line is a text log line with its newline or, with LL_LOG_FORMAT=binary, a pending binary
+ * record (see log-binary.h). The collector answers every frame with the u64 sequence number of
+ * its last record; a frame that is not acknowledged is sent again after the reconnection, so a
+ * collector can drop the repeats by their sequence numbers.
+ *
+ * The text lines are read back from the log files, after a (file, offset) cursor per stream
+ * kept in LOG_FORWARD_CURSOR: a collector down or a daemon restarted loses no line. A line
+ * sent but not acknowledged before a restart is sent again under a new sequence number.
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <time.h>
+#include <unistd.h>
+
+#define LOG_FORWARD_BUFFER (1024 * 1024)   /* bytes of records not yet acknowledged */
+#define LOG_FORWARD_FRAME_MAX (256 * 1024) /* bytes of records per frame */
+#define LOG_FORWARD_WAIT_MS 100            /* a writer waits this long for room while connected */
+#define LOG_FORWARD_ACK_TIMEOUT_MS 5000
+#define LOG_FORWARD_RETRY_MIN_MS 100       /* reconnection delay, doubled on every failure */
+#define LOG_FORWARD_RETRY_MAX_MS 30000
+#define LOG_FORWARD_DRAIN_TIMEOUT 2000     /* ms to wait for the acknowledgements on exit */
+#define LOG_FORWARD_HEADER 16
+#define LOG_FORWARD_RECORD_HEADER 6
+#define LOG_FORWARD_STREAMS 64             /* app and debug streams read back from their files */
+#define LOG_FORWARD_PATHS 4                /* files of a stream waiting to be read */
+#define LOG_FORWARD_PATH_MAX 256
+#define LOG_FORWARD_APP_MAX 64
+
+/* A text log stream, read back from its files */
+struct log_forward_stream {
+  char app[LOG_FORWARD_APP_MAX];
+  int debug_mode;
+  char path[LOG_FORWARD_PATHS][LOG_FORWARD_PATH_MAX]; /* path[0] is being read, the others follow */
+  int paths;
+  int64_t offset;  /* the end of the acknowledged lines of path[0] */
+  int64_t written; /* the end of the lines written to path[paths - 1] */
+  int behind;      /* LL_LOG_FORWARD_ONLY: the lines go to the file until it is read back */
+  int fd;          /* path[0], open for reading */
+};
+
+extern int log_forward_on;
+
+/**
+ * @brief Tell whether the records are forwarded; a single load, checked on every write.
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+static inline int log_forward_active(void) {
+  return __atomic_load_n(&log_forward_on, __ATOMIC_RELAXED);
+}
+
+/**
+ * @note #include <sys/socket.h>, for socket, connect, sendmsg
+ * @note #include <netdb.h>, for getaddrinfo
+ * @note #include <poll.h>, for poll
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+int log_forward_start(const char *address, int only);
+int log_forward_start_from_env(void);
+int log_forward_only(void);
+int log_forward_push(const char *app, int debug_mode, const struct iovec *iov, int iovcnt);
+void log_forward_written(const char *app, int debug_mode, const char *path, int64_t start, int64_t end);
+void log_forward_drain(void);
+int log_forward_report(char *buf, size_t size);
+int log_forward_collect(const char *address);
+
+#endif /* LOG_FORWARD_H */
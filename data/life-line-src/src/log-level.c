@@ -0,0 +1,158 @@
+#include "log-level.h"
+#include "log-message.h"
+#include "project.h"
+
+/**
+ * @file log-level.c
+ * @brief Log levels with a per-module verbosity that can be changed at runtime
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+
+int log_levels[LOG_MODULE_COUNT] = {
+  LOG_LEVEL_DEFAULT, LOG_LEVEL_DEFAULT, LOG_LEVEL_DEFAULT, LOG_LEVEL_DEFAULT,
+  LOG_LEVEL_DEFAULT, LOG_LEVEL_DEFAULT, LOG_LEVEL_DEFAULT
+};
+
+static const char *level_names[] = { "error", "warn", "info", "debug", "trace" };
+static const char *module_names[] = { "main", "key", "tunnel", "docroot", "copy", "permission", "log" };
+static time_t level_file_mtime = 0;
+
+static int find_name(const char *name, size_t len, const char **names, int count) {
+  int i;
+  for (i = 0; i < count; i++) {
+    if (strlen(names[i]) == len && strncmp(names[i], name, len) == 0) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+/**
+ * @brief Write a message of a given module and level.
+ *
+ * Use the LOG_ERROR, LOG_WARN, LOG_INFO, LOG_DEBUG and LOG_TRACE macros instead of calling this
+ * function directly: they skip the call, and the formatting of the arguments, when the level
+ * is disabled. Debug and trace messages go to the debug log file.
+ *
+ * @see log_level_enabled()
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+void log_level_printf(int module, int level, int debug_mode, const char *thread, const char *fmt, ...) {
+  va_list ap;
+  (void)module;
+  va_start(ap, fmt);
+  log_vprintf_level(level, APP, APP_NAME, level >= LOG_LEVEL_DEBUG ? 1 : 0, thread, fmt, ap);
+  va_end(ap);
+}
+
+void log_level_set(int module, int level) {
+  __atomic_store_n(&log_levels[module], level, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief Apply a verbosity specification.
+ *
+ * The specification is a comma separated list of "level" (applied to every module) and
+ * "module=level" entries, e.g. "warn,tunnel=debug,copy=trace". Levels are error, warn, info,
+ * debug and trace; modules are main, key, tunnel, docroot, copy, permission and log.
+ *
+ * @param spec The verbosity specification.
+ *
+ * @return 0 if every entry was understood, 1 otherwise (valid entries are still applied).
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+int log_level_parse(const char *spec) {
+  int rc = 0;
+  const char *p = spec;
+  while (*p) {
+    const char *next = p + strcspn(p, ",\n");
+    const char *end = next;
+    const char *eq = memchr(p, '=', end - p);
+    while (p < end && (*p == ' ' || *p == '\t')) {
+      p++;
+    }
+    while (end > p && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\r')) {
+      end--;
+    }
+    if (eq != NULL) {
+      int module = find_name(p, eq - p, module_names, LOG_MODULE_COUNT);
+      int level = find_name(eq + 1, end - eq - 1, level_names, LOG_LEVEL_TRACE + 1);
+      if (module >= 0 && level >= 0) {
+        log_level_set(module, level);
+      } else {
+        rc = 1;
+      }
+    } else if (end > p) {
+      int level = find_name(p, end - p, level_names, LOG_LEVEL_TRACE + 1);
+      int i;
+      if (level >= 0) {
+        for (i = 0; i < LOG_MODULE_COUNT; i++) {
+          log_level_set(i, level);
+        }
+      } else {
+        rc = 1;
+      }
+    }
+    p = *next ? next + 1 : next;
+  }
+  return rc;
+}
+
+/**
+ * @brief Apply the verbosity given in LL_LOG_LEVEL.
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+void log_level_init_from_env(void) {
+  const char *spec = getenv("LL_LOG_LEVEL");
+  if (spec != NULL) {
+    log_level_parse(spec);
+  }
+}
+
+/**
+ * @brief Re-read LOG_LEVEL_FILE when it has changed.
+ *
+ * The main loop calls this function every 10 seconds, so the verbosity of a running daemon can
+ * be changed with e.g. `echo "info,tunnel=debug" > /data/.log-level`. Removing the file leaves
+ * the current levels in place.
+ *
+ * @param thread_name The name of the thread, for the log message.
+ *
+ * @note This function requires the following include files:
+ * @note #include <sys/stat.h>, for stat
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+void log_level_reload(const char *thread_name) {
+  struct stat st;
+  char spec[256];
+  size_t len;
+  FILE *fp;
+  if (stat(LOG_LEVEL_FILE, &st) != 0 || st.st_mtime == level_file_mtime) {
+    return;
+  }
+  level_file_mtime = st.st_mtime;
+  fp = fopen(LOG_LEVEL_FILE, "r");
+  if (fp == NULL) {
+    return;
+  }
+  len = fread(spec, 1, sizeof(spec) - 1, fp);
+  fclose(fp);
+  spec[len] = 0;
+  if (log_level_parse(spec) == 0) {
+    spec[strcspn(spec, "\n")] = 0;
+    LOG_INFO(LOG_MODULE_LOG, thread_name, "Log level: %s ..Changed..", spec);
+  } else {
+    spec[strcspn(spec, "\n")] = 0;
+    LOG_WARN(LOG_MODULE_LOG, thread_name, "Log level: %s ..Partly Ignored..", spec);
+  }
+}
@@ -0,0 +1,82 @@
+#ifndef LOG_LEVEL_H
+#define LOG_LEVEL_H
+
+/**
+ * @file log-level.h
+ * @brief Log levels with a per-module verbosity that can be changed at runtime
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include "log-flight.h"
+
+enum log_level {
+  LOG_LEVEL_ERROR,
+  LOG_LEVEL_WARN,
+  LOG_LEVEL_INFO,
+  LOG_LEVEL_DEBUG,
+  LOG_LEVEL_TRACE
+};
+
+enum log_module {
+  LOG_MODULE_MAIN,        /* main loop and start-up */
+  LOG_MODULE_KEY,         /* ssh key synchronization */
+  LOG_MODULE_TUNNEL,      /* tunnel scripts */
+  LOG_MODULE_DOCROOT,     /* fix-docroot */
+  LOG_MODULE_COPY,        /* file and folder copies */
+  LOG_MODULE_PERMISSION,  /* file permissions */
+  LOG_MODULE_LOG,         /* log housekeeping */
+  LOG_MODULE_COUNT
+};
+
+#define LOG_LEVEL_DEFAULT LOG_LEVEL_INFO
+
+extern int log_levels[LOG_MODULE_COUNT];
+
+/**
+ * @brief Tell whether a message of a module and level would be written.
+ *
+ * This check is a single load and compare, so the LOG_* macros call it before any argument
+ * is formatted. debug_mode (the -d switch) enables every level, as it always did.
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+static inline int log_level_enabled(int module, int level, int debug_mode) {
+  return debug_mode || level <= __atomic_load_n(&log_levels[module], __ATOMIC_RELAXED);
+}
+
+void log_level_printf(int module, int level, int debug_mode, const char *thread, const char *fmt, ...) __attribute__((format(printf, 5, 6)));
+
+#define LOG_AT(module, level, debug_mode, thread, ...) \
+  do { \
+    if (log_level_enabled((module), (level), (debug_mode))) \
+      log_level_printf((module), (level), (debug_mode), (thread), __VA_ARGS__); \
+    else if (log_flight_active()) \
+      log_flight_printf((level), (thread), __VA_ARGS__); \
+  } while (0)
+
+#define LOG_ERROR(module, thread, ...) LOG_AT(module, LOG_LEVEL_ERROR, 0, thread, __VA_ARGS__)
+#define LOG_WARN(module, thread, ...) LOG_AT(module, LOG_LEVEL_WARN, 0, thread, __VA_ARGS__)
+#define LOG_INFO(module, thread, ...) LOG_AT(module, LOG_LEVEL_INFO, 0, thread, __VA_ARGS__)
+#define LOG_DEBUG(module, debug_mode, thread, ...) LOG_AT(module, LOG_LEVEL_DEBUG, debug_mode, thread, __VA_ARGS__)
+#define LOG_TRACE(module, debug_mode, thread, ...) LOG_AT(module, LOG_LEVEL_TRACE, debug_mode, thread, __VA_ARGS__)
+
+/**
+ * @note #include <sys/stat.h>, for stat
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+int log_level_parse(const char *spec);
+void log_level_set(int module, int level);
+void log_level_init_from_env(void);
+void log_level_reload(const char *thread_name);
+
+#endif /* LOG_LEVEL_H */
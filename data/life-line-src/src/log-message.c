@@ -1,5 +1,15 @@
 #include "project.h"
+#include "io-policy.h"
 #include "log-message.h"
+#include "log-async.h"
+#include "log-binary.h"
+#include "log-dedup.h"
+#include "log-flight.h"
+#include "log-level.h"
+#include "log-server.h"
+#include "log-sink.h"
+#include "log-spill.h"
+#include "log-sync.h"
 #include "make-directory.h"
 
 /**
@@ -63,7 +73,29 @@ char* logFilenameWithTimeStamp(int debug_mode, char *log_dir, char* app){
   return filename;
 }
 
+static int formatLogPrefix(char *line, size_t size, const char *timestamp, int useVersion, int pid, const char *appName, const char *thread);
+
+/* Queue the line of logMessageWithLogName() while the volume is unwritable; see log-spill.h */
+static void logSpillWithLogName(int useVersion, char *logFile, const char *timestamp, int pid, char *appName, const char *thread, const char *msg) {
+  char line[LOG_LINE_MAX];
+  struct iovec iov;
+  int len = formatLogPrefix(line, sizeof(line), timestamp, useVersion, pid, appName, thread);
+  if (len < 0 || len >= (int)sizeof(line)) {
+    return;
+  }
+  len += snprintf(line + len, sizeof(line) - len, "%s\n", msg);
+  if (len >= (int)sizeof(line)) {
+    len = sizeof(line) - 1;
+    line[len - 1] = '\n';
+  }
+  iov.iov_base = line;
+  iov.iov_len = len;
+  log_spill_push(logFile, 0, &iov, 1);
+}
+
 void logMessageWithLogName(int debug_mode, int useVersion, char *logFile, int pid, char *app, char *appName, const char *thread, const char *msg) {
+  static time_t written_back = 0;
+  int written;
   char timestamp[100];
   time_t t = time(NULL);
   struct tm tm = *localtime(&t);
@@ -83,24 +115,48 @@ void logMessageWithLogName(int debug_mode, int useVersion, char *logFile, int pi
       }
     }
   }
-  FILE *fp = fopen(logFile, "a");
+  FILE *fp = NULL;
+  if (log_sink_flush_spill(0) == 0) {
+    fp = fopen(logFile, "a");
+  }
   if (fp == NULL) {
+    if (log_spill_pending() || log_spill_unwritable(errno)) {
+      logSpillWithLogName(useVersion, logFile, timestamp, pid, appName, thread, msg);
+    }
     return;
   }
   if(strcmp(thread,"") == 0) {
     if(useVersion) {
-      fprintf(fp, "%s %s@%s #%d ] %s\n",timestamp, appName, APP_VERSION, pid, msg);
+      written = fprintf(fp, "%s %s@%s #%d ] %s\n",timestamp, appName, APP_VERSION, pid, msg);
     } else {
-      fprintf(fp, "%s %s #%d ] %s\n",timestamp, appName, pid, msg);
+      written = fprintf(fp, "%s %s #%d ] %s\n",timestamp, appName, pid, msg);
     }
   } else {
     if(useVersion) {
-      fprintf(fp, "%s %s@%s #%d ]   «%s» %s\n",timestamp, appName, APP_VERSION, pid, thread, msg);
+      written = fprintf(fp, "%s %s@%s #%d ]   «%s» %s\n",timestamp, appName, APP_VERSION, pid, thread, msg);
     } else {
-      fprintf(fp, "%s %s #%d ]   «%s» %s\n",timestamp, appName, pid, thread, msg);
+      written = fprintf(fp, "%s %s #%d ]   «%s» %s\n",timestamp, appName, pid, thread, msg);
     }
   }
-  fclose(fp);
+  if (log_sync_mode() != LOG_SYNC_NONE) {
+    // The descriptor is closed right away: no later round can sync this line
+    double start = log_sync_now();
+    fflush(fp);
+    fdatasync(fileno(fp));
+    log_sync_record(1, log_sync_now() - start);
+    io_policy_synced(IO_PATH_LOG, fileno(fp));
+  } else if (t - written_back >= 60) {
+    // The file is reopened for every line: start its writeback once a minute only
+    fflush(fp);
+    io_policy_writeback(IO_PATH_LOG, fileno(fp));
+    written_back = t;
+  }
+  if (written > 0) {
+    io_policy_written(IO_PATH_LOG, written);
+  }
+  if (fclose(fp) != 0 && log_spill_unwritable(errno)) {
+    logSpillWithLogName(useVersion, logFile, timestamp, pid, appName, thread, msg);
+  }
 }
 
 /**
@@ -146,26 +202,406 @@ void logMessageWithLogName(int debug_mode, int useVersion, char *logFile, int pi
  * @date 2023-06-06
  */
 void logMessage(int useVersion, int debug_mode, char *app, char *appName, const char *thread, const char *msg) {
-  int len = snprintf(NULL, 0, "%s%s", DATA_LOG, app) + 1;
-  char* log_dir = malloc(len);
-  snprintf(log_dir, len,  "%s%s", DATA_LOG, app);
-  make_directory(log_dir);
-  int pid = (int)getpid();
-  char *filename = logFilenameWithTimeStamp(debug_mode, log_dir, app);
-  logMessageWithLogName(debug_mode, useVersion, filename, pid, app, appName, thread, msg);
-  free(filename);
-  free(log_dir);
+  logMessageWithPid(useVersion, debug_mode, logPid(), app, appName, thread, msg);
+}
+
+static pthread_once_t log_once = PTHREAD_ONCE_INIT;
+static __thread time_t stamp_sec = (time_t)-1;
+static __thread char stamp[20];
+static int cached_pid = 0;
+/* The binary records log_write_line() could not write, and those already reported */
+static unsigned long unwritten = 0;
+static unsigned long unwritten_reported = 0;
+
+static void logResetPid(void) {
+  cached_pid = 0;
+}
+
+static void logInitOnce(void) {
+  // Read the timezone once; localtime_r() does not reload it afterwards
+  tzset();
+  pthread_atfork(NULL, NULL, logResetPid);
+}
+
+/**
+ * @brief Return the process ID, cached until the next fork().
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+int logPid(void) {
+  if (cached_pid == 0) {
+    pthread_once(&log_once, logInitOnce);
+    cached_pid = (int)getpid();
+  }
+  return cached_pid;
+}
+
+/**
+ * @brief Return the "YYYY-MM-DD HH:MM:SS" local time stamp of a log line.
+ *
+ * The formatted stamp is cached per thread and only rebuilt with localtime_r()/strftime()
+ * when the second changes.
+ *
+ * @param t The time to format.
+ *
+ * @return A pointer to the thread-local time stamp.
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+const char *logTimestamp(time_t t) {
+  struct tm tm;
+  if (t != stamp_sec) {
+    pthread_once(&log_once, logInitOnce);
+    localtime_r(&t, &tm);
+    strftime(stamp, sizeof(stamp), "%Y-%m-%d %H:%M:%S", &tm);
+    stamp_sec = t;
+  }
+  return stamp;
+}
+
+static int formatLogPrefix(char *line, size_t size, const char *timestamp, int useVersion, int pid, const char *appName, const char *thread) {
+  if(strcmp(thread,"") == 0) {
+    if(useVersion) {
+      return snprintf(line, size, "%s %s@%s #%d ] ",timestamp, appName, APP_VERSION, pid);
+    } else {
+      return snprintf(line, size, "%s %s #%d ] ",timestamp, appName, pid);
+    }
+  } else {
+    if(useVersion) {
+      return snprintf(line, size, "%s %s@%s #%d ]   «%s» ",timestamp, appName, APP_VERSION, pid, thread);
+    } else {
+      return snprintf(line, size, "%s %s #%d ]   «%s» ",timestamp, appName, pid, thread);
+    }
+  }
+}
+
+/**
+ * @brief Hand a formatted log line to the flusher thread, the log sink, or the log file.
+ *
+ * @param app The application name, used for the folder and the file name.
+ * @param debug_mode Selects the debug log file when set.
+ * @param line The formatted line, including the trailing newline.
+ * @param len The length of the line.
+ *
+ * @return void
+ *
+ * @details In an applet attached to a running daemon (see log_client_attach()) the line is
+ * sent over the log socket and the daemon writes it. A text line the sink cannot take is
+ * appended to the log file directly; a binary record is counted instead, and reported by
+ * log_report_unwritten().
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+void log_write_line(char *app, int debug_mode, const char *line, int len) {
+  if (log_client_active() && log_client_send_line(app, debug_mode, line, len) == 0) {
+    return;
+  }
+  if (log_async_push(app, debug_mode, line, len) != 0 && log_sink_write(app, debug_mode, line, len) != 0) {
+    char *log_dir;
+    char *filename;
+    FILE *fp;
+    if (line[0] == LOG_BINARY_PENDING) {
+      // A record has no text form to append: it is counted for log_report_unwritten()
+      __atomic_add_fetch(&unwritten, 1, __ATOMIC_RELAXED);
+      return;
+    }
+    log_dir = prepareLogDir(DATA_LOG, app);
+    filename = logFilenameWithTimeStamp(debug_mode, log_dir, app);
+    fp = fopen(filename, "a");
+    if (fp != NULL) {
+      fputs(line, fp);
+      fclose(fp);
+    }
+    free(filename);
+    free(log_dir);
+  }
+}
+
+/**
+ * @brief Log how many binary log records could not be written since the last report.
+ *
+ * @param thread_name The name of the calling thread, for the log message.
+ *
+ * @see log_write_line()
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+void log_report_unwritten(const char *thread_name) {
+  unsigned long count = __atomic_load_n(&unwritten, __ATOMIC_RELAXED);
+  if (count == unwritten_reported) {
+    return;
+  }
+  LOG_WARN(LOG_MODULE_LOG, thread_name, "%lu binary log records could not be written ..Dropped..",
+    count - unwritten_reported);
+  // The report itself may be one of them: it is not reported again
+  unwritten_reported = __atomic_load_n(&unwritten, __ATOMIC_RELAXED);
+}
+
+static void logEmit(char *app, int debug_mode, const char *line, int len) {
+  if (debug_mode) {
+    fputs(line, stderr);
+  }
+  log_write_line(app, debug_mode, line, len);
+}
+
+/*
+ * LL_LOG_FORMAT=binary: hand the fields to the sink unformatted. The echo on stderr of the
+ * debug mode stays in the text format.
+ */
+static void logEmitBinary(int useVersion, int debug_mode, int pid, char *app, const char *appName, const char *thread,
+    const char *msg, size_t msg_len) {
+  unsigned char record[LOG_LINE_MAX];
+  int len;
+  time_t now = time(NULL);
+  if (debug_mode) {
+    char prefix[LOG_LINE_MAX];
+    formatLogPrefix(prefix, sizeof(prefix), logTimestamp(now), useVersion, pid, appName, thread);
+    fprintf(stderr, "%s%.*s\n", prefix, (int)msg_len, msg);
+  }
+  len = log_binary_pending(record, sizeof(record), now, pid, appName, useVersion ? APP_VERSION : "", thread, msg, msg_len);
+  if (len > 0) {
+    log_write_line(app, debug_mode, (const char *)record, len);
+  }
+}
+
+static void logEmitRepeated(const struct log_dedup_entry *entry) {
+  char line[LOG_LINE_MAX];
+  int len;
+  if (log_binary_enabled()) {
+    len = snprintf(line, sizeof(line), "last message repeated %lu times: %s", entry->repeated, entry->msg);
+    logEmitBinary(entry->use_version, entry->debug_mode, entry->pid, (char *)entry->app, entry->app_name, entry->thread,
+      line, len < (int)sizeof(line) ? len : (int)sizeof(line) - 1);
+    return;
+  }
+  len = formatLogPrefix(line, sizeof(line), logTimestamp(time(NULL)), entry->use_version, entry->pid,
+    entry->app_name, entry->thread);
+  if (len < (int)sizeof(line)) {
+    len += snprintf(line + len, sizeof(line) - len, "last message repeated %lu times: %s\n", entry->repeated,
+      entry->msg);
+  }
+  if (len >= (int)sizeof(line)) {
+    return;
+  }
+  logEmit((char *)entry->app, entry->debug_mode, line, len);
+}
+
+/**
+ * @brief Write the "last message repeated N times" summaries of the suppressed messages.
+ *
+ * @param idle_only When set, only the messages that have not come back for a whole dedup
+ * period are summarized.
+ *
+ * @see log_dedup_flush()
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+void log_flush_repeated(int idle_only) {
+  log_dedup_flush(idle_only, logEmitRepeated);
 }
 
+/**
+ * @brief Write a log message through the cached log sink.
+ *
+ * The line is formatted once into a stack buffer (a heap buffer only for oversized messages)
+ * and queued for the flusher thread when the asynchronous mode is on, or handed to
+ * log_sink_write(), which keeps the daily log file open between calls.
+ * If the sink cannot take the line, the message falls back to an open/append/close of the
+ * dated log file.
+ *
+ * Repeats of the same message are counted by log_dedup_check() before any formatting, and a
+ * state line ("State: ...") first writes the summaries of every suppressed message.
+ *
+ * @see log_dedup_check()
+ * @see log_async_push()
+ * @see log_sink_write()
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
 void logMessageWithPid(int useVersion, int debug_mode, int pid, char *app, char *appName, const char *thread, const char *msg) {
-  int len = snprintf(NULL, 0, "%s%s", DATA_LOG, app) + 1;
-  char* log_dir = malloc(len);
-  snprintf(log_dir, len,  "%s%s", DATA_LOG, app);
-  make_directory(log_dir);
-  char *filename = logFilenameWithTimeStamp(debug_mode, log_dir, app);
-  logMessageWithLogName(debug_mode,useVersion, filename, pid, app, appName, thread, msg);
-  free(filename);
-  free(log_dir);
+  char buf[LOG_LINE_MAX];
+  char *line = buf;
+  const char *timestamp;
+  size_t msg_len = strlen(msg);
+  int prefix, len;
+  if (log_flight_active()) {
+    log_flight_write(debug_mode ? LOG_LEVEL_DEBUG : LOG_LEVEL_INFO, pid, appName, thread, msg, msg_len);
+  }
+  if (strstr(msg, "State:") != NULL) {
+    log_dedup_flush(0, logEmitRepeated);
+  } else if (!log_dedup_check(useVersion, debug_mode, pid, app, appName, thread, msg, msg_len, logEmitRepeated)) {
+    return;
+  }
+  if (log_binary_enabled()) {
+    logEmitBinary(useVersion, debug_mode, pid, app, appName, thread, msg, msg_len);
+    return;
+  }
+  timestamp = logTimestamp(time(NULL));
+  prefix = formatLogPrefix(buf, sizeof(buf), timestamp, useVersion, pid, appName, thread);
+  if (prefix < 0) {
+    return;
+  }
+  len = prefix + msg_len + 1;
+  if (len >= (int)sizeof(buf)) {
+    line = malloc(len + 1);
+    if (line == NULL) {
+      return;
+    }
+    if (prefix < (int)sizeof(buf)) {
+      memcpy(line, buf, prefix);
+    } else {
+      // A long application or thread name: buf holds only part of the prefix
+      formatLogPrefix(line, prefix + 1, timestamp, useVersion, pid, appName, thread);
+    }
+  }
+  memcpy(line + prefix, msg, len - prefix - 1);
+  line[len - 1] = '\n';
+  line[len] = 0;
+  logEmit(app, debug_mode, line, len);
+  if (line != buf) {
+    free(line);
+  }
+}
+
+/**
+ * @brief Format a printf-style log message straight into a stack buffer.
+ *
+ * Messages longer than LOG_LINE_MAX are truncated; the path performs no heap allocation.
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+void log_vprintf(char *app, const char *appName, int debug_mode, const char *thread, const char *fmt, va_list ap) {
+  log_vprintf_level(debug_mode ? LOG_LEVEL_DEBUG : LOG_LEVEL_INFO, app, appName, debug_mode, thread, fmt, ap);
+}
+
+/**
+ * @brief log_vprintf() of a message of a known level, as recorded by the flight recorder.
+ *
+ * @see log_flight_write()
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+void log_vprintf_level(int level, char *app, const char *appName, int debug_mode, const char *thread, const char *fmt, va_list ap) {
+  char line[LOG_LINE_MAX];
+  int binary = log_binary_enabled();
+  int prefix = binary ? 0 : formatLogPrefix(line, sizeof(line), logTimestamp(time(NULL)), 1, logPid(), appName, thread);
+  int len;
+  // A prefix filling the line leaves no room for the message, which is dropped
+  if (prefix < 0) {
+    prefix = 0;
+  } else if (prefix > (int)sizeof(line) - 2) {
+    prefix = sizeof(line) - 2;
+  }
+  len = prefix;
+  if (len < (int)sizeof(line) - 1) {
+    int n = vsnprintf(line + len, sizeof(line) - len - 1, fmt, ap);
+    if (n > 0) {
+      len += n;
+    }
+  }
+  if (len > (int)sizeof(line) - 2) {
+    len = sizeof(line) - 2;
+  }
+  if (log_flight_active()) {
+    log_flight_write(level, logPid(), appName, thread, line + prefix, len - prefix);
+  }
+  if (prefix < len && !log_dedup_check(1, debug_mode, logPid(), app, appName, thread, line + prefix, len - prefix,
+      logEmitRepeated)) {
+    return;
+  }
+  if (binary) {
+    logEmitBinary(1, debug_mode, logPid(), app, appName, thread, line, len);
+    return;
+  }
+  line[len++] = '\n';
+  line[len] = 0;
+  logEmit(app, debug_mode, line, len);
+}
+
+/**
+ * @brief Write a printf-style message to the log file of an app.
+ *
+ * @param app The application name, used for the folder and the file name.
+ * @param appName The application name written in the log line.
+ * @param debug_mode Selects the debug log file when set.
+ * @param thread The name of the thread writing the log message.
+ * @param fmt The printf-style format of the message.
+ *
+ * @return void
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+void log_printf(char *app, const char *appName, int debug_mode, const char *thread, const char *fmt, ...) {
+  va_list ap;
+  va_start(ap, fmt);
+  log_vprintf(app, appName, debug_mode, thread, fmt, ap);
+  va_end(ap);
+}
+
+/**
+ * @brief Write a printf-style message with a thread name to the log file.
+ *
+ * This function formats the message directly into a stack buffer, with the time stamp taken
+ * from a per-second cache, so callers no longer need the snprintf(NULL, ...)/malloc/snprintf/free
+ * sequence to build a message.
+ *
+ * @param thread The name of the thread writing the log message.
+ * @param fmt The printf-style format of the message.
+ *
+ * @return void
+ *
+ * @note This function requires the following include files:
+ * @note #include <stdarg.h> // for va_list
+ *
+ * @see log_message_w_thread()
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+void log_printf_w_thread(const char *thread, const char *fmt, ...) {
+  va_list ap;
+  va_start(ap, fmt);
+  log_vprintf(APP, APP_NAME, 0, thread, fmt, ap);
+  va_end(ap);
+}
+
+/**
+ * @brief Write a printf-style debug message with a thread name to the debug log file.
+ *
+ * Nothing is formatted when debug_mode is 0 and the main module is not set to debug.
+ *
+ * @param debug_mode A flag indicating whether or not debug mode is enabled.
+ * @param thread The name of the thread writing the log message.
+ * @param fmt The printf-style format of the message.
+ *
+ * @return void
+ *
+ * @see debug_log_message_w_thread()
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+void debug_log_printf_w_thread(int debug_mode, const char *thread, const char *fmt, ...) {
+  va_list ap;
+  if (!log_level_enabled(LOG_MODULE_MAIN, LOG_LEVEL_DEBUG, debug_mode)) {
+    if (log_flight_active()) {
+      va_start(ap, fmt);
+      log_flight_vprintf(LOG_LEVEL_DEBUG, thread, fmt, ap);
+      va_end(ap);
+    }
+    return;
+  }
+  va_start(ap, fmt);
+  log_vprintf(APP, APP_NAME, 1, thread, fmt, ap);
+  va_end(ap);
 }
 
 /**
@@ -201,7 +637,8 @@ int init_log(const char* thread_name) {
 }
 
 int init_log_appName(int debug_mode, const char* thread_name, char* appName) {
-  if (make_directory(LOG_DIR) != 0) {
+  // An applet attached to the daemon does not write the log files itself
+  if (!log_client_active() && make_directory(LOG_DIR) != 0) {
     fprintf(stderr, "  «%s» Creating directory to log ..Error..\n", thread_name);
     // No log to keep
     return 1;
@@ -288,9 +725,6 @@ void simple_log_with_pid(int pid, char* app, char* msg) {
  * opened in "append" mode, and if it doesn't exist, it will be created. If there is an error opening the file,
  * the function will return without writing the log message.
  *
- * @note This function requires the following include files:
- * @note #include <stdlib.h> // for snprintf, malloc, free
- *
  * @see log_message() for a simplified version of the log function.
  * @see init_log() to initialize the log file directory.
  *
@@ -298,13 +732,7 @@ void simple_log_with_pid(int pid, char* app, char* msg) {
  * @date 2024-04-19
  */
 void advanced_log_appname(int debug_mode, const char *thread, char *appName, const char *msg) {
-  char* app = NULL;
-  int len = snprintf(NULL, 0, APP) + 1;
-  app = malloc(len);
-  snprintf(app, len, APP);
-  len = snprintf(NULL, 0, APP_NAME) + 1;
-  logMessage(1, debug_mode, app, appName, thread, msg);
-  free(app);
+  logMessage(1, debug_mode, APP, appName, thread, msg);
 }
 
 /**
@@ -327,9 +755,6 @@ void advanced_log_appname(int debug_mode, const char *thread, char *appName, con
  * opened in "append" mode, and if it doesn't exist, it will be created. If there is an error opening the file,
  * the function will return without writing the log message.
  *
- * @note This function requires the following include files:
- * @note #include <stdlib.h> // for snprintf, malloc, free
- *
  * @see log_message() for a simplified version of the log function.
  * @see init_log() to initialize the log file directory.
  *
@@ -337,17 +762,7 @@ void advanced_log_appname(int debug_mode, const char *thread, char *appName, con
  * @date 2023-06-06
  */
 void advanced_log(int debug_mode, const char *thread, const char *msg) {
-  char* app = NULL;
-  char* appName = NULL;
-  int len = snprintf(NULL, 0, APP) + 1;
-  app = malloc(len);
-  snprintf(app, len, APP);
-  len = snprintf(NULL, 0, APP_NAME) + 1;
-  appName = malloc(len);
-  snprintf(appName, len, APP_NAME);
-  logMessage(1, debug_mode, app, appName, thread, msg);
-  free(app);
-  free(appName);
+  logMessage(1, debug_mode, APP, APP_NAME, thread, msg);
 }
 
 /**
@@ -411,8 +826,13 @@ void log_message_w_thread(const char *thread, const char *msg) {
  * @author Cloudgen Wong
  */
 void debug_log_message(int debug_mode, const char *msg) {
-  if (!debug_mode) return;
-  advanced_log( debug_mode, "", msg);
+  if (!log_level_enabled(LOG_MODULE_MAIN, LOG_LEVEL_DEBUG, debug_mode)) {
+    if (log_flight_active()) {
+      log_flight_write(LOG_LEVEL_DEBUG, logPid(), APP_NAME, "", msg, strlen(msg));
+    }
+    return;
+  }
+  advanced_log( 1, "", msg);
 }
 
 /**
@@ -435,6 +855,11 @@ void debug_log_message(int debug_mode, const char *msg) {
  * @author Cloudgen Wong
  */
 void debug_log_message_w_thread(int debug_mode, const char *thread, const char *msg) {
-  if (!debug_mode) return;
-  advanced_log( debug_mode, thread, msg);
+  if (!log_level_enabled(LOG_MODULE_MAIN, LOG_LEVEL_DEBUG, debug_mode)) {
+    if (log_flight_active()) {
+      log_flight_write(LOG_LEVEL_DEBUG, logPid(), APP_NAME, thread, msg, strlen(msg));
+    }
+    return;
+  }
+  advanced_log( 1, thread, msg);
 }
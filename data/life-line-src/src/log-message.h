@@ -10,6 +10,8 @@
  */
 
 #include <libgen.h>
+#include <pthread.h>
+#include <stdarg.h>
 #include <stdio.h>
 #include <time.h>
 #include <stdlib.h>
@@ -17,6 +19,8 @@
 #include <unistd.h>
 #include <sys/types.h>
 
+#define LOG_LINE_MAX 4096
+
 char* logDirname(const char *data_log, const char* app);
 char* prepareLogDir(const char *data_log, const char* app);
 char* logFilenameWithTimeStamp(int debug_mode, char *log_dir, char* app);
@@ -33,5 +37,15 @@ void advanced_log_appname(int debug_mode, const char *thread, char *appName, con
 void log_message_w_thread(const char *thread, const char *msg);
 void debug_log_message(int debug_mode, const char *msg);
 void debug_log_message_w_thread(int debug_mode, const char *thread, const char *msg);
+int logPid(void);
+const char *logTimestamp(time_t t);
+void log_write_line(char *app, int debug_mode, const char *line, int len);
+void log_report_unwritten(const char *thread_name);
+void log_flush_repeated(int idle_only);
+void log_vprintf(char *app, const char *appName, int debug_mode, const char *thread, const char *fmt, va_list ap);
+void log_vprintf_level(int level, char *app, const char *appName, int debug_mode, const char *thread, const char *fmt, va_list ap);
+void log_printf(char *app, const char *appName, int debug_mode, const char *thread, const char *fmt, ...) __attribute__((format(printf, 5, 6)));
+void log_printf_w_thread(const char *thread, const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+void debug_log_printf_w_thread(int debug_mode, const char *thread, const char *fmt, ...) __attribute__((format(printf, 3, 4)));
 
 #endif /* LOG_MESSAGE_H */
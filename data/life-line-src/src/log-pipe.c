@@ -0,0 +1,203 @@
+#include "log-pipe.h"
+#include "log-binary.h"
+#include "log-message.h"
+#include "log-sink.h"
+#include "log-stats.h"
+#include "log-sync.h"
+
+/**
+ * @file log-pipe.c
+ * @brief Log every line read on stdin for an app, e.g. `command 2>&1 | ll-log-pipe app`
+ *
+ * A shell loop calling ll-log-msg once per line forks, opens and closes the log file for every
+ * line. Here stdin is read LOG_PIPE_CHUNK bytes at a time, the newlines are found 64 bytes at
+ * a time with the SIMD compares of log_stats_newlines(), and the lines of a read are
+ * formatted into one batch appended by a single writev() on the stream kept open by the log
+ * sink. A line cut by the end of a read waits for the next one; a line longer than
+ * LOG_PIPE_LINE_MAX is cut into several log lines.
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+
+struct pipe_batch {
+  const char *app;
+  int debug_mode;
+  int binary;
+  int pid;
+  time_t stamp;       /* the second of the cached prefix */
+  char prefix[256];
+  int prefix_len;
+  char *out;
+  size_t used;
+  struct iovec iov[LOG_PIPE_RECORDS];
+  int count;          /* text lines share iov[0]; binary records take one each */
+  int failed;
+};
+
+static void pipe_flush(struct pipe_batch *b) {
+  if (b->count > 0 && log_sink_writev(b->app, b->debug_mode, b->iov, b->count, b->used) != 0) {
+    b->failed = 1;
+  }
+  b->used = 0;
+  b->count = 0;
+}
+
+/* The prefix of ll-log-msg, formatted once per second */
+static void pipe_stamp(struct pipe_batch *b, time_t now) {
+  b->stamp = now;
+  b->prefix_len = snprintf(b->prefix, sizeof(b->prefix), "%s %s #%d ] ", logTimestamp(now), b->app, b->pid);
+}
+
+static void pipe_line(struct pipe_batch *b, const char *line, size_t len) {
+  if (len > 0 && line[len - 1] == '\r') {
+    len--;
+  }
+  if (b->used + sizeof(b->prefix) + len + 1 > LOG_PIPE_BATCH || b->count == LOG_PIPE_RECORDS) {
+    pipe_flush(b);
+  }
+  if (b->binary) {
+    int n = log_binary_pending((unsigned char *)b->out + b->used, LOG_PIPE_BATCH - b->used, b->stamp, b->pid,
+      b->app, "", "", line, len);
+    if (n > 0) {
+      b->iov[b->count].iov_base = b->out + b->used;
+      b->iov[b->count++].iov_len = n;
+      b->used += n;
+    }
+    return;
+  }
+  memcpy(b->out + b->used, b->prefix, b->prefix_len);
+  memcpy(b->out + b->used + b->prefix_len, line, len);
+  b->used += b->prefix_len + len;
+  b->out[b->used++] = '\n';
+  b->iov[0].iov_base = b->out;
+  b->iov[0].iov_len = b->used;
+  b->count = 1;
+}
+
+static void pipe_long_line(struct pipe_batch *b, const char *line, size_t len) {
+  while (len > LOG_PIPE_LINE_MAX) {
+    pipe_line(b, line, LOG_PIPE_LINE_MAX);
+    line += LOG_PIPE_LINE_MAX;
+    len -= LOG_PIPE_LINE_MAX;
+  }
+  pipe_line(b, line, len);
+}
+
+/*
+ * Log the complete lines of buf, and the last partial one at the end of the input or when it
+ * is too long to wait for its newline. Returns the bytes consumed.
+ */
+static size_t pipe_split(struct pipe_batch *b, const char *buf, size_t have, int eof) {
+  size_t line = 0;
+  size_t block;
+  const char *nl;
+  for (block = 0; block + 64 <= have; block += 64) {
+    uint64_t mask = log_stats_newlines(buf + block);
+    while (mask != 0) {
+      size_t end = block + __builtin_ctzll(mask);
+      pipe_long_line(b, buf + line, end - line);
+      line = end + 1;
+      mask &= mask - 1;
+    }
+  }
+  if (block < line) {
+    block = line;
+  }
+  while ((nl = memchr(buf + block, '\n', have - block)) != NULL) {
+    pipe_long_line(b, buf + line, nl - (buf + line));
+    line = block = nl - buf + 1;
+  }
+  if (eof && line < have) {
+    pipe_long_line(b, buf + line, have - line);
+    line = have;
+  }
+  while (have - line >= LOG_PIPE_LINE_MAX) {
+    pipe_line(b, buf + line, LOG_PIPE_LINE_MAX);
+    line += LOG_PIPE_LINE_MAX;
+  }
+  return line;
+}
+
+/**
+ * @brief The ll-log-pipe applet: log the output of a command line by line.
+ *
+ * Usage: ll-log-pipe [-d] [-t] app
+ *
+ * Every line read on stdin is appended to the log of app as ll-log-msg would write it, until
+ * the end of the input. -d writes to the debug log instead; -t also copies stdin to stdout, so
+ * that the command's output still reaches the console.
+ *
+ * @return 0 on success, 1 on a usage error or when the log could not be written.
+ *
+ * @details The lines of a read are written as soon as they are formatted, so a slow command
+ * has its lines logged as they come while a fast one gets batches of up to LOG_PIPE_BATCH
+ * bytes. The lines are written by this process, not through the log socket of a running
+ * daemon, and follow LL_LOG_FORMAT and LL_LOG_SYNC; repeated lines are not suppressed.
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+int log_pipe(int argc, char *argv[]) {
+  static char buf[LOG_PIPE_CHUNK];
+  static char out[LOG_PIPE_BATCH];
+  static struct pipe_batch b;
+  size_t have = 0;
+  int tee = 0;
+  int eof = 0;
+  int rc = 0;
+  int i;
+  for (i = 1; i < argc && argv[i][0] == '-'; i++) {
+    if (strcmp(argv[i], "-d") == 0) {
+      b.debug_mode = 1;
+    } else if (strcmp(argv[i], "-t") == 0) {
+      tee = 1;
+    } else {
+      break;
+    }
+  }
+  if (i != argc - 1 || strlen(argv[i]) >= LOG_SINK_APP_MAX) {
+    printf("ll-log-pipe [-d] [-t] app\n");
+    return i < argc && (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) ? 0 : 1;
+  }
+  b.app = argv[i];
+  b.binary = log_binary_enabled();
+  b.pid = logPid();
+  b.out = out;
+  while (!eof) {
+    ssize_t n = read(STDIN_FILENO, buf + have, sizeof(buf) - have);
+    time_t now;
+    size_t used;
+    if (n < 0 && errno == EINTR) {
+      continue;
+    } else if (n < 0) {
+      perror("ll-log-pipe: read");
+      rc = 1;
+      n = 0;
+    }
+    eof = n == 0;
+    if (tee && n > 0 && write(STDOUT_FILENO, buf + have, n) != n) {
+      tee = 0;
+    }
+    have += n;
+    now = time(NULL);
+    if (now != b.stamp) {
+      pipe_stamp(&b, now);
+    }
+    used = pipe_split(&b, buf, have, eof);
+    memmove(buf, buf + used, have - used);
+    have -= used;
+    pipe_flush(&b);
+  }
+  if (log_sync_mode() == LOG_SYNC_PERIODIC) {
+    uint64_t covered;
+    double oldest;
+    log_sink_sync_dirty(&covered, &oldest);
+  }
+  log_sink_close_all();
+  if (b.failed) {
+    fprintf(stderr, "ll-log-pipe: the log of %s could not be written\n", b.app);
+    rc = 1;
+  }
+  return rc;
+}
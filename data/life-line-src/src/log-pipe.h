@@ -0,0 +1,38 @@
+#ifndef LOG_PIPE_H
+#define LOG_PIPE_H
+
+/**
+ * @file log-pipe.h
+ * @brief Log every line read on stdin for an app, e.g. `command 2>&1 | ll-log-pipe app`
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/uio.h>
+#include <time.h>
+#include <unistd.h>
+
+/* stdin is read this much at a time */
+#define LOG_PIPE_CHUNK (256 * 1024)
+/* The formatted lines are written in batches of up to this many bytes or records */
+#define LOG_PIPE_BATCH (256 * 1024)
+#define LOG_PIPE_RECORDS 1024
+/* Longer lines are cut into several log lines, leaving room for the prefix */
+#define LOG_PIPE_LINE_MAX (LOG_LINE_MAX - 256)
+
+/**
+ * @note #include <sys/uio.h>, for struct iovec
+ * @note #include <unistd.h>, for read
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+int log_pipe(int argc, char *argv[]);
+
+#endif /* LOG_PIPE_H */
@@ -0,0 +1,385 @@
+#include "log-query.h"
+#include "log-binary.h"
+#include "log-sink.h"
+#include "project.h"
+
+/**
+ * @file log-query.c
+ * @brief Print the log lines of an app within a time range, seeking with the sidecar index
+ *
+ * The sink appends to APP-YYYY-MM-DD.log.idx the offset of the first line of every minute
+ * (struct log_sink_index). To print from a time on, each file of the range is entered at the
+ * last indexed minute that began at least a minute earlier, instead of being read from the top.
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+
+struct query_options {
+  const char *app;
+  const char *thread;
+  char thread_tag[LOG_SINK_APP_MAX + 8];  /* "«thread» ", as written by logMessageWithPid() */
+  int debug_mode;
+  int follow;
+  time_t from_t;
+  char from[LOG_QUERY_STAMP_LEN + 1];
+  char to[LOG_QUERY_STAMP_LEN + 1];
+  char stop[LOG_QUERY_STAMP_LEN + 1];    /* a minute after "to", for lines flushed late */
+};
+
+struct query_reader {
+  FILE *in;
+  char path[PATH_MAX];
+  char stamp[LOG_QUERY_STAMP_LEN + 1];   /* of the last line, inherited by continuation lines */
+  int match;                             /* whether the last line was of the thread */
+  char *line;
+  size_t size;
+};
+
+static void query_stamp(time_t t, char *out) {
+  struct tm tm;
+  localtime_r(&t, &tm);
+  strftime(out, LOG_QUERY_STAMP_LEN + 1, "%Y-%m-%d %H:%M:%S", &tm);
+}
+
+static void query_path(char *path, size_t size, const struct query_options *opt, const char *date, int segment,
+    const char *ext) {
+  if (segment == 0) {
+    snprintf(path, size, "%s%s/%s-%s%s%s", DATA_LOG, opt->app, opt->app, date, opt->debug_mode ? "-debug" : "", ext);
+  } else {
+    snprintf(path, size, "%s%s/%s-%s%s-%d%s", DATA_LOG, opt->app, opt->app, date, opt->debug_mode ? "-debug" : "",
+      segment, ext);
+  }
+}
+
+/*
+ * The offset of the last indexed minute starting at or before t - 60. The lines before it were
+ * written, and so stamped, before the end of that minute, even when several processes append
+ * to the file. 0 when the file has no index.
+ */
+static off_t query_offset(const char *path, time_t t) {
+  char idx[PATH_MAX + sizeof(LOG_SINK_INDEX_EXT)];
+  struct log_sink_index entry;
+  off_t offset = 0;
+  FILE *in;
+  snprintf(idx, sizeof(idx), "%s" LOG_SINK_INDEX_EXT, path);
+  in = fopen(idx, "rb");
+  if (in == NULL) {
+    return 0;
+  }
+  while (fread(&entry, sizeof(entry), 1, in) == 1) {
+    if (entry.minute <= t - 60 && entry.offset > offset) {
+      offset = entry.offset;
+    }
+  }
+  fclose(in);
+  return offset;
+}
+
+static int query_open(struct query_reader *r, const char *path, off_t offset) {
+  r->in = fopen(path, "r");
+  if (r->in == NULL) {
+    return -1;
+  }
+  snprintf(r->path, sizeof(r->path), "%s", path);
+  r->stamp[0] = 0;
+  if (offset > 0 && fseeko(r->in, offset, SEEK_SET) != 0) {
+    rewind(r->in);
+  }
+  return 0;
+}
+
+static void query_close(struct query_reader *r) {
+  if (r->in != NULL) {
+    fclose(r->in);
+  }
+  r->in = NULL;
+  r->path[0] = 0;
+}
+
+/*
+ * Print the lines of the range up to the end of the file. Returns 1 once a line stamped after
+ * the stop of the range is read, 0 at the end of the file. When following, an incomplete last
+ * line is left for the next call.
+ */
+static int query_read(struct query_reader *r, const struct query_options *opt, FILE *out) {
+  ssize_t len;
+  while ((len = getline(&r->line, &r->size, r->in)) > 0) {
+    const char *line = r->line;
+    if (opt->follow && line[len - 1] != '\n') {
+      fseeko(r->in, -len, SEEK_CUR);
+      break;
+    }
+    if (len >= LOG_QUERY_STAMP_LEN && line[4] == '-' && line[7] == '-' && line[10] == ' ' && line[13] == ':' &&
+        line[16] == ':') {
+      memcpy(r->stamp, line, LOG_QUERY_STAMP_LEN);
+      r->stamp[LOG_QUERY_STAMP_LEN] = 0;
+      if (strcmp(r->stamp, opt->stop) > 0) {
+        return 1;
+      }
+      r->match = opt->thread == NULL || strstr(line, opt->thread_tag) != NULL;
+    }
+    if (r->stamp[0] && r->match && strcmp(r->stamp, opt->from) >= 0 && strcmp(r->stamp, opt->to) <= 0) {
+      fwrite(line, 1, len, out);
+    }
+  }
+  clearerr(r->in);
+  return 0;
+}
+
+static void query_note_missing(const struct query_options *opt, const char *date) {
+  static const char *const ext[] = {".log.zst", ".log.gz", LOG_BINARY_EXT};
+  char path[PATH_MAX];
+  size_t i;
+  for (i = 0; i < sizeof(ext) / sizeof(ext[0]); i++) {
+    query_path(path, sizeof(path), opt, date, 0, ext[i]);
+    if (access(path, F_OK) == 0) {
+      fprintf(stderr, "ll-log-query: %s skipped, %s\n", path,
+        i < 2 ? "decompress it to query it" : "read it with ll-log-cat");
+      return;
+    }
+  }
+}
+
+/* The last segment of today's log, which a follower reads */
+static int query_latest(const struct query_options *opt, char *path, size_t size) {
+  char date[11];
+  char next[PATH_MAX];
+  int segment;
+  time_t now = time(NULL);
+  struct tm tm;
+  localtime_r(&now, &tm);
+  strftime(date, sizeof(date), "%Y-%m-%d", &tm);
+  query_path(path, size, opt, date, 0, ".log");
+  if (access(path, F_OK) != 0) {
+    return -1;
+  }
+  for (segment = 1; segment <= LOG_SINK_SEGMENTS_MAX; segment++) {
+    query_path(next, sizeof(next), opt, date, segment, ".log");
+    if (access(next, F_OK) != 0) {
+      break;
+    }
+    snprintf(path, size, "%s", next);
+  }
+  return 0;
+}
+
+/*
+ * Follow the log as it grows: inotify wakes the reader when the directory of the app changes,
+ * and a new day or segment replaces the file being read once it appears.
+ */
+static int query_follow(struct query_reader *r, const struct query_options *opt, FILE *out) {
+  char dir[sizeof(DATA_LOG) + LOG_SINK_APP_MAX];
+  char events[4096];
+  char latest[PATH_MAX];
+  int fd = inotify_init1(IN_CLOEXEC);
+  snprintf(dir, sizeof(dir), "%s%s", DATA_LOG, opt->app);
+  if (fd < 0 || inotify_add_watch(fd, dir, IN_MODIFY | IN_CREATE | IN_MOVED_TO) < 0) {
+    fprintf(stderr, "ll-log-query: cannot watch %s\n", dir);
+    if (fd >= 0) {
+      close(fd);
+    }
+    return 1;
+  }
+  while (1) {
+    if (r->in != NULL) {
+      query_read(r, opt, out);
+    }
+    if (query_latest(opt, latest, sizeof(latest)) == 0 && strcmp(latest, r->path) != 0) {
+      if (r->in != NULL) {
+        // The last lines of the previous file
+        query_read(r, opt, out);
+        query_close(r);
+      }
+      if (query_open(r, latest, 0) == 0) {
+        continue;
+      }
+    }
+    if (fflush(out) != 0 || ferror(out)) {
+      break;
+    }
+    if (read(fd, events, sizeof(events)) < 0 && errno != EINTR) {
+      break;
+    }
+  }
+  close(fd);
+  return 0;
+}
+
+/**
+ * @brief Parse a time given to ll-log-query.
+ *
+ * @param value "YYYY-MM-DD", "YYYY-MM-DD HH:MM[:SS]" (local time), epoch seconds, "now", or an
+ * age such as "-30s", "-15m", "-2h" and "-3d".
+ * @param now The time the ages count back from.
+ * @param t Receives the time.
+ *
+ * @return 0 on success, -1 if the value is not understood.
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+int log_query_parse_time(const char *value, time_t now, time_t *t) {
+  struct tm tm;
+  long long n;
+  char *end;
+  int fields;
+  if (strcmp(value, "now") == 0) {
+    *t = now;
+    return 0;
+  }
+  if (value[0] == '-') {
+    n = strtoll(value + 1, &end, 10);
+    if (end == value + 1 || n < 0 || (*end != 0 && end[1] != 0)) {
+      return -1;
+    }
+    switch (*end) {
+      case 0:
+      case 's': break;
+      case 'm': n *= 60; break;
+      case 'h': n *= 3600; break;
+      case 'd': n *= 86400; break;
+      default: return -1;
+    }
+    *t = now - (time_t)n;
+    return 0;
+  }
+  memset(&tm, 0, sizeof(tm));
+  fields = sscanf(value, "%d-%d-%d%*[ T]%d:%d:%d", &tm.tm_year, &tm.tm_mon, &tm.tm_mday, &tm.tm_hour, &tm.tm_min,
+    &tm.tm_sec);
+  if (fields == 3 || fields == 5 || fields == 6) {
+    tm.tm_year -= 1900;
+    tm.tm_mon -= 1;
+    tm.tm_isdst = -1;
+    *t = mktime(&tm);
+    return *t == (time_t)-1 ? -1 : 0;
+  }
+  n = strtoll(value, &end, 10);
+  if (end != value && *end == 0) {
+    *t = (time_t)n;
+    return 0;
+  }
+  return -1;
+}
+
+/**
+ * @brief The ll-log-query applet: print the lines of an app's log written within a time range.
+ *
+ * Usage: ll-log-query [--app app] [--from time] [--to time] [--thread thread] [--debug] [-f]
+ *
+ * The range defaults to the current day up to now, and the app to life-line. --thread keeps the
+ * lines of one thread, --debug reads the debug stream, and -f keeps printing the lines appended
+ * from --from (default now) on, without an end, until interrupted.
+ *
+ * @return 0 on success, 1 on a usage error or when the log directory cannot be watched.
+ *
+ * @details Every dated file (and segment) of the range is entered at the offset found in its
+ * .idx sidecar, and the reading stops at the first line stamped more than a minute after the
+ * end of the range, so a query of a few minutes reads a few minutes of log whatever the size
+ * of the day. Files without an index are read from the top. Archived (.zst, .gz) and binary
+ * days are reported on stderr and skipped.
+ *
+ * @see log_query_parse_time()
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+int log_query(int argc, char *argv[]) {
+  struct query_options opt;
+  struct query_reader r;
+  struct tm tm;
+  char date[11], last_date[11];
+  char path[PATH_MAX];
+  time_t now = time(NULL);
+  time_t to_t = now;
+  time_t day;
+  int from_set = 0;
+  int done = 0;
+  int rc = 0;
+  int i;
+  memset(&opt, 0, sizeof(opt));
+  memset(&r, 0, sizeof(r));
+  opt.app = APP;
+  localtime_r(&now, &tm);
+  tm.tm_hour = tm.tm_min = tm.tm_sec = 0;
+  tm.tm_isdst = -1;
+  opt.from_t = mktime(&tm);
+  for (i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--app") == 0 && i + 1 < argc) {
+      opt.app = argv[++i];
+    } else if (strcmp(argv[i], "--thread") == 0 && i + 1 < argc) {
+      opt.thread = argv[++i];
+    } else if (strcmp(argv[i], "--from") == 0 && i + 1 < argc && log_query_parse_time(argv[i + 1], now, &opt.from_t) == 0) {
+      from_set = 1;
+      i++;
+    } else if (strcmp(argv[i], "--to") == 0 && i + 1 < argc && log_query_parse_time(argv[i + 1], now, &to_t) == 0) {
+      i++;
+    } else if (strcmp(argv[i], "--debug") == 0) {
+      opt.debug_mode = 1;
+    } else if (strcmp(argv[i], "-f") == 0 || strcmp(argv[i], "--follow") == 0) {
+      opt.follow = 1;
+    } else {
+      printf("ll-log-query [--app app] [--from time] [--to time] [--thread thread] [--debug] [-f]\n"
+        "  time: YYYY-MM-DD[ HH:MM[:SS]], epoch seconds, now, or -30s, -15m, -2h, -3d\n");
+      return strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0 ? 0 : 1;
+    }
+  }
+  if (strlen(opt.app) >= LOG_SINK_APP_MAX || strchr(opt.app, '/') != NULL ||
+      (opt.thread != NULL && strlen(opt.thread) >= LOG_SINK_APP_MAX)) {
+    fprintf(stderr, "ll-log-query: invalid app or thread name\n");
+    return 1;
+  }
+  if (opt.thread != NULL) {
+    snprintf(opt.thread_tag, sizeof(opt.thread_tag), "«%s» ", opt.thread);
+  }
+  if (opt.follow && !from_set) {
+    // Like tail -f: the lines to come
+    opt.from_t = now;
+  }
+  query_stamp(opt.from_t, opt.from);
+  if (opt.follow) {
+    // No end: the stamps compare below this one
+    snprintf(opt.to, sizeof(opt.to), "9999");
+    snprintf(opt.stop, sizeof(opt.stop), "9999");
+    to_t = now;
+  } else {
+    query_stamp(to_t, opt.to);
+    query_stamp(to_t + 60, opt.stop);
+  }
+  localtime_r(&to_t, &tm);
+  strftime(last_date, sizeof(last_date), "%Y-%m-%d", &tm);
+  day = opt.from_t;
+  while (!done) {
+    int segment;
+    localtime_r(&day, &tm);
+    strftime(date, sizeof(date), "%Y-%m-%d", &tm);
+    if (strcmp(date, last_date) > 0) {
+      break;
+    }
+    for (segment = 0; segment <= LOG_SINK_SEGMENTS_MAX && !done; segment++) {
+      query_path(path, sizeof(path), &opt, date, segment, ".log");
+      if (access(path, F_OK) != 0) {
+        if (segment == 0) {
+          query_note_missing(&opt, date);
+        }
+        break;
+      }
+      query_close(&r);
+      if (query_open(&r, path, query_offset(path, opt.from_t)) == 0) {
+        done = query_read(&r, &opt, stdout);
+      }
+    }
+    // Noon of the next day, whatever the daylight saving changes
+    tm.tm_mday++;
+    tm.tm_hour = 12;
+    tm.tm_min = tm.tm_sec = 0;
+    tm.tm_isdst = -1;
+    day = mktime(&tm);
+  }
+  if (opt.follow) {
+    rc = query_follow(&r, &opt, stdout);
+  }
+  query_close(&r);
+  free(r.line);
+  return rc;
+}
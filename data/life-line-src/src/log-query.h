@@ -0,0 +1,37 @@
+#ifndef LOG_QUERY_H
+#define LOG_QUERY_H
+
+/**
+ * @file log-query.h
+ * @brief Print the log lines of an app within a time range, seeking with the sidecar index
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <time.h>
+#include <unistd.h>
+
+/* "YYYY-MM-DD HH:MM:SS", the time stamp that starts every log line */
+#define LOG_QUERY_STAMP_LEN 19
+
+/**
+ * @note #include <sys/inotify.h>, for inotify_init1, inotify_add_watch
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+int log_query_parse_time(const char *value, time_t now, time_t *t);
+int log_query(int argc, char *argv[]);
+
+#endif /* LOG_QUERY_H */
@@ -0,0 +1,307 @@
+/* struct ucred */
+#define _GNU_SOURCE
+#include "log-level.h"
+#include "log-message.h"
+#include "log-server.h"
+#include "log-sink.h"
+#include "make-directory.h"
+#include "project.h"
+
+/**
+ * @file log-server.c
+ * @brief Receive log records from ll-log-msg and the other applets over a Unix datagram socket
+ *
+ * A datagram is a type byte followed by NUL separated fields:
+ *
+ *     M <pid> \0 <app> \0 <message>          (ll-log-msg, formatted by the daemon)
+ *     L <debug_mode> \0 <app> \0 <log line>  (an applet's own formatted log line)
+ *
+ * The daemon runs as root and <app> names the folder and the file it appends to, so the socket
+ * is open to the user of the daemon only, and every datagram carries the credentials of its
+ * sender: one from another user is dropped, and the pid logged is the sender's, whatever the
+ * datagram says. <app> must be a plain file name. Other users write their log files
+ * themselves, with their own permissions.
+ *
+ * One daemon owns the socket, the one holding the flock() of LOG_SOCKET_LOCK. Another
+ * life-line started beside it, such as `life-line timing`, leaves the socket to it, and a
+ * daemon only removes the socket it bound itself.
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+
+static int server_fd = -1;
+static int lock_fd = -1;
+static ino_t server_ino = 0;
+static pthread_t server_tid;
+static int client_fd = -1;
+static int client_active = 0;
+
+/* A plain name of a folder under DATA_LOG: no path, no hidden file, no ".." */
+static int log_server_app_ok(const char *app) {
+  size_t len = strlen(app);
+  return len > 0 && len < LOG_SINK_APP_MAX && app[0] != '.' && strchr(app, '/') == NULL &&
+    strstr(app, "..") == NULL;
+}
+
+static void log_server_dispatch(char *buf, ssize_t len, const struct ucred *cred) {
+  char *first, *app, *body;
+  char *end = buf + len;
+  if (len < 2 || cred == NULL || cred->uid != getuid()) {
+    return;
+  }
+  buf[len] = 0;
+  first = buf + 1;
+  app = memchr(first, 0, end - first);
+  if (app == NULL || ++app >= end) {
+    return;
+  }
+  body = memchr(app, 0, end - app);
+  if (body == NULL || ++body > end || !log_server_app_ok(app)) {
+    return;
+  }
+  if (buf[0] == LOG_SERVER_MESSAGE) {
+    simple_log_with_pid((int)cred->pid, app, body);
+  } else if (buf[0] == LOG_SERVER_LINE) {
+    log_write_line(app, atoi(first) != 0, body, end - body);
+  }
+}
+
+static void *log_server_loop(void *arg) {
+  char *buf = malloc(LOG_SERVER_DGRAM_MAX + 1);
+  (void)arg;
+  if (buf == NULL) {
+    return NULL;
+  }
+  for (;;) {
+    union {
+      char buf[CMSG_SPACE(sizeof(struct ucred))];
+      struct cmsghdr align;
+    } control;
+    struct iovec iov = { buf, LOG_SERVER_DGRAM_MAX };
+    struct msghdr msg;
+    struct cmsghdr *cmsg;
+    const struct ucred *cred = NULL;
+    ssize_t len;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control.buf;
+    msg.msg_controllen = sizeof(control.buf);
+    len = recvmsg(server_fd, &msg, 0);
+    if (len < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      break;
+    }
+    for (cmsg = CMSG_FIRSTHDR(&msg); cmsg != NULL; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+      if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_CREDENTIALS) {
+        cred = (const struct ucred *)CMSG_DATA(cmsg);
+      }
+    }
+    log_server_dispatch(buf, len, cred);
+  }
+  free(buf);
+  return NULL;
+}
+
+/**
+ * @brief Listen for log records on LOG_SOCKET.
+ *
+ * This function binds a Unix datagram socket under RUN_DIR and starts a thread that writes
+ * every received record through the daemon's own log sink. ll-log-msg then costs one
+ * datagram instead of a STARTED line, three state lines and the message, each with its own
+ * open/append/close.
+ *
+ * @param thread_name The name of the calling thread, for the log message.
+ *
+ * @return 0 on success or when another daemon owns the socket, 1 if the socket cannot be set
+ * up.
+ *
+ * @note This function requires the following include files:
+ * @note #include <sys/socket.h>, for socket, bind, setsockopt, SO_PASSCRED
+ * @note #include <sys/file.h>, for flock
+ * @note #include <sys/un.h>, for struct sockaddr_un
+ * @note #include <pthread.h>, for pthread_create
+ *
+ * @see log_client_send_message()
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+int log_server_start(const char *thread_name) {
+  struct sockaddr_un addr;
+  int rcvbuf = LOG_SERVER_RCVBUF;
+  int passcred = 1;
+  struct stat st;
+  if (server_fd >= 0) {
+    return 0;
+  }
+  if (make_directory(RUN_DIR) != 0) {
+    LOG_ERROR(LOG_MODULE_LOG, thread_name, "Creating folder: " RUN_DIR " ..Failed..");
+    return 1;
+  }
+  chmod(RUN_DIR, 0755);
+  if (lock_fd < 0) {
+    lock_fd = open(LOG_SOCKET_LOCK, O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+    if (lock_fd >= 0 && flock(lock_fd, LOCK_EX | LOCK_NB) != 0) {
+      close(lock_fd);
+      lock_fd = -1;
+      LOG_INFO(LOG_MODULE_LOG, thread_name, "Log socket: " LOG_SOCKET " is held by another process, not listening");
+      return 0;
+    }
+    if (lock_fd < 0) {
+      LOG_ERROR(LOG_MODULE_LOG, thread_name, "Log socket lock: " LOG_SOCKET_LOCK " ..Failed.. (%s)", strerror(errno));
+      return 1;
+    }
+  }
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  snprintf(addr.sun_path, sizeof(addr.sun_path), "%s", LOG_SOCKET);
+  server_fd = socket(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+  if (server_fd < 0) {
+    LOG_ERROR(LOG_MODULE_LOG, thread_name, "Log socket: " LOG_SOCKET " ..Failed..");
+    return 1;
+  }
+  unlink(LOG_SOCKET);
+  if (bind(server_fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+    LOG_ERROR(LOG_MODULE_LOG, thread_name, "Binding log socket: " LOG_SOCKET " ..Failed..");
+    close(server_fd);
+    server_fd = -1;
+    return 1;
+  }
+  if (stat(LOG_SOCKET, &st) == 0) {
+    server_ino = st.st_ino;
+  }
+  // Applets started by other users cannot connect, and write their files themselves
+  chmod(LOG_SOCKET, 0600);
+  setsockopt(server_fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+  // The kernel attaches the pid and uid of the sender to every datagram
+  setsockopt(server_fd, SOL_SOCKET, SO_PASSCRED, &passcred, sizeof(passcred));
+  if (pthread_create(&server_tid, NULL, log_server_loop, NULL) != 0) {
+    LOG_ERROR(LOG_MODULE_LOG, thread_name, "Log socket thread ..Failed..");
+    close(server_fd);
+    server_fd = -1;
+    unlink(LOG_SOCKET);
+    return 1;
+  }
+  pthread_detach(server_tid);
+  LOG_INFO(LOG_MODULE_LOG, thread_name, "Log socket: " LOG_SOCKET " ..Listening..");
+  return 0;
+}
+
+/**
+ * @brief Remove the log socket so that clients fall back to writing the files themselves.
+ *
+ * @details Only the socket bound by this process is removed, never one bound since by another
+ * daemon.
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+void log_server_stop(void) {
+  struct stat st;
+  if (server_fd >= 0 && stat(LOG_SOCKET, &st) == 0 && st.st_ino == server_ino) {
+    unlink(LOG_SOCKET);
+  }
+}
+
+/**
+ * @brief Tell whether this process is the daemon owning the log socket and READY_FILE.
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+int log_server_owner(void) {
+  return lock_fd >= 0;
+}
+
+/**
+ * @brief Connect the client socket to a running life-line daemon.
+ *
+ * @return 0 if a daemon is listening, -1 otherwise.
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+int log_client_attach(void) {
+  struct sockaddr_un addr;
+  if (client_fd >= 0) {
+    return client_active ? 0 : -1;
+  }
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  snprintf(addr.sun_path, sizeof(addr.sun_path), "%s", LOG_SOCKET);
+  client_fd = socket(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+  if (client_fd < 0) {
+    return -1;
+  }
+  if (connect(client_fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+    return -1;
+  }
+  client_active = 1;
+  return 0;
+}
+
+int log_client_active(void) {
+  return client_active;
+}
+
+static int log_client_send(char type, const char *first, const char *app, const char *body, size_t body_len) {
+  char buf[LOG_SERVER_DGRAM_MAX];
+  size_t first_len = strlen(first) + 1;
+  size_t app_len = strlen(app) + 1;
+  size_t len = 1 + first_len + app_len + body_len;
+  if (len > sizeof(buf) || log_client_attach() != 0) {
+    return -1;
+  }
+  buf[0] = type;
+  memcpy(buf + 1, first, first_len);
+  memcpy(buf + 1 + first_len, app, app_len);
+  memcpy(buf + 1 + first_len + app_len, body, body_len);
+  if (send(client_fd, buf, len, MSG_DONTWAIT) != (ssize_t)len) {
+    // The daemon is gone or its queue is full: write the files directly from now on
+    client_active = 0;
+    return -1;
+  }
+  return 0;
+}
+
+/**
+ * @brief Send an ll-log-msg record to the running daemon.
+ *
+ * @param pid The pid written in the log line.
+ * @param app The application name of the log file.
+ * @param msg The message.
+ *
+ * @return 0 if the daemon has the record, -1 if the caller must write it itself, which is the
+ * case of a pid other than the caller's.
+ *
+ * @note This function requires the following include files:
+ * @note #include <sys/socket.h>, for socket, connect, send
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+int log_client_send_message(int pid, const char *app, const char *msg) {
+  char first[16];
+  if (pid != (int)getpid()) {
+    // The daemon logs the pid of the sender only: another pid is written by the caller
+    return -1;
+  }
+  snprintf(first, sizeof(first), "%d", pid);
+  return log_client_send(LOG_SERVER_MESSAGE, first, app, msg, strlen(msg));
+}
+
+/**
+ * @brief Send a formatted log line of an applet to the running daemon.
+ *
+ * @return 0 if the daemon has the line, -1 if the caller must write it itself.
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+int log_client_send_line(const char *app, int debug_mode, const char *line, int len) {
+  return log_client_send(LOG_SERVER_LINE, debug_mode ? "1" : "0", app, line, len);
+}
@@ -0,0 +1,47 @@
+#ifndef LOG_SERVER_H
+#define LOG_SERVER_H
+
+/**
+ * @file log-server.h
+ * @brief Receive log records from ll-log-msg and the other applets over a Unix datagram socket
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/file.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#define LOG_SERVER_DGRAM_MAX 65000
+#define LOG_SERVER_RCVBUF (4 * 1024 * 1024)
+
+/* First byte of a datagram */
+#define LOG_SERVER_MESSAGE 'M'  /* pid, app, message: formatted by the daemon */
+#define LOG_SERVER_LINE 'L'     /* debug flag, app, formatted line */
+
+/**
+ * @note #include <sys/socket.h>, for socket, bind, recv, sendto
+ * @note #include <sys/un.h>, for struct sockaddr_un
+ * @note #include <sys/file.h>, for flock
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+int log_server_start(const char *thread_name);
+void log_server_stop(void);
+int log_server_owner(void);
+int log_client_send_message(int pid, const char *app, const char *msg);
+int log_client_send_line(const char *app, int debug_mode, const char *line, int len);
+int log_client_attach(void);
+int log_client_active(void);
+
+#endif /* LOG_SERVER_H */
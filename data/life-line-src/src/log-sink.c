@@ -0,0 +1,641 @@
+/* fallocate() and FALLOC_FL_KEEP_SIZE */
+#define _GNU_SOURCE
+#include "project.h"
+#include "io-policy.h"
+#include "log-forward.h"
+#include "log-sink.h"
+#include "log-spill.h"
+#include "log-sync.h"
+#include "make-directory.h"
+
+/**
+ * @file log-sink.c
+ * @brief Keep the daily log files open and append to them with a single write
+ *
+ * A day's log is split into segments of at most LL_LOG_MAX_SIZE bytes, and the space of a
+ * segment is reserved ahead of the appends with fallocate(FALLOC_FL_KEEP_SIZE) in growing
+ * extents, so that ext4 and xfs lay the file out in a few large extents instead of allocating
+ * blocks on every append. The reserved tail is released when the segment is closed.
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+
+static struct log_sink sinks[LOG_SINK_MAX];
+static int sinks_ready = 0;
+static int next_victim = 0;
+static off_t segment_size = LOG_SINK_SEGMENT_SIZE;
+static pthread_mutex_t sinks_lock = PTHREAD_MUTEX_INITIALIZER;
+static unsigned char binary_block[LOG_BINARY_BLOCK_MAX];
+/* The number of the last append, for the group commit of log_sync_commit() */
+static uint64_t write_seq = 0;
+
+/*
+ * LL_LOG_MAX_SIZE is a byte count with an optional K, M or G suffix; 0 keeps one file per day.
+ */
+static void log_sink_init_size(void) {
+  const char *value = getenv("LL_LOG_MAX_SIZE");
+  char *end;
+  long long size;
+  if (value == NULL || *value == 0) {
+    return;
+  }
+  size = strtoll(value, &end, 10);
+  if (*end == 'K' || *end == 'k') {
+    size *= 1024;
+  } else if (*end == 'M' || *end == 'm') {
+    size *= 1024 * 1024;
+  } else if (*end == 'G' || *end == 'g') {
+    size *= 1024 * 1024 * 1024;
+  }
+  if (size >= 0) {
+    segment_size = (off_t)size;
+  }
+}
+
+static void log_sink_init_table(void) {
+  int i;
+  for (i = 0; i < LOG_SINK_MAX; i++) {
+    sinks[i].fd = -1;
+    sinks[i].idx_fd = -1;
+    sinks[i].app[0] = 0;
+  }
+  log_sink_init_size();
+  // Give the preallocated tails back when the process ends
+  atexit(log_sink_close_all);
+  sinks_ready = 1;
+}
+
+/*
+ * Release the space preallocated beyond the end of the file. When another process has
+ * appended to the file meanwhile, the tail is left alone rather than racing its writes.
+ */
+static void log_sink_trim(struct log_sink *sink) {
+  struct stat st;
+  if (sink->allocated > sink->size && fstat(sink->fd, &st) == 0 && st.st_size == sink->size) {
+    if (ftruncate(sink->fd, st.st_size) != 0) {
+      sink->prealloc = 0;
+    }
+  }
+  sink->allocated = sink->size;
+}
+
+static void log_sink_close(struct log_sink *sink) {
+  if (sink->fd >= 0) {
+    log_sink_trim(sink);
+    if (sink->dirty) {
+      // Its lines would escape the next round of log_sink_sync_dirty()
+      fdatasync(sink->fd);
+      log_sync_record(1, -1);
+    }
+    close(sink->fd);
+  }
+  sink->dirty = 0;
+  if (sink->idx_fd >= 0) {
+    close(sink->idx_fd);
+  }
+  sink->fd = -1;
+  sink->idx_fd = -1;
+  sink->date[0] = 0;
+  sink->checked = 0;
+}
+
+static void log_sink_path(struct log_sink *sink, const char *log_dir, const char *date, int segment) {
+  const char *ext = sink->binary ? LOG_BINARY_EXT : ".log";
+  if (segment == 0) {
+    snprintf(sink->path, sizeof(sink->path), "%s/%s-%s%s%s", log_dir, sink->app, date,
+      sink->debug_mode ? "-debug" : "", ext);
+  } else {
+    snprintf(sink->path, sizeof(sink->path), "%s/%s-%s%s-%d%s", log_dir, sink->app, date,
+      sink->debug_mode ? "-debug" : "", segment, ext);
+  }
+}
+
+/**
+ * @brief Open the dated log file of a sink, creating the log directory only when it is missing.
+ *
+ * @param sink The sink whose app and debug_mode select the file.
+ * @param date The local date (YYYY-MM-DD) the file belongs to.
+ * @param segment The segment to open, or -1 for the last existing segment of the day.
+ *
+ * @return 0 on success, -1 if the file cannot be opened.
+ *
+ * @details The file name follows logFilenameWithTimeStamp(): DATA_LOG/app/app-YYYY-MM-DD.log,
+ * or app-YYYY-MM-DD-debug.log for the debug stream, with a -N suffix from the second segment
+ * of the day on, and .llb instead of .log for the binary format. A new binary file starts with
+ * LOG_BINARY_MAGIC.
+ * make_directory() is only called when the first open() fails with ENOENT, so a steady-state
+ * reopen costs a single open().
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+static int log_sink_open(struct log_sink *sink, const char *date, int segment) {
+  char log_dir[sizeof(DATA_LOG) + LOG_SINK_APP_MAX];
+  struct stat st;
+  snprintf(log_dir, sizeof(log_dir), "%s%s", DATA_LOG, sink->app);
+  if (segment < 0) {
+    // Continue after a restart in the segment that was being written
+    segment = 0;
+    while (segment_size > 0 && segment < LOG_SINK_SEGMENTS_MAX) {
+      log_sink_path(sink, log_dir, date, segment + 1);
+      if (stat(sink->path, &st) != 0) {
+        break;
+      }
+      segment++;
+    }
+  }
+  log_sink_path(sink, log_dir, date, segment);
+  sink->fd = open(sink->path, O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0644);
+  if (sink->fd < 0 && errno == ENOENT) {
+    make_directory(log_dir);
+    sink->fd = open(sink->path, O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0644);
+  }
+  if (sink->fd < 0) {
+    return -1;
+  }
+  memcpy(sink->date, date, sizeof(sink->date));
+  sink->segment = segment;
+  sink->size = fstat(sink->fd, &st) == 0 ? st.st_size : 0;
+  sink->allocated = sink->size;
+  sink->prealloc = LOG_SINK_PREALLOC_MIN;
+  sink->idx_minute = 0;
+  if (sink->binary && sink->size == 0) {
+    if (write(sink->fd, LOG_BINARY_MAGIC, sizeof(LOG_BINARY_MAGIC) - 1) != sizeof(LOG_BINARY_MAGIC) - 1) {
+      int err = errno;
+      close(sink->fd);
+      sink->fd = -1;
+      errno = err;
+      return -1;
+    }
+    sink->size = sizeof(LOG_BINARY_MAGIC) - 1;
+  }
+  return 0;
+}
+
+/*
+ * Make sure the next total bytes land in preallocated space. The extent never reaches beyond
+ * the end of the segment, and preallocation stops for good on file systems without support.
+ */
+static void log_sink_reserve(struct log_sink *sink, size_t total) {
+#ifdef FALLOC_FL_KEEP_SIZE
+  off_t len = sink->prealloc;
+  if (len == 0 || sink->size + (off_t)total <= sink->allocated) {
+    return;
+  }
+  if (segment_size > 0 && sink->size + len > segment_size) {
+    len = segment_size - sink->size;
+  }
+  if (len < (off_t)total) {
+    len = total;
+  }
+  if (fallocate(sink->fd, FALLOC_FL_KEEP_SIZE, sink->size, len) != 0) {
+    sink->prealloc = 0;
+    return;
+  }
+  sink->allocated = sink->size + len;
+  if (sink->prealloc < LOG_SINK_PREALLOC_MAX) {
+    sink->prealloc *= 2;
+  }
+#else
+  (void)sink;
+  (void)total;
+#endif
+}
+
+static struct log_sink *log_sink_lookup(const char *app, int debug_mode, int binary) {
+  int i;
+  struct log_sink *sink;
+  if (!sinks_ready) {
+    log_sink_init_table();
+  }
+  for (i = 0; i < LOG_SINK_MAX; i++) {
+    if (sinks[i].app[0] && sinks[i].debug_mode == debug_mode && sinks[i].binary == binary &&
+        strcmp(sinks[i].app, app) == 0) {
+      return &sinks[i];
+    }
+  }
+  for (i = 0; i < LOG_SINK_MAX; i++) {
+    if (!sinks[i].app[0]) {
+      break;
+    }
+  }
+  if (i == LOG_SINK_MAX) {
+    // Table is full, recycle the slots in turn
+    i = next_victim;
+    next_victim = (next_victim + 1) % LOG_SINK_MAX;
+  }
+  sink = &sinks[i];
+  log_sink_close(sink);
+  snprintf(sink->app, sizeof(sink->app), "%s", app);
+  sink->debug_mode = debug_mode;
+  sink->binary = binary;
+  return sink;
+}
+
+/*
+ * Record in the sidecar index where the lines of a new minute start, so that ll-log-query can
+ * seek to a time instead of reading the file from the top. One small write per minute.
+ */
+static void log_sink_index(struct log_sink *sink, time_t now) {
+  struct log_sink_index entry;
+  time_t minute = now - now % 60;
+  if (minute == sink->idx_minute) {
+    return;
+  }
+  sink->idx_minute = minute;
+  if (sink->idx_fd < 0) {
+    char path[PATH_MAX + sizeof(LOG_SINK_INDEX_EXT)];
+    snprintf(path, sizeof(path), "%s" LOG_SINK_INDEX_EXT, sink->path);
+    sink->idx_fd = open(path, O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0644);
+    if (sink->idx_fd < 0) {
+      return;
+    }
+  }
+  entry.minute = minute;
+  entry.offset = sink->size;
+  if (write(sink->idx_fd, &entry, sizeof(entry)) != sizeof(entry)) {
+    close(sink->idx_fd);
+    sink->idx_fd = -1;
+  }
+}
+
+/*
+ * A short write means the volume is full: cut the partial line, so that it can be written
+ * again whole, and report ENOSPC. As in log_sink_trim(), the file is only cut when it ends
+ * with this write: behind the lines another process appended meanwhile, the partial line stays.
+ */
+static int log_sink_short_write(struct log_sink *sink, ssize_t written, size_t total) {
+  struct stat st;
+  if (written == (ssize_t)total) {
+    return 0;
+  }
+  if (written > 0) {
+    if (fstat(sink->fd, &st) == 0) {
+      if (st.st_size == sink->size + written) {
+        if (ftruncate(sink->fd, sink->size) != 0) {
+          sink->prealloc = 0;
+        }
+      } else {
+        sink->size = st.st_size;
+      }
+    }
+    errno = ENOSPC;
+  }
+  return -1;
+}
+
+static int log_sink_write_all(struct log_sink *sink, const void *buf, size_t len) {
+  return log_sink_short_write(sink, write(sink->fd, buf, len), len);
+}
+
+/*
+ * Encode pending binary records into blocks and append them to the sink.
+ */
+static int log_sink_write_blocks(struct log_sink *sink, const struct iovec *iov, int iovcnt) {
+  int done = 0;
+  while (done < iovcnt) {
+    int used;
+    size_t len = log_binary_block(iov + done, iovcnt - done, binary_block, sizeof(binary_block), &used);
+    if (used == 0) {
+      // A malformed record: skip it
+      done++;
+      continue;
+    }
+    log_sink_reserve(sink, len);
+    if (log_sink_write_all(sink, binary_block, len) != 0) {
+      return -1;
+    }
+    sink->size += len;
+    done += used;
+  }
+  return 0;
+}
+
+/*
+ * After a successful append: sync it at once in the per-record mode, or leave the sink to the
+ * next round of log_sink_sync_dirty() and number the append. Without syncs, the writeback of
+ * the file is started once a minute so that its pages can leave the cache.
+ */
+static uint64_t log_sink_written(struct log_sink *sink, size_t total, time_t now) {
+  enum log_sync_mode mode = log_sync_mode();
+  io_policy_written(IO_PATH_SINK, total);
+  if (mode == LOG_SYNC_RECORD) {
+    double start = log_sync_now();
+    fdatasync(sink->fd);
+    log_sync_record(1, log_sync_now() - start);
+    io_policy_synced(IO_PATH_SINK, sink->fd);
+    return 0;
+  }
+  if (mode == LOG_SYNC_NONE) {
+    if (now - sink->written_back >= 60) {
+      io_policy_writeback(IO_PATH_SINK, sink->fd);
+      sink->written_back = now;
+    }
+    return 0;
+  }
+  if (!sink->dirty) {
+    sink->dirty = 1;
+    sink->dirty_since = log_sync_now();
+  }
+  return ++write_seq;
+}
+
+static int log_sink_append(const char *app, int debug_mode, int binary, const struct iovec *iov, int iovcnt, size_t total,
+    uint64_t *seq) {
+  struct log_sink *sink;
+  struct stat st;
+  struct tm tm;
+  char date[11];
+  time_t now;
+  int rc = 0;
+  pthread_mutex_lock(&sinks_lock);
+  sink = log_sink_lookup(app, debug_mode, binary);
+  now = time(NULL);
+  if (sink->fd < 0 || now != sink->checked) {
+    localtime_r(&now, &tm);
+    strftime(date, sizeof(date), "%Y-%m-%d", &tm);
+    if (sink->fd >= 0 && (strcmp(date, sink->date) != 0 || fstat(sink->fd, &st) != 0 || st.st_nlink == 0)) {
+      log_sink_close(sink);
+    } else if (sink->fd >= 0 && st.st_size != sink->size) {
+      // Another process appended to the file
+      sink->size = st.st_size;
+    }
+    if (sink->fd < 0 && log_sink_open(sink, date, -1) != 0) {
+      pthread_mutex_unlock(&sinks_lock);
+      return -1;
+    }
+    sink->checked = now;
+  }
+  if (segment_size > 0 && sink->size > 0 && sink->size + (off_t)total > segment_size &&
+      sink->segment < LOG_SINK_SEGMENTS_MAX) {
+    int segment = sink->segment + 1;
+    memcpy(date, sink->date, sizeof(date));
+    log_sink_close(sink);
+    if (log_sink_open(sink, date, segment) != 0) {
+      pthread_mutex_unlock(&sinks_lock);
+      return -1;
+    }
+  }
+  if (binary) {
+    off_t before = sink->size;
+    if (log_sink_write_blocks(sink, iov, iovcnt) != 0) {
+      int err = errno;
+      log_sink_close(sink);
+      errno = err;
+      rc = -1;
+    } else {
+      *seq = log_sink_written(sink, sink->size - before, now);
+    }
+  } else {
+    log_sink_index(sink, now);
+    log_sink_reserve(sink, total);
+    if (log_sink_short_write(sink, writev(sink->fd, iov, iovcnt), total) != 0) {
+      int err = errno;
+      log_sink_close(sink);
+      errno = err;
+      rc = -1;
+    } else {
+      sink->size += total;
+      *seq = log_sink_written(sink, total, now);
+      if (log_forward_active()) {
+        // The forwarder reads the lines back from the file
+        log_forward_written(app, debug_mode, sink->path, sink->size - total, sink->size);
+      }
+    }
+  }
+  pthread_mutex_unlock(&sinks_lock);
+  return rc;
+}
+
+/* Write a line queued by log_spill_push() back; see log_spill_writer */
+static int log_sink_replay(const char *app, int debug_mode, const char *line, size_t len) {
+  struct iovec iov;
+  uint64_t seq = 0;
+  int rc;
+  iov.iov_base = (void *)line;
+  iov.iov_len = len;
+  rc = log_sink_append(app, debug_mode, len > 0 && (unsigned char)line[0] == LOG_BINARY_PENDING, &iov, 1, len, &seq);
+  log_sync_commit(seq);
+  return rc;
+}
+
+/* A process exiting during an outage tries once more to write the lines it holds */
+static void log_sink_spill_at_exit(void) {
+  log_sink_flush_spill(1);
+}
+
+static void log_sink_spill(const char *app, int debug_mode, const struct iovec *iov, int iovcnt) {
+  static int at_exit = 0;
+  if (!__atomic_exchange_n(&at_exit, 1, __ATOMIC_RELAXED)) {
+    atexit(log_sink_spill_at_exit);
+  }
+  log_spill_push(app, debug_mode, iov, iovcnt);
+}
+
+/**
+ * @brief Append formatted log lines to the daily log file of an app.
+ *
+ * This function keeps one O_APPEND descriptor per (app, debug_mode) stream and writes the
+ * lines with a single writev() call.
+ *
+ * @param app The application name, used for the folder and the file name.
+ * @param debug_mode Selects the APP-YYYY-MM-DD-debug.log stream when set.
+ * @param iov The complete log lines, each including its trailing newline.
+ * @param iovcnt The number of lines.
+ * @param total The total length of the lines.
+ *
+ * @return 0 if the lines have been written, -1 otherwise.
+ *
+ * @details At most once per second the sink checks whether the local date has changed or the
+ * file has been removed (st_nlink dropped to 0, e.g. by ll-remove-old-log), and reopens the
+ * file in either case. Between those checks an append is one writev() with no path building,
+ * no mkdir() and no open()/close(). When the lines would take the file beyond LL_LOG_MAX_SIZE
+ * (LOG_SINK_SEGMENT_SIZE by default), the file is trimmed and the next segment is opened.
+ *
+ * The first line of every minute also appends an entry to the sidecar index (see
+ * struct log_sink_index).
+ *
+ * Pending binary records (see LOG_BINARY_PENDING) go to the APP-YYYY-MM-DD.llb stream
+ * instead, encoded into one CRC checked block per run of records.
+ *
+ * Depending on LL_LOG_SYNC, the lines are synced before returning (record), after waiting for
+ * the group commit (group), or later by the syncer thread (periodic); see log-sync.h.
+ *
+ * When the volume is full or read-only, the lines are queued in memory and written back in
+ * order once it is writable again; see log-spill.h.
+ *
+ * With LL_LOG_FORWARD, the lines are also streamed to a collector. With LL_LOG_FORWARD_ONLY=1
+ * only the lines the collector cannot take at once are written; see log-forward.h.
+ *
+ * @note This function requires the following include files:
+ * @note #include <fcntl.h>, for open, O_APPEND, fallocate
+ * @note #include <pthread.h>, for pthread_mutex_lock
+ * @note #include <sys/stat.h>, for fstat
+ * @note #include <sys/uio.h>, for writev
+ *
+ * @see logMessage()
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+int log_sink_writev(const char *app, int debug_mode, const struct iovec *iov, int iovcnt, size_t total) {
+  uint64_t seq = 0;
+  int rc = 0;
+  int i = 0;
+  (void)total;
+  if (strlen(app) >= LOG_SINK_APP_MAX) {
+    return -1;
+  }
+  if (log_forward_active()) {
+    int queued = log_forward_push(app, debug_mode, iov, iovcnt);
+    if (log_forward_only()) {
+      if (queued == iovcnt) {
+        return 0;
+      }
+      // The collector cannot take the rest now: it is read back from the files later
+      iov += queued;
+      iovcnt -= queued;
+    }
+  }
+  if (log_spill_pending() && log_spill_replay(log_sink_replay, 0) != 0) {
+    // The volume is still unwritable: wait behind the queued lines
+    log_sink_spill(app, debug_mode, iov, iovcnt);
+    return 0;
+  }
+  while (i < iovcnt) {
+    int binary = iov[i].iov_len > 0 && ((const unsigned char *)iov[i].iov_base)[0] == LOG_BINARY_PENDING;
+    size_t run = 0;
+    int j = i;
+    while (j < iovcnt && (iov[j].iov_len > 0 && ((const unsigned char *)iov[j].iov_base)[0] == LOG_BINARY_PENDING) == binary) {
+      run += iov[j++].iov_len;
+    }
+    if (log_sink_append(app, debug_mode, binary, iov + i, j - i, run, &seq) != 0) {
+      if (log_spill_unwritable(errno)) {
+        log_sink_spill(app, debug_mode, iov + i, iovcnt - i);
+        break;
+      }
+      rc = -1;
+    }
+    i = j;
+  }
+  log_sync_commit(seq);
+  return rc;
+}
+
+/**
+ * @brief Append one formatted log line to the daily log file of an app.
+ *
+ * @see log_sink_writev()
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+int log_sink_write(const char *app, int debug_mode, const char *line, size_t len) {
+  struct iovec iov;
+  iov.iov_base = (void *)line;
+  iov.iov_len = len;
+  return log_sink_writev(app, debug_mode, &iov, 1, len);
+}
+
+/**
+ * @brief Write back the lines queued while the log volume was unwritable.
+ *
+ * @param force Probe the volume now instead of after the delay, e.g. on exit.
+ *
+ * @return 0 when no line is waiting any more, -1 otherwise.
+ *
+ * @see log_spill_replay()
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+int log_sink_flush_spill(int force) {
+  if (!log_spill_pending()) {
+    return 0;
+  }
+  return log_spill_replay(log_sink_replay, force);
+}
+
+/**
+ * @brief The size beyond which a day's log continues in the next segment.
+ *
+ * @return LL_LOG_MAX_SIZE, LOG_SINK_SEGMENT_SIZE by default, or 0 for one file per day.
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+off_t log_sink_segment_size(void) {
+  pthread_mutex_lock(&sinks_lock);
+  if (!sinks_ready) {
+    log_sink_init_table();
+  }
+  pthread_mutex_unlock(&sinks_lock);
+  return segment_size;
+}
+
+/**
+ * @brief Close every cached log descriptor.
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+void log_sink_close_all(void) {
+  int i;
+  pthread_mutex_lock(&sinks_lock);
+  if (sinks_ready) {
+    for (i = 0; i < LOG_SINK_MAX; i++) {
+      log_sink_close(&sinks[i]);
+      sinks[i].app[0] = 0;
+    }
+  }
+  pthread_mutex_unlock(&sinks_lock);
+}
+
+/**
+ * @brief Sync every log file written since the previous call.
+ *
+ * @param covered Receives the number of the last append made durable by this call.
+ * @param oldest Receives the time (log_sync_now()) of the oldest unsynced append, or 0 if no
+ * file was written.
+ *
+ * @return The number of files synced.
+ *
+ * @details The descriptors are duplicated under the lock and synced outside of it, so the
+ * writers are not held up by the disk.
+ *
+ * @see log_sync_commit()
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+int log_sink_sync_dirty(uint64_t *covered, double *oldest) {
+  int fds[LOG_SINK_MAX];
+  int count = 0;
+  int i;
+  *oldest = 0;
+  pthread_mutex_lock(&sinks_lock);
+  *covered = write_seq;
+  if (sinks_ready) {
+    for (i = 0; i < LOG_SINK_MAX; i++) {
+      struct log_sink *sink = &sinks[i];
+      if (sink->fd >= 0 && sink->dirty) {
+        int fd = fcntl(sink->fd, F_DUPFD_CLOEXEC, 0);
+        if (fd >= 0) {
+          fds[count++] = fd;
+        }
+        if (*oldest == 0 || sink->dirty_since < *oldest) {
+          *oldest = sink->dirty_since;
+        }
+        sink->dirty = 0;
+      }
+    }
+  }
+  pthread_mutex_unlock(&sinks_lock);
+  for (i = 0; i < count; i++) {
+    fdatasync(fds[i]);
+    io_policy_synced(IO_PATH_SINK, fds[i]);
+    close(fds[i]);
+  }
+  return count;
+}
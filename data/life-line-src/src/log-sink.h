@@ -0,0 +1,83 @@
+#ifndef LOG_SINK_H
+#define LOG_SINK_H
+
+/**
+ * @file log-sink.h
+ * @brief Keep the daily log files open and append to them with a single write
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+#include <time.h>
+#include <unistd.h>
+#include "log-binary.h"
+
+#define LOG_SINK_MAX 16
+#define LOG_SINK_APP_MAX 64
+
+/* A day's log continues in APP-YYYY-MM-DD-1.log, -2.log, ... beyond this size (LL_LOG_MAX_SIZE) */
+#define LOG_SINK_SEGMENT_SIZE (64 * 1024 * 1024)
+#define LOG_SINK_SEGMENTS_MAX 999
+/* Preallocated extents start small for quiet apps and double up to the maximum */
+#define LOG_SINK_PREALLOC_MIN (64 * 1024)
+#define LOG_SINK_PREALLOC_MAX (8 * 1024 * 1024)
+
+/*
+ * Sidecar sparse index of a text log file (APP-YYYY-MM-DD.log.idx): one entry, in host byte
+ * order, for the first line written in each minute.
+ */
+#define LOG_SINK_INDEX_EXT ".idx"
+
+struct log_sink_index {
+  int64_t minute;  /* epoch seconds of the start of the minute */
+  int64_t offset;  /* the file size when the first line of that minute was written */
+};
+
+struct log_sink {
+  char app[LOG_SINK_APP_MAX];
+  int debug_mode;
+  int fd;
+  time_t checked;
+  char date[11];
+  int segment;      /* 0 for APP-YYYY-MM-DD.log, N for APP-YYYY-MM-DD-N.log */
+  off_t size;       /* bytes in the file */
+  off_t allocated;  /* end of the preallocated space */
+  off_t prealloc;   /* next extent to preallocate, 0 if the file system cannot */
+  int binary;       /* APP-YYYY-MM-DD.llb, see log-binary.h */
+  int idx_fd;       /* the .idx file, opened with the first line */
+  time_t idx_minute;
+  int dirty;        /* written since the last sync, see log-sync.h */
+  double dirty_since;
+  time_t written_back;  /* see io_policy_writeback() */
+  char path[PATH_MAX];
+};
+
+/**
+ * @note #include <fcntl.h>, for open, O_APPEND, fallocate
+ * @note #include <pthread.h>, for pthread_mutex_lock
+ * @note #include <sys/stat.h>, for fstat
+ * @note #include <sys/uio.h>, for writev
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+int log_sink_write(const char *app, int debug_mode, const char *line, size_t len);
+int log_sink_writev(const char *app, int debug_mode, const struct iovec *iov, int iovcnt, size_t total);
+void log_sink_close_all(void);
+int log_sink_sync_dirty(uint64_t *covered, double *oldest);
+int log_sink_flush_spill(int force);
+off_t log_sink_segment_size(void);
+
+#endif /* LOG_SINK_H */
@@ -0,0 +1,208 @@
+#include "log-spill.h"
+#include "log-binary.h"
+#include "log-message.h"
+#include "log-sync.h"
+#include "project.h"
+
+/**
+ * @file log-spill.c
+ * @brief Hold the log lines in memory while the log volume is full or read-only
+ *
+ * When an append fails with ENOSPC, EDQUOT or EROFS, the line and every line after it go to a
+ * bounded queue instead of the disk, so that the order of a stream is kept. The writers do not
+ * retry: the first write after the probe delay replays the queue, oldest first, and the delay
+ * doubles each time the volume is still unwritable. Once the queue is empty, a note with the
+ * duration of the outage and the lines replayed and dropped is appended to the life-line log.
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+
+struct log_spill_record {
+  struct log_spill_record *next;
+  int debug_mode;
+  unsigned long lines;  /* a record of ll-log-pipe holds a run of text lines */
+  size_t len;
+  char *line;
+  char target[];
+};
+
+int log_spill_count = 0;
+static struct log_spill_record *spill_head = NULL;
+static struct log_spill_record *spill_tail = NULL;
+static size_t spill_bytes = 0;
+static pthread_mutex_t spill_lock = PTHREAD_MUTEX_INITIALIZER;
+static int probe_delay = 0;
+static double next_probe = 0;
+static double outage_since = 0;
+
+/* Of the current outage */
+static unsigned long outage_replayed = 0;
+static unsigned long outage_dropped = 0;
+
+/* The lines of a record, one for a binary record */
+static unsigned long spill_lines(const char *line, size_t len) {
+  unsigned long lines = 0;
+  const char *end = line + len;
+  if ((unsigned char)line[0] == LOG_BINARY_PENDING) {
+    return 1;
+  }
+  while ((line = memchr(line, '\n', end - line)) != NULL) {
+    lines++;
+    line++;
+  }
+  return lines > 0 ? lines : 1;
+}
+
+static void spill_drop_oldest(void) {
+  struct log_spill_record *rec = spill_head;
+  spill_head = rec->next;
+  if (spill_head == NULL) {
+    spill_tail = NULL;
+  }
+  spill_bytes -= rec->len;
+  __atomic_store_n(&log_spill_count, log_spill_count - 1, __ATOMIC_RELEASE);
+  free(rec);
+}
+
+/* Append a line to a log file given by its path, as logMessageWithLogName() would */
+static int spill_write_file(const char *path, const char *line, size_t len) {
+  int fd = open(path, O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0644);
+  ssize_t written;
+  int err;
+  if (fd < 0) {
+    return -1;
+  }
+  written = write(fd, line, len);
+  err = errno;
+  close(fd);
+  if (written != (ssize_t)len) {
+    errno = written < 0 ? err : ENOSPC;
+    return -1;
+  }
+  return 0;
+}
+
+/**
+ * @brief Tell whether a write failed because the volume is full or read-only.
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+int log_spill_unwritable(int err) {
+  return err == ENOSPC || err == EDQUOT || err == EROFS;
+}
+
+/**
+ * @brief Queue lines that cannot be written, or that must wait behind queued ones.
+ *
+ * @param target The app of the sink stream, or the path of the log file.
+ * @param debug_mode Selects the debug log stream of the app.
+ * @param iov The complete lines, each including its trailing newline; ll-log-pipe passes a run
+ * of lines as one.
+ * @param iovcnt The number of entries of iov.
+ *
+ * @details The first line queued starts an outage and the probe delay. When a bound is
+ * reached the oldest lines are dropped; a line that cannot be copied is dropped itself. The
+ * outage note counts the lines replayed and dropped one by one, whatever the entries.
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+void log_spill_push(const char *target, int debug_mode, const struct iovec *iov, int iovcnt) {
+  size_t target_len = strlen(target);
+  int i;
+  pthread_mutex_lock(&spill_lock);
+  if (spill_head == NULL && outage_since == 0) {
+    outage_since = log_sync_now();
+    probe_delay = LOG_SPILL_PROBE_MIN_MS;
+    next_probe = outage_since + probe_delay / 1000.0;
+    outage_replayed = outage_dropped = 0;
+  }
+  for (i = 0; i < iovcnt; i++) {
+    struct log_spill_record *rec;
+    size_t len = iov[i].iov_len;
+    if (len == 0) {
+      continue;
+    }
+    while (spill_head != NULL && (log_spill_count >= LOG_SPILL_RECORDS || spill_bytes + len > LOG_SPILL_BYTES)) {
+      outage_dropped += spill_head->lines;
+      spill_drop_oldest();
+    }
+    rec = len <= LOG_SPILL_BYTES ? malloc(sizeof(*rec) + target_len + 1 + len) : NULL;
+    if (rec == NULL) {
+      outage_dropped += spill_lines(iov[i].iov_base, len);
+      continue;
+    }
+    rec->next = NULL;
+    rec->debug_mode = debug_mode;
+    rec->lines = spill_lines(iov[i].iov_base, len);
+    rec->len = len;
+    memcpy(rec->target, target, target_len + 1);
+    rec->line = rec->target + target_len + 1;
+    memcpy(rec->line, iov[i].iov_base, len);
+    if (spill_tail != NULL) {
+      spill_tail->next = rec;
+    } else {
+      spill_head = rec;
+    }
+    spill_tail = rec;
+    spill_bytes += len;
+    __atomic_store_n(&log_spill_count, log_spill_count + 1, __ATOMIC_RELEASE);
+  }
+  pthread_mutex_unlock(&spill_lock);
+}
+
+/**
+ * @brief Write the queued lines back once the probe delay has passed.
+ *
+ * @param writer Writes a line to a sink stream; lines of a file path are appended here.
+ * @param force Probe now, e.g. on exit, whatever the delay.
+ *
+ * @return 0 when the queue is empty, -1 when lines are still waiting (the caller queues its
+ * own lines behind them).
+ *
+ * @details A line that fails for another reason than an unwritable volume is dropped, as it
+ * would have been without the queue.
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+int log_spill_replay(log_spill_writer writer, int force) {
+  double now = log_sync_now();
+  int rc = 0;
+  pthread_mutex_lock(&spill_lock);
+  if (spill_head != NULL && !force && now < next_probe) {
+    pthread_mutex_unlock(&spill_lock);
+    return -1;
+  }
+  while (spill_head != NULL) {
+    struct log_spill_record *rec = spill_head;
+    int failed = rec->target[0] == '/' ? spill_write_file(rec->target, rec->line, rec->len) :
+      writer(rec->target, rec->debug_mode, rec->line, rec->len);
+    if (failed && log_spill_unwritable(errno)) {
+      probe_delay = probe_delay * 2 < LOG_SPILL_PROBE_MAX_MS ? probe_delay * 2 : LOG_SPILL_PROBE_MAX_MS;
+      next_probe = now + probe_delay / 1000.0;
+      rc = -1;
+      break;
+    }
+    if (failed) {
+      outage_dropped += rec->lines;
+    } else {
+      outage_replayed += rec->lines;
+    }
+    spill_drop_oldest();
+  }
+  if (spill_head == NULL && outage_since > 0) {
+    char note[LOG_LINE_MAX];
+    int len = snprintf(note, sizeof(note), "%s %s #%d ] Log spill: the log volume was unwritable for %.1f s, "
+      "%lu lines replayed, %lu dropped\n", logTimestamp(time(NULL)), APP_NAME, logPid(), now - outage_since,
+      outage_replayed, outage_dropped);
+    if (len > 0 && len < (int)sizeof(note)) {
+      writer(APP, 0, note, len);
+    }
+    outage_since = 0;
+  }
+  pthread_mutex_unlock(&spill_lock);
+  return rc;
+}
@@ -0,0 +1,60 @@
+#ifndef LOG_SPILL_H
+#define LOG_SPILL_H
+
+/**
+ * @file log-spill.h
+ * @brief Hold the log lines in memory while the log volume is full or read-only
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/uio.h>
+#include <time.h>
+#include <unistd.h>
+
+/* The queue keeps the newest lines within both bounds; older ones are dropped and counted */
+#define LOG_SPILL_RECORDS 4096
+#define LOG_SPILL_BYTES (1024 * 1024)
+/* The volume is probed again after this delay, doubled after every failed probe */
+#define LOG_SPILL_PROBE_MIN_MS 100
+#define LOG_SPILL_PROBE_MAX_MS 30000
+
+/*
+ * Writes a queued line back: target is the app of a log sink stream, or the path of a log
+ * file when it starts with '/'. Returns 0 on success, or -1 with errno set.
+ */
+typedef int (*log_spill_writer)(const char *target, int debug_mode, const char *line, size_t len);
+
+extern int log_spill_count;
+
+/**
+ * @brief Tell whether lines are waiting for the volume; a single load, checked on every write.
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+static inline int log_spill_pending(void) {
+  return __atomic_load_n(&log_spill_count, __ATOMIC_ACQUIRE) > 0;
+}
+
+/**
+ * @note #include <errno.h>, for ENOSPC, EROFS, EDQUOT
+ * @note #include <fcntl.h>, for open, O_APPEND
+ * @note #include <pthread.h>, for pthread_mutex_lock
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+int log_spill_unwritable(int err);
+void log_spill_push(const char *target, int debug_mode, const struct iovec *iov, int iovcnt);
+int log_spill_replay(log_spill_writer writer, int force);
+
+#endif /* LOG_SPILL_H */
@@ -0,0 +1,586 @@
+#define _GNU_SOURCE
+#include "log-stats.h"
+#include "project.h"
+
+/**
+ * @file log-stats.c
+ * @brief Count the log lines under DATA_LOG per app, thread, state, minute and message
+ *
+ * The text log files are mapped into memory and cut into chunks that the scanning threads take
+ * in turn. A thread finds the line ends 64 bytes at a time with SIMD compares, splits each line
+ * into the fields written by logMessageWithPid():
+ *
+ *     YYYY-MM-DD HH:MM:SS app[@version] #pid ]   «thread» message
+ *
+ * and counts it in its own tables, which are merged once every chunk is done. The table
+ * entries point into the mapped files rather than copying the names.
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+
+struct stats_entry {
+  uint64_t hash;      /* 0 for a free slot */
+  const char *a;      /* the name, or the app of a thread or message */
+  const char *b;      /* the thread or message, if any */
+  uint32_t a_len;
+  uint32_t b_len;
+  uint64_t count;
+  uint64_t bytes;
+};
+
+struct stats_table {
+  struct stats_entry *slot;
+  size_t size;
+  size_t used;
+  uint64_t dropped;   /* lines not counted as the table was full */
+};
+
+struct stats_worker {
+  pthread_t tid;
+  struct stats_table apps;
+  struct stats_table threads;
+  struct stats_table states;
+  struct stats_table minutes;
+  struct stats_table messages;
+  uint64_t lines;
+  uint64_t other;     /* continuation lines and lines without the usual prefix */
+};
+
+struct stats_file {
+  const char *base;
+  size_t size;
+};
+
+struct stats_chunk {
+  int file;
+  size_t start;
+  size_t end;
+};
+
+static struct stats_file files[LOG_STATS_FILES_MAX];
+static int file_count = 0;
+static struct stats_chunk *chunks = NULL;
+static size_t chunk_count = 0;
+static size_t chunk_next = 0;
+
+static uint64_t stats_hash(uint64_t hash, const char *s, size_t len) {
+  size_t i;
+  for (i = 0; i < len; i++) {
+    hash ^= (unsigned char)s[i];
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+/* Runs of digits hash as one '#', so that "sent 12 bytes" and "sent 345 bytes" count together */
+static uint64_t stats_hash_message(uint64_t hash, const char *s, size_t len) {
+  size_t i;
+  int digits = 0;
+  for (i = 0; i < len; i++) {
+    unsigned char c = (unsigned char)s[i];
+    if (c >= '0' && c <= '9') {
+      if (digits) {
+        continue;
+      }
+      digits = 1;
+      c = '#';
+    } else {
+      digits = 0;
+    }
+    hash ^= c;
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+static int stats_table_init(struct stats_table *t, size_t size) {
+  t->slot = calloc(size, sizeof(struct stats_entry));
+  t->size = size;
+  t->used = 0;
+  t->dropped = 0;
+  return t->slot == NULL ? -1 : 0;
+}
+
+/*
+ * Add to the entry of a key. Keys are told apart by their 64-bit hash alone; the names of the
+ * first line seen are kept for the report.
+ */
+static void stats_add(struct stats_table *t, uint64_t hash, const char *a, size_t a_len, const char *b, size_t b_len,
+    uint64_t count, uint64_t bytes) {
+  size_t mask = t->size - 1;
+  size_t i;
+  if (hash == 0) {
+    hash = 1;
+  }
+  for (i = hash & mask; t->slot[i].hash != 0; i = (i + 1) & mask) {
+    if (t->slot[i].hash == hash) {
+      t->slot[i].count += count;
+      t->slot[i].bytes += bytes;
+      return;
+    }
+  }
+  if (t->used >= t->size / 4 * 3) {
+    t->dropped += count;
+    return;
+  }
+  t->used++;
+  t->slot[i].hash = hash;
+  t->slot[i].a = a;
+  t->slot[i].a_len = a_len;
+  t->slot[i].b = b;
+  t->slot[i].b_len = b_len;
+  t->slot[i].count = count;
+  t->slot[i].bytes = bytes;
+}
+
+static void stats_merge(struct stats_table *into, const struct stats_table *from) {
+  size_t i;
+  for (i = 0; i < from->size; i++) {
+    const struct stats_entry *e = &from->slot[i];
+    if (e->hash != 0) {
+      stats_add(into, e->hash, e->a, e->a_len, e->b, e->b_len, e->count, e->bytes);
+    }
+  }
+  into->dropped += from->dropped;
+}
+
+/* The state named by a "====== State: .*RUNNING* -> *END*...... ======" line */
+static void stats_state(struct stats_worker *w, const char *msg, const char *end) {
+  const char *s = memmem(msg, end - msg, "State: ", 7);
+  const char *e;
+  if (s == NULL) {
+    return;
+  }
+  s += 7;
+  for (e = s; e < end && !(*e == ' ' && e + 2 < end && (e[1] == '=' || e[1] == '-') && e[2] == e[1]); e++) {
+  }
+  while (e > s && e[-1] == '.') {
+    e--;
+  }
+  stats_add(&w->states, stats_hash(14695981039346656037ULL, s, e - s), s, e - s, NULL, 0, 1, 0);
+}
+
+static void stats_line(struct stats_worker *w, const char *s, size_t len) {
+  const char *end = s + len;
+  const char *app, *p, *msg;
+  const char *thread = NULL;
+  size_t app_len, thread_len = 0;
+  uint64_t app_hash;
+  w->lines++;
+  if (len < 21 || s[4] != '-' || s[7] != '-' || s[10] != ' ' || s[13] != ':' || s[19] != ' ') {
+    w->other++;
+    return;
+  }
+  app = s + 20;
+  p = memchr(app, ' ', end - app);
+  msg = p == NULL ? NULL : memchr(p, ']', end - p);
+  if (msg == NULL) {
+    w->other++;
+    return;
+  }
+  app_len = p - app;
+  p = memchr(app, '@', app_len);
+  if (p != NULL) {
+    app_len = p - app;
+  }
+  for (msg++; msg < end && *msg == ' '; msg++) {
+  }
+  // "«" and "»" are 0xC2 0xAB and 0xC2 0xBB in UTF-8
+  if (end - msg > 4 && (unsigned char)msg[0] == 0xC2 && (unsigned char)msg[1] == 0xAB) {
+    thread = msg + 2;
+    p = memmem(thread, end - thread, "\xC2\xBB", 2);
+    if (p != NULL) {
+      thread_len = p - thread;
+      for (msg = p + 2; msg < end && *msg == ' '; msg++) {
+      }
+    } else {
+      thread = NULL;
+    }
+  }
+  app_hash = stats_hash(14695981039346656037ULL, app, app_len);
+  stats_add(&w->apps, app_hash, app, app_len, NULL, 0, 1, len + 1);
+  stats_add(&w->minutes, stats_hash(14695981039346656037ULL, s, 16), s, 16, NULL, 0, 1, 0);
+  if (thread != NULL) {
+    stats_add(&w->threads, stats_hash(app_hash, thread, thread_len), app, app_len, thread, thread_len, 1, 0);
+  }
+  stats_add(&w->messages, stats_hash_message(app_hash, msg, end - msg), app, app_len, msg, end - msg, 1, 0);
+  // State lines start with "======" or "------"
+  if (end - msg > 7 && (*msg == '=' || *msg == '-')) {
+    stats_state(w, msg, end);
+  }
+}
+
+/**
+ * @brief Find the newlines among 64 bytes with SIMD compares.
+ *
+ * @param p The 64 bytes, with no alignment required.
+ *
+ * @return A mask whose bit i is set when p[i] is a newline.
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+uint64_t log_stats_newlines(const char *p) {
+#if defined(__SSE2__)
+  const __m128i nl = _mm_set1_epi8('\n');
+  uint64_t m0 = (uint16_t)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)p), nl));
+  uint64_t m1 = (uint16_t)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(p + 16)), nl));
+  uint64_t m2 = (uint16_t)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(p + 32)), nl));
+  uint64_t m3 = (uint16_t)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(p + 48)), nl));
+  return m0 | (m1 << 16) | (m2 << 32) | (m3 << 48);
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+  static const uint8_t weight[16] = {1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128};
+  const uint8x16_t nl = vdupq_n_u8('\n');
+  const uint8x16_t bits = vld1q_u8(weight);
+  uint64_t mask = 0;
+  int i;
+  for (i = 0; i < 4; i++) {
+    uint8x16_t t = vandq_u8(vceqq_u8(vld1q_u8((const uint8_t *)p + 16 * i), nl), bits);
+    mask |= (uint64_t)(vaddv_u8(vget_low_u8(t)) | (vaddv_u8(vget_high_u8(t)) << 8)) << (16 * i);
+  }
+  return mask;
+#else
+  uint64_t mask = 0;
+  int i;
+  for (i = 0; i < 64; i++) {
+    mask |= (uint64_t)(p[i] == '\n') << i;
+  }
+  return mask;
+#endif
+}
+
+/*
+ * Count the lines starting within [start, end) of a file; the last one may run past end. A
+ * chunk not starting a line leaves its first partial line to the previous chunk.
+ */
+static void stats_chunk(struct stats_worker *w, const struct stats_chunk *c) {
+  const char *base = files[c->file].base;
+  size_t size = files[c->file].size;
+  size_t line = c->start;
+  size_t block;
+  if (line > 0 && base[line - 1] != '\n') {
+    const char *nl = memchr(base + line, '\n', size - line);
+    if (nl == NULL) {
+      return;
+    }
+    line = nl - base + 1;
+  }
+  for (block = line; line < c->end && block + 64 <= size; block += 64) {
+    uint64_t mask = log_stats_newlines(base + block);
+    while (mask != 0 && line < c->end) {
+      size_t nl = block + __builtin_ctzll(mask);
+      stats_line(w, base + line, nl - line);
+      line = nl + 1;
+      mask &= mask - 1;
+    }
+  }
+  while (line < c->end && line < size) {
+    const char *nl = memchr(base + line, '\n', size - line);
+    size_t len = nl == NULL ? size - line : (size_t)(nl - (base + line));
+    stats_line(w, base + line, len);
+    line += len + 1;
+  }
+}
+
+static void *stats_thread(void *arg) {
+  struct stats_worker *w = arg;
+  size_t i;
+  while ((i = __atomic_fetch_add(&chunk_next, 1, __ATOMIC_RELAXED)) < chunk_count) {
+    stats_chunk(w, &chunks[i]);
+  }
+  return NULL;
+}
+
+static int stats_map(const char *path, const struct stat *st) {
+  void *base;
+  int fd;
+  if (file_count >= LOG_STATS_FILES_MAX || st->st_size == 0) {
+    return -1;
+  }
+  fd = open(path, O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return -1;
+  }
+  base = mmap(NULL, st->st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (base == MAP_FAILED) {
+    return -1;
+  }
+  // Start reading the whole file ahead, as the threads take its chunks out of order
+  madvise(base, st->st_size, MADV_WILLNEED);
+  files[file_count].base = base;
+  files[file_count].size = st->st_size;
+  file_count++;
+  return 0;
+}
+
+/* Map the *.log files of a directory, recursively, or a single file */
+static void stats_collect(const char *path) {
+  struct stat st;
+  struct dirent *entry;
+  DIR *d;
+  size_t len = strlen(path);
+  if (stat(path, &st) != 0) {
+    fprintf(stderr, "ll-log-stats: %s: not found\n", path);
+    return;
+  }
+  if (S_ISREG(st.st_mode)) {
+    stats_map(path, &st);
+    return;
+  }
+  d = opendir(path);
+  if (d == NULL) {
+    return;
+  }
+  while ((entry = readdir(d)) != NULL) {
+    char child[PATH_MAX];
+    size_t name_len = strlen(entry->d_name);
+    if (entry->d_name[0] == '.' ||
+        (size_t)snprintf(child, sizeof(child), "%s%s%s", path, len > 0 && path[len - 1] == '/' ? "" : "/",
+          entry->d_name) >= sizeof(child)) {
+      continue;
+    }
+    if (entry->d_type == DT_DIR) {
+      stats_collect(child);
+    } else if (name_len > 4 && strcmp(entry->d_name + name_len - 4, ".log") == 0 && stat(child, &st) == 0 &&
+        S_ISREG(st.st_mode)) {
+      stats_map(child, &st);
+    }
+  }
+  closedir(d);
+}
+
+static int stats_by_count(const void *x, const void *y) {
+  const struct stats_entry *a = *(const struct stats_entry *const *)x;
+  const struct stats_entry *b = *(const struct stats_entry *const *)y;
+  return a->count < b->count ? 1 : a->count > b->count ? -1 : 0;
+}
+
+static int stats_by_name(const void *x, const void *y) {
+  const struct stats_entry *a = *(const struct stats_entry *const *)x;
+  const struct stats_entry *b = *(const struct stats_entry *const *)y;
+  return memcmp(a->a, b->a, a->a_len < b->a_len ? a->a_len : b->a_len);
+}
+
+/* The used entries of a table, sorted; the caller frees the array */
+static const struct stats_entry **stats_sorted(const struct stats_table *t, int (*compare)(const void *, const void *)) {
+  const struct stats_entry **list = malloc((t->used + 1) * sizeof(*list));
+  size_t i, n = 0;
+  if (list == NULL) {
+    return NULL;
+  }
+  for (i = 0; i < t->size; i++) {
+    if (t->slot[i].hash != 0) {
+      list[n++] = &t->slot[i];
+    }
+  }
+  qsort(list, n, sizeof(*list), compare);
+  return list;
+}
+
+/* A message as it was counted, with its runs of digits shown as '#' */
+static void stats_print_folded(const char *s, size_t len) {
+  size_t i;
+  for (i = 0; i < len; i++) {
+    if (s[i] >= '0' && s[i] <= '9') {
+      if (i == 0 || s[i - 1] < '0' || s[i - 1] > '9') {
+        putchar('#');
+      }
+    } else {
+      putchar(s[i]);
+    }
+  }
+  putchar('\n');
+}
+
+static void stats_print(const char *title, const struct stats_table *t, size_t top, int bytes, int fold) {
+  const struct stats_entry **list = stats_sorted(t, stats_by_count);
+  size_t i;
+  if (list == NULL) {
+    return;
+  }
+  printf("\n%s", title);
+  if (top < t->used) {
+    printf(" (top %zu of %zu)", top, t->used);
+  }
+  printf("\n");
+  if (bytes) {
+    printf("%12s %14s\n", "lines", "bytes");
+  }
+  for (i = 0; i < t->used && i < top; i++) {
+    const struct stats_entry *e = list[i];
+    if (bytes) {
+      printf("%12llu %14llu  ", (unsigned long long)e->count, (unsigned long long)e->bytes);
+    } else {
+      printf("%12llu  ", (unsigned long long)e->count);
+    }
+    if (e->b == NULL) {
+      printf("%.*s\n", (int)e->a_len, e->a);
+    } else if (fold) {
+      printf("%.*s  ", (int)e->a_len, e->a);
+      stats_print_folded(e->b, e->b_len > 100 ? 100 : e->b_len);
+    } else {
+      printf("%.*s  %.*s\n", (int)e->a_len, e->a, (int)e->b_len, e->b);
+    }
+  }
+  if (t->dropped > 0) {
+    printf("%12llu  lines not counted, the table was full\n", (unsigned long long)t->dropped);
+  }
+  free(list);
+}
+
+/* Every minute in order, with a bar scaled to the busiest one */
+static void stats_print_histogram(const struct stats_table *t) {
+  const struct stats_entry **list = stats_sorted(t, stats_by_name);
+  uint64_t max = 1;
+  size_t i;
+  if (list == NULL) {
+    return;
+  }
+  for (i = 0; i < t->used; i++) {
+    if (list[i]->count > max) {
+      max = list[i]->count;
+    }
+  }
+  printf("\nLines per minute\n");
+  for (i = 0; i < t->used; i++) {
+    int width = (int)((list[i]->count * 50 + max - 1) / max);
+    printf("%.*s %10llu %.*s\n", (int)list[i]->a_len, list[i]->a, (unsigned long long)list[i]->count, width,
+      "##################################################");
+  }
+  free(list);
+}
+
+/**
+ * @brief The ll-log-stats applet: find out which apps and threads write the most log lines.
+ *
+ * Usage: ll-log-stats [--app app] [-j threads] [-n top] [-m] [path...]
+ *
+ * Without a path, every *.log file under DATA_LOG is read (--app limits it to the directory of
+ * an app). The report lists the lines and bytes per app, and the busiest threads, states,
+ * minutes and messages; -m prints every minute as a histogram instead of the busiest ones.
+ * Messages differing only in their numbers count as the same message.
+ *
+ * @return 0 on success, 1 on a usage error or when no log file was found.
+ *
+ * @details The files are scanned by up to LOG_STATS_THREADS_MAX threads, one per online CPU by
+ * default. Compressed archives and binary logs are not read.
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+int log_stats(int argc, char *argv[]) {
+  struct stats_worker *workers;
+  struct stats_worker *total;
+  struct timespec start, end;
+  const char *app = NULL;
+  long threads = sysconf(_SC_NPROCESSORS_ONLN);
+  size_t top = LOG_STATS_TOP;
+  uint64_t bytes = 0;
+  int histogram = 0;
+  int paths = 0;
+  int i, f;
+  for (i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--app") == 0 && i + 1 < argc) {
+      app = argv[++i];
+    } else if (strcmp(argv[i], "-j") == 0 && i + 1 < argc) {
+      threads = atol(argv[++i]);
+    } else if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+      top = (size_t)atol(argv[++i]);
+    } else if (strcmp(argv[i], "-m") == 0) {
+      histogram = 1;
+    } else if (argv[i][0] == '-') {
+      printf("ll-log-stats [--app app] [-j threads] [-n top] [-m] [path...]\n");
+      return strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0 ? 0 : 1;
+    }
+  }
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for (i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--app") == 0 || strcmp(argv[i], "-j") == 0 || strcmp(argv[i], "-n") == 0) {
+      i++;
+    } else if (argv[i][0] != '-') {
+      stats_collect(argv[i]);
+      paths++;
+    }
+  }
+  if (paths == 0) {
+    char dir[PATH_MAX];
+    snprintf(dir, sizeof(dir), "%s%s", DATA_LOG, app != NULL ? app : "");
+    stats_collect(dir);
+  }
+  if (file_count == 0) {
+    fprintf(stderr, "ll-log-stats: no log file found\n");
+    return 1;
+  }
+  for (f = 0; f < file_count; f++) {
+    chunk_count += (files[f].size + LOG_STATS_CHUNK - 1) / LOG_STATS_CHUNK;
+    bytes += files[f].size;
+  }
+  chunks = malloc(chunk_count * sizeof(*chunks));
+  if (threads < 1) {
+    threads = 1;
+  } else if (threads > LOG_STATS_THREADS_MAX) {
+    threads = LOG_STATS_THREADS_MAX;
+  }
+  if ((size_t)threads > chunk_count) {
+    threads = chunk_count;
+  }
+  workers = calloc(threads, sizeof(*workers));
+  if (chunks == NULL || workers == NULL) {
+    return 1;
+  }
+  chunk_count = 0;
+  for (f = 0; f < file_count; f++) {
+    size_t offset;
+    for (offset = 0; offset < files[f].size; offset += LOG_STATS_CHUNK) {
+      chunks[chunk_count].file = f;
+      chunks[chunk_count].start = offset;
+      chunks[chunk_count].end = offset + LOG_STATS_CHUNK < files[f].size ? offset + LOG_STATS_CHUNK : files[f].size;
+      chunk_count++;
+    }
+  }
+  for (i = 0; i < threads; i++) {
+    struct stats_worker *w = &workers[i];
+    if (stats_table_init(&w->apps, LOG_STATS_NAMES) != 0 || stats_table_init(&w->threads, LOG_STATS_NAMES) != 0 ||
+        stats_table_init(&w->states, LOG_STATS_NAMES) != 0 || stats_table_init(&w->minutes, LOG_STATS_MINUTES) != 0 ||
+        stats_table_init(&w->messages, LOG_STATS_MESSAGES) != 0) {
+      fprintf(stderr, "ll-log-stats: out of memory\n");
+      return 1;
+    }
+  }
+  // The calling thread scans too, as the first worker
+  for (i = 1; i < threads; i++) {
+    if (pthread_create(&workers[i].tid, NULL, stats_thread, &workers[i]) != 0) {
+      workers[i].tid = 0;
+    }
+  }
+  stats_thread(&workers[0]);
+  total = &workers[0];
+  for (i = 1; i < threads; i++) {
+    if (workers[i].tid != 0) {
+      pthread_join(workers[i].tid, NULL);
+    }
+    stats_merge(&total->apps, &workers[i].apps);
+    stats_merge(&total->threads, &workers[i].threads);
+    stats_merge(&total->states, &workers[i].states);
+    stats_merge(&total->minutes, &workers[i].minutes);
+    stats_merge(&total->messages, &workers[i].messages);
+    total->lines += workers[i].lines;
+    total->other += workers[i].other;
+  }
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  printf("%d files, %llu bytes, %llu lines (%llu continued or unparsed) in %.3f s with %ld threads\n", file_count,
+    (unsigned long long)bytes, (unsigned long long)total->lines, (unsigned long long)total->other,
+    (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9, threads);
+  stats_print("Apps", &total->apps, total->apps.used, 1, 0);
+  stats_print("Threads", &total->threads, top, 0, 0);
+  stats_print("States", &total->states, top, 0, 0);
+  if (histogram) {
+    stats_print_histogram(&total->minutes);
+  } else {
+    stats_print("Busiest minutes", &total->minutes, top, 0, 0);
+  }
+  stats_print("Repeated messages", &total->messages, top, 0, 1);
+  return 0;
+}
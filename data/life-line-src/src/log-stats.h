@@ -0,0 +1,50 @@
+#ifndef LOG_STATS_H
+#define LOG_STATS_H
+
+/**
+ * @file log-stats.h
+ * @brief Count the log lines under DATA_LOG per app, thread, state, minute and message
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <time.h>
+#include <unistd.h>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+/* The files are cut into chunks of this size, taken in turn by the scanning threads */
+#define LOG_STATS_CHUNK (4 * 1024 * 1024)
+#define LOG_STATS_THREADS_MAX 16
+#define LOG_STATS_FILES_MAX 4096
+#define LOG_STATS_TOP 20
+/* Slots of the per-thread tables; a table stops taking new keys at three quarters */
+#define LOG_STATS_NAMES 4096
+#define LOG_STATS_MINUTES 65536
+#define LOG_STATS_MESSAGES 65536
+
+/**
+ * @note #include <sys/mman.h>, for mmap, madvise
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+int log_stats(int argc, char *argv[]);
+uint64_t log_stats_newlines(const char *p);
+
+#endif /* LOG_STATS_H */
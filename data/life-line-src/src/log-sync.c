@@ -0,0 +1,250 @@
+#include "log-sync.h"
+#include "log-sink.h"
+#include "reaper.h"
+#include "wait-ms.h"
+
+/**
+ * @file log-sync.c
+ * @brief Decide when the log lines written by the sink are forced to disk
+ *
+ * The sink numbers its appends. In the group mode a writer waits until the synced number
+ * reaches its own: the first one to wait leads, sleeps for the window (if any) so that the
+ * other writers (or the next batches of the flusher) join, and issues one fdatasync() per
+ * written file for all of them; the writers arriving meanwhile form the next group. The
+ * per-record mode syncs in the sink itself, and the periodic mode in a thread of its own.
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+
+static enum log_sync_mode sync_mode = LOG_SYNC_NONE;
+static int sync_interval = 0;
+static uint64_t synced_seq = 0;
+static int syncing = 0;
+static int syncer_running = 0;
+static pthread_mutex_t sync_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t sync_cond = PTHREAD_COND_INITIALIZER;
+
+/* Since the last log_sync_configure() */
+static double stats_since = 0;
+static unsigned long long stats_syncs = 0;
+static unsigned long long stats_commits = 0;
+static double stats_latency = 0;
+static double stats_latency_max = 0;
+
+static const char *const mode_names[] = {"none", "periodic", "group", "record"};
+
+/* Sync the written files; call with sync_lock not held. Returns with it held. */
+static void sync_round(double *oldest) {
+  uint64_t covered;
+  int syncs = log_sink_sync_dirty(&covered, oldest);
+  pthread_mutex_lock(&sync_lock);
+  stats_syncs += syncs;
+  if (covered > synced_seq) {
+    synced_seq = covered;
+  }
+  pthread_cond_broadcast(&sync_cond);
+}
+
+static void *log_syncer(void *arg) {
+  (void)arg;
+  reaper_block_signals();
+  for (;;) {
+    double oldest;
+    int interval;
+    pthread_mutex_lock(&sync_lock);
+    interval = sync_interval;
+    if (sync_mode != LOG_SYNC_PERIODIC) {
+      syncer_running = 0;
+      pthread_mutex_unlock(&sync_lock);
+      return NULL;
+    }
+    pthread_mutex_unlock(&sync_lock);
+    sleep_ms(interval);
+    sync_round(&oldest);
+    if (oldest > 0) {
+      // The age of the oldest line made durable by this round
+      double latency = log_sync_now() - oldest;
+      stats_commits++;
+      stats_latency += latency;
+      if (latency > stats_latency_max) {
+        stats_latency_max = latency;
+      }
+    }
+    pthread_mutex_unlock(&sync_lock);
+  }
+}
+
+/**
+ * @brief The time in seconds on the monotonic clock.
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+double log_sync_now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/**
+ * @brief Select the durability of the log files.
+ *
+ * @param mode One of enum log_sync_mode.
+ * @param interval_ms The period of LOG_SYNC_PERIODIC or the window of LOG_SYNC_GROUP; -1 for the
+ * default.
+ *
+ * @details The statistics of log_sync_report() restart from this call.
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+void log_sync_configure(enum log_sync_mode mode, int interval_ms) {
+  pthread_t tid;
+  pthread_mutex_lock(&sync_lock);
+  sync_mode = mode;
+  if (mode == LOG_SYNC_PERIODIC) {
+    sync_interval = interval_ms > 0 ? interval_ms : LOG_SYNC_PERIOD_MS;
+  } else {
+    sync_interval = interval_ms >= 0 ? interval_ms : LOG_SYNC_WINDOW_MS;
+  }
+  stats_since = log_sync_now();
+  stats_syncs = stats_commits = 0;
+  stats_latency = stats_latency_max = 0;
+  if (mode == LOG_SYNC_PERIODIC && !syncer_running && pthread_create(&tid, NULL, log_syncer, NULL) == 0) {
+    pthread_detach(tid);
+    syncer_running = 1;
+  }
+  pthread_mutex_unlock(&sync_lock);
+}
+
+/**
+ * @brief Apply LL_LOG_SYNC: "none", "periodic[:ms]", "group[:ms]" or "record".
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+void log_sync_init_from_env(void) {
+  const char *value = getenv("LL_LOG_SYNC");
+  size_t i;
+  if (value == NULL) {
+    return;
+  }
+  for (i = 0; i < sizeof(mode_names) / sizeof(mode_names[0]); i++) {
+    size_t len = strlen(mode_names[i]);
+    if (strncmp(value, mode_names[i], len) == 0 && (value[len] == 0 || value[len] == ':')) {
+      log_sync_configure((enum log_sync_mode)i, value[len] == ':' ? atoi(value + len + 1) : -1);
+      return;
+    }
+  }
+}
+
+/**
+ * @brief The current durability mode.
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+enum log_sync_mode log_sync_mode(void) {
+  return sync_mode;
+}
+
+/**
+ * @brief Count syncs made outside this module, and the commit latency they gave.
+ *
+ * @param syncs The number of fdatasync() calls.
+ * @param latency The seconds a writer waited for them, or a negative value for none.
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+void log_sync_record(int syncs, double latency) {
+  pthread_mutex_lock(&sync_lock);
+  stats_syncs += syncs;
+  if (latency >= 0) {
+    stats_commits++;
+    stats_latency += latency;
+    if (latency > stats_latency_max) {
+      stats_latency_max = latency;
+    }
+  }
+  pthread_mutex_unlock(&sync_lock);
+}
+
+/**
+ * @brief Wait until an append of the sink is on disk, in the group mode.
+ *
+ * @param seq The number the sink gave to the append; 0 or another mode returns at once.
+ *
+ * @details The first waiter becomes the leader of the group: it sleeps for the window, syncs
+ * every file written since the previous round, and wakes the others. A writer that arrives
+ * during a round waits for the next one, as its lines may have missed the sync.
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+void log_sync_commit(uint64_t seq) {
+  double start;
+  double latency;
+  if (sync_mode != LOG_SYNC_GROUP || seq == 0) {
+    return;
+  }
+  start = log_sync_now();
+  pthread_mutex_lock(&sync_lock);
+  while (synced_seq < seq) {
+    if (!syncing) {
+      double oldest;
+      int window = sync_interval;
+      syncing = 1;
+      pthread_mutex_unlock(&sync_lock);
+      if (window > 0) {
+        sleep_ms(window);
+      }
+      sync_round(&oldest);
+      syncing = 0;
+    } else {
+      pthread_cond_wait(&sync_cond, &sync_lock);
+    }
+  }
+  latency = log_sync_now() - start;
+  stats_commits++;
+  stats_latency += latency;
+  if (latency > stats_latency_max) {
+    stats_latency_max = latency;
+  }
+  pthread_mutex_unlock(&sync_lock);
+}
+
+/**
+ * @brief Describe the durability mode and what it cost since it was configured.
+ *
+ * @param buf Receives e.g. "group/0ms: 532 fsyncs (26.6/s), commit latency avg 2.41 ms,
+ * max 9.80 ms".
+ * @param size The size of buf.
+ *
+ * @return The length of the text, as snprintf().
+ *
+ * @details The commit latency is the time a writer waited for its lines to be synced, or, in
+ * the periodic mode, the age of the oldest line made durable by a round.
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+int log_sync_report(char *buf, size_t size) {
+  double elapsed;
+  int len;
+  pthread_mutex_lock(&sync_lock);
+  elapsed = log_sync_now() - stats_since;
+  if (sync_mode == LOG_SYNC_PERIODIC || sync_mode == LOG_SYNC_GROUP) {
+    len = snprintf(buf, size, "%s/%dms", mode_names[sync_mode], sync_interval);
+  } else {
+    len = snprintf(buf, size, "%s", mode_names[sync_mode]);
+  }
+  if (len >= 0 && (size_t)len < size) {
+    len += snprintf(buf + len, size - len, ": %llu fsyncs (%.1f/s), commit latency avg %.2f ms, max %.2f ms",
+      stats_syncs, elapsed > 0 ? stats_syncs / elapsed : 0.0,
+      stats_commits > 0 ? stats_latency * 1000 / stats_commits : 0.0, stats_latency_max * 1000);
+  }
+  pthread_mutex_unlock(&sync_lock);
+  return len;
+}
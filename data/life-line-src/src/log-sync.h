@@ -0,0 +1,49 @@
+#ifndef LOG_SYNC_H
+#define LOG_SYNC_H
+
+/**
+ * @file log-sync.h
+ * @brief Decide when the log lines written by the sink are forced to disk
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+/*
+ * Defaults of the interval given as LL_LOG_SYNC=periodic:MS and group:MS. Without a window, a
+ * group gathers the writers arriving while the previous sync is running.
+ */
+#define LOG_SYNC_PERIOD_MS 1000
+#define LOG_SYNC_WINDOW_MS 0
+
+enum log_sync_mode {
+  LOG_SYNC_NONE,      /* leave it to the kernel, as before */
+  LOG_SYNC_PERIODIC,  /* a thread syncs the written files every interval */
+  LOG_SYNC_GROUP,     /* a writer waits for one sync covering every line written within a window */
+  LOG_SYNC_RECORD     /* every append is synced before it returns */
+};
+
+/**
+ * @note #include <pthread.h>, for pthread_cond_wait
+ * @note #include <unistd.h>, for fdatasync
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+void log_sync_configure(enum log_sync_mode mode, int interval_ms);
+void log_sync_init_from_env(void);
+enum log_sync_mode log_sync_mode(void);
+double log_sync_now(void);
+void log_sync_record(int syncs, double latency);
+void log_sync_commit(uint64_t seq);
+int log_sync_report(char *buf, size_t size);
+
+#endif /* LOG_SYNC_H */
@@ -2,12 +2,31 @@
 #include <stdio.h>        /* for fprintf, stderr */ 
 #include "fix-docroot.h"
 #include "handle-exit.h"
+#include "io-policy.h"
 #include "life-line.h"
+#include "log-archive.h"
+#include "log-async.h"
+#include "log-binary.h"
+#include "log-dedup.h"
+#include "log-bench.h"
+#include "log-flight.h"
+#include "log-forward.h"
+#include "log-level.h"
 #include "log-message.h"
+#include "log-pipe.h"
+#include "log-query.h"
+#include "log-server.h"
+#include "log-sink.h"
+#include "log-stats.h"
+#include "log-sync.h"
 #include "make-directory.h"
 #include "project.h"
+#include "reaper.h"
 #include "remove-old-log.h"
+#include "startup.h"
+#include "supervise.h"
 #include "sync-key.h"
+#include "tunnel.h"
 
 /**
  * @brief LifeLine - Prevents Docker container exit and manages SSH keys for the root account.
@@ -42,12 +61,43 @@ int main(int argc, char *argv[]) {
   char *thread_name = "Thread_main";
   int debug_mode = 0;
   char *me = basename(argv[0]);
+  char **run = NULL;
+  startup_mark("main");
+  log_level_init_from_env();
+  log_dedup_init_from_env();
+  log_binary_init_from_env();
+  log_sync_init_from_env();
+  io_policy_init_from_env();
+  if(strcmp(me, "ll-log-cat") == 0) {
+    // A reader: it leaves no trace in the logs
+    return log_cat(argc, argv);
+  }
+  if(strcmp(me, "ll-log-query") == 0) {
+    return log_query(argc, argv);
+  }
+  if(strcmp(me, "ll-log-stats") == 0) {
+    return log_stats(argc, argv);
+  }
+  if(strcmp(me, "ll-log-pipe") == 0) {
+    // Writes the files itself: one open stream instead of a datagram per line
+    return log_pipe(argc, argv);
+  }
+  if(strcmp(me, "ll-log-msg") == 0) {
+    // One datagram to the running daemon; write the files directly only when it is absent
+    if(argc == 3 && log_client_send_message(logPid(), argv[1], argv[2]) == 0) {
+      return 0;
+    } else if(argc == 4 && log_client_send_message(atoi(argv[1]), argv[2], argv[3]) == 0) {
+      return 0;
+    }
+  }
   if((strcmp(me, "ll-log-msg") == 0) || (strcmp(me, "ll-log-file") == 0) || 
     (strcmp(me, "ll-pid-file") == 0) || (strcmp(me, "ll-remove-old-log") == 0) || 
     (strcmp(me, "ll-sync-key") == 0) || (strcmp(me, "ll-fix-docroot") == 0)) {
+    log_client_attach();
     init_log_appName(debug_mode, "", me);
   } else {
     init_log(thread_name);
+    startup_mark("log");
   }
   if(strcmp(me, "ll-log-msg") == 0) {
     if(argc == 3) {
@@ -145,6 +195,10 @@ int main(int argc, char *argv[]) {
     advanced_log_appname(debug_mode, "", me,"====== State: .*RUNNING* -> *END*............ ======");
     return 0;    
   } else {
+    if (argc >= 3 && (strcmp(argv[1], "-r") == 0 || strcmp(argv[1], "--run") == 0 || strcmp(argv[1], "run") == 0)) {
+      // The daemon, with the application as its supervised child
+      run = argv + 2;
+    }
     if (argc == 2) {
       if (strcmp(argv[1], "-v") == 0 || strcmp(argv[1], "--version") == 0 ||  strcmp(argv[1], "version") == 0) {
         advanced_log_appname(debug_mode, "", APP_NAME,"------ State: .*ARGU_CHECKING* -> *RUNNING*.. ------");
@@ -153,15 +207,35 @@ int main(int argc, char *argv[]) {
         return 0;    
       } else if(strcmp(argv[1], "-d") == 0 || strcmp(argv[1], "-F") == 0 || strcmp(argv[1], "--debug") == 0 || strcmp(argv[1], "debug") == 0) {
         debug_mode = 1;
+      } else if(strcmp(argv[1], "-t") == 0 || strcmp(argv[1], "--timing") == 0 || strcmp(argv[1], "timing") == 0) {
+        // The start-up of the daemon, up to its first loop tick
+        startup_timing(1);
       } else if(strcmp(argv[1], "-h") == 0 || strcmp(argv[1], "--help") == 0 || strcmp(argv[1], "help") == 0) {
         advanced_log_appname(debug_mode, "", APP_NAME,"------ State: .*ARGU_CHECKING* -> *RUNNING*.. ------");
-        printf("life-line [-dFhlosv] [--][debug|help|log|logfile|shortlink|version]\n");
+        printf("life-line [-abcdFhlorstv] [--][archive|bench|collect|debug|flight|help|log|logfile|run|shortlink|timing|version]\n");
+        advanced_log_appname(debug_mode, "", APP_NAME,"====== State: .*RUNNING* -> *END*............ ======");
+        return 0;    
+      } else if(strcmp(argv[1], "-a") == 0 || strcmp(argv[1], "--archive") == 0 || strcmp(argv[1], "archive") == 0) {
+        advanced_log_appname(debug_mode, "", APP_NAME,"------ State: .*ARGU_CHECKING* -> *RUNNING*.. ------");
+        printf("%d log files archived\n", log_archive_dir(DATA_LOG, thread_name, debug_mode));
+        advanced_log_appname(debug_mode, "", APP_NAME,"====== State: .*RUNNING* -> *END*............ ======");
+        return 0;    
+      } else if(strcmp(argv[1], "-b") == 0 || strcmp(argv[1], "--bench") == 0 || strcmp(argv[1], "bench") == 0) {
+        advanced_log_appname(debug_mode, "", APP_NAME,"------ State: .*ARGU_CHECKING* -> *RUNNING*.. ------");
+        log_bench(LOG_BENCH_LINES);
+        advanced_log_appname(debug_mode, "", APP_NAME,"====== State: .*RUNNING* -> *END*............ ======");
+        return 0;    
+      } else if(strcmp(argv[1], "--flight") == 0 || strcmp(argv[1], "flight") == 0) {
+        advanced_log_appname(debug_mode, "", APP_NAME,"------ State: .*ARGU_CHECKING* -> *RUNNING*.. ------");
+        if (log_flight_dump(stdout) < 0) {
+          fprintf(stderr, "%s: no flight recorder\n", LOG_FLIGHT_FILE);
+        }
         advanced_log_appname(debug_mode, "", APP_NAME,"====== State: .*RUNNING* -> *END*............ ======");
         return 0;    
       } else if(strcmp(argv[1], "-s") == 0 || strcmp(argv[1], "--shortlinnk") == 0 || strcmp(argv[1], "shortlink") == 0) {
         advanced_log_appname(debug_mode, "", APP_NAME,"------ State: .*ARGU_CHECKING* -> *RUNNING*.. ------");
         lifeLifeShortLink(thread_name, 1);
-        printf("Shortlinks: ll-log-file, ll-pid-file,. ll-log-msg, ll-remove-old-log, ll-sync-key, ll-fix-docroot\n    have been ..Created..\n");
+        printf("Shortlinks: ll-log-file, ll-pid-file,. ll-log-msg, ll-remove-old-log, ll-sync-key, ll-fix-docroot, ll-log-cat, ll-log-query, ll-log-stats, ll-log-pipe\n    have been ..Created..\n");
         advanced_log_appname(debug_mode, "", APP_NAME,"====== State: .*RUNNING* -> *END*............ ======");
         return 0;    
       }
@@ -173,6 +247,21 @@ int main(int argc, char *argv[]) {
         free(filename);
         advanced_log_appname(debug_mode, "", APP_NAME,"====== State: .*RUNNING* -> *END*............ ======");
         return 0;    
+      } else if ((strcmp(argv[1], "-a") == 0 || strcmp(argv[1], "--archive") == 0 || strcmp(argv[1], "archive") == 0) &&
+          strcmp(argv[2], "train") == 0) {
+        int rc;
+        advanced_log_appname(debug_mode, "", APP_NAME,"------ State: .*ARGU_CHECKING* -> *RUNNING*.. ------");
+        rc = log_archive_train(thread_name);
+        printf("%s: %s\n", LOG_ARCHIVE_DICT, rc == 0 ? "trained" : "not trained, see the life-line log");
+        advanced_log_appname(debug_mode, "", APP_NAME,"====== State: .*RUNNING* -> *END*............ ======");
+        return rc;
+      } else if (strcmp(argv[1], "-c") == 0 || strcmp(argv[1], "--collect") == 0 || strcmp(argv[1], "collect") == 0) {
+        return log_forward_collect(argv[2]);
+      } else if (strcmp(argv[1], "-b") == 0 || strcmp(argv[1], "--bench") == 0 || strcmp(argv[1], "bench") == 0) {
+        advanced_log_appname(debug_mode, "", APP_NAME,"------ State: .*ARGU_CHECKING* -> *RUNNING*.. ------");
+        log_bench(atoi(argv[2]));
+        advanced_log_appname(debug_mode, "", APP_NAME,"====== State: .*RUNNING* -> *END*............ ======");
+        return 0;    
       }
     } else if (argc == 4 && (strcmp(argv[1], "log") == 0 || strcmp(argv[1], "-l") == 0 || strcmp(argv[1], "--log") == 0)) {
       advanced_log_appname(debug_mode, "", APP_NAME,"------ State: .*ARGU_CHECKING* -> *RUNNING*.. ------");
@@ -188,20 +277,48 @@ int main(int argc, char *argv[]) {
     }
     advanced_log_appname(debug_mode, "", APP_NAME,"------ State: .*ARGU_CHECKING* -> *RUNNING*.. ------");
     lifeLifeShortLink(thread_name, debug_mode);
+    startup_mark("shortlinks");
     if (make_directory(ROOT_SSH) != 0) {
-      log_message_w_thread( thread_name, "Creating folder: " ROOT_SSH " ..Failed..");
+      LOG_ERROR(LOG_MODULE_MAIN, thread_name, "Creating folder: " ROOT_SSH " ..Failed..");
+    }
+    startup_mark("directories");
+    if (reaper_start(thread_name) != 0) {
+      signal_exit();
     }
-    signal_exit();
+    log_flight_start(thread_name);
+    if (log_forward_start_from_env() != 0) {
+      LOG_ERROR(LOG_MODULE_LOG, thread_name, "Log forwarding to %s ..Failed..", getenv("LL_LOG_FORWARD"));
+    }
+    if (log_async_start_from_env() != 0) {
+      LOG_ERROR(LOG_MODULE_LOG, thread_name, "Starting asynchronous logging ..Failed..");
+    }
+    log_server_start(thread_name);
+    log_archive_start(thread_name, debug_mode);
+    startup_mark("threads");
     life_line(thread_name, debug_mode);
-    if (argc == 1) {
+    startup_mark("life_line");
+    if (run != NULL) {
+      supervise_start(run, thread_name);
+      startup_mark("supervise");
+    }
+    if (argc == 1 || run != NULL) {
       advanced_log_appname(debug_mode, "", APP_NAME,"------ State: .*RUNNING* -> *MAIN_LOOP*...... ------");
       life_line_loop(thread_name, debug_mode);
-    } else if (argc == 2 && (strcmp(argv[1], "-d") == 0 || strcmp(argv[1], "-F") == 0)) {
+    } else if (argc == 2 && (strcmp(argv[1], "-d") == 0 || strcmp(argv[1], "-F") == 0 ||
+        strcmp(argv[1], "-t") == 0 || strcmp(argv[1], "--timing") == 0 || strcmp(argv[1], "timing") == 0)) {
       advanced_log_appname(debug_mode, "", APP_NAME,"------ State: .*RUNNING* -> *MAIN_LOOP*...... ------");
       life_line_loop(thread_name, debug_mode);
     } else {
       advanced_log_appname(debug_mode, "", APP_NAME,"====== State: .*RUNNING* -> *END*............ ======");
     }
+    startup_not_ready();
+    supervise_stop();
+    tunnel_stop();
+    log_server_stop();
+    log_async_drain();
+    log_forward_drain();
+    log_sink_flush_spill(1);
+    log_flight_stop();
   }
   return 0;
 }
@@ -18,7 +18,9 @@
  * 
  * @return 0 on success, -1 on failure.
  * 
- * @details The function works by iterating over the path and creating each directory one
+ * @details The function first tries to create the whole path with a single mkdir, which
+ * is enough when the directory exists or only its last component is missing. Otherwise it works
+ * by iterating over the path and creating each directory one
  * by one using the mkdir function. If a directory already exists, the function continues
  * to the next directory in the path. If an error occurs while creating a directory, the
  * function returns immediately with a failure code. The function assumes that the user
@@ -37,6 +39,13 @@
  */
 int make_directory(const char *path) {
   char dir[1024];
+  // Usually there already, or only the last component missing: one mkdir() then
+  if (mkdir(path, 0700) == 0 || errno == EEXIST) {
+    return 0;
+  }
+  if (errno != ENOENT) {
+    return -1;
+  }
   strcpy(dir, path);
   int len = strlen(dir);
   if (dir[len - 1] == '/') {
@@ -16,6 +16,14 @@
 #define DATA_ROOT "/data/"
 #define DATA_LOG DATA_ROOT "doc-root/log/"
 #define LOG_DIR DATA_LOG APP
+#define LOG_LEVEL_FILE DATA_ROOT ".log-level"
+#define LOG_FLIGHT_FILE DATA_ROOT ".flight-recorder"
+#define LOG_ARCHIVE_DICT DATA_LOG ".archive.dict"
+#define LOG_FORWARD_CURSOR DATA_LOG ".forward.cursor"
+#define RUN_DIR "/run/life-line/"
+#define LOG_SOCKET RUN_DIR "log.sock"
+#define LOG_SOCKET_LOCK RUN_DIR "log.lock"
+#define READY_FILE RUN_DIR "ready"
 
 /* Required by main */
 #define ROOT "/root/"
@@ -28,9 +36,13 @@
 #define ROOT_PUBLIC_KEY ROOT_SSH "id_rsa.pub"
 #define TUNNEL_DIR DATA_ROOT "tunnel/"
 #define TUNNEL_CONF TUNNEL_DIR "tunnel.conf"
-#define TUNNEL_CMD1 "/usr/bin/check-tunnel"
-#define TUNNEL_CMD2 "/usr/local/bin/check-tunnel"
-#define TUNNEL_CMD3 "/usr/bin/start-tunnel"
-#define TUNNEL_CMD4 "/usr/local/bin/start-tunnel"
+#define TUNNEL_HOOK_DIR1 "/usr/bin/"
+#define TUNNEL_HOOK_DIR2 "/usr/local/bin/"
+#define TUNNEL_CHECK_HOOK "check-tunnel"
+#define TUNNEL_START_HOOK "start-tunnel"
+#define TUNNEL_CMD1 TUNNEL_HOOK_DIR1 TUNNEL_CHECK_HOOK
+#define TUNNEL_CMD2 TUNNEL_HOOK_DIR2 TUNNEL_CHECK_HOOK
+#define TUNNEL_CMD3 TUNNEL_HOOK_DIR1 TUNNEL_START_HOOK
+#define TUNNEL_CMD4 TUNNEL_HOOK_DIR2 TUNNEL_START_HOOK
 
 #endif /* PROJECT_H */
@@ -0,0 +1,263 @@
+#include "reaper.h"
+#include "handle-exit.h"
+#include "log-level.h"
+#include "wait-ms.h"
+
+/**
+ * @file reaper.c
+ * @brief The duties of PID 1: reap the orphans, and take the signals in a thread of their own
+ *
+ * As the ENTRYPOINT, life-line is PID 1, and the processes orphaned by the tunnel scripts or
+ * the supervised application are handed to it. Outside of a container, PR_SET_CHILD_SUBREAPER
+ * makes it their parent all the same. Unless somebody waits for them, they stay in the process
+ * table as zombies.
+ *
+ * SIGCHLD, SIGINT and SIGTERM are blocked in every thread and read from a signalfd by the
+ * reaper thread: on SIGCHLD it collects every exited child, and on SIGINT or SIGTERM it runs
+ * handle_exit() as a plain function, where the log files can be flushed and closed safely.
+ *
+ * A thread waiting for a child of its own spawns it with reaper_spawn() and waits with
+ * reaper_waitpid(): the reaper keeps the exit status of such a child for its owner instead of
+ * discarding it.
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+
+static pthread_mutex_t reaper_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t reaper_cond = PTHREAD_COND_INITIALIZER;
+static struct reaper_child owned[REAPER_OWNED_MAX];
+static sigset_t original_mask;
+static int signal_fd = -1;
+static int active = 0;
+static unsigned long orphans = 0;
+
+static void reaper_signals(sigset_t *set) {
+  sigemptyset(set);
+  sigaddset(set, SIGCHLD);
+  sigaddset(set, SIGINT);
+  sigaddset(set, SIGTERM);
+}
+
+static struct reaper_child *reaper_find(pid_t pid) {
+  int i;
+  for (i = 0; i < REAPER_OWNED_MAX; i++) {
+    if (owned[i].pid == pid) {
+      return &owned[i];
+    }
+  }
+  return NULL;
+}
+
+/* Wait for every exited child, keeping the status of the owned ones; called with the lock */
+static void reaper_collect(void) {
+  int status;
+  pid_t pid;
+  while ((pid = waitpid(-1, &status, WNOHANG)) > 0) {
+    struct reaper_child *c = reaper_find(pid);
+    if (c != NULL) {
+      c->status = status;
+      c->exited = 1;
+    } else {
+      orphans++;
+    }
+  }
+  pthread_cond_broadcast(&reaper_cond);
+}
+
+static void *reaper_thread(void *arg) {
+  struct signalfd_siginfo info;
+  (void)arg;
+  for (;;) {
+    ssize_t n = read(signal_fd, &info, sizeof(info));
+    if (n != sizeof(info)) {
+      continue;
+    }
+    if (info.ssi_signo == SIGCHLD) {
+      pthread_mutex_lock(&reaper_lock);
+      reaper_collect();
+      pthread_mutex_unlock(&reaper_lock);
+    } else {
+      handle_exit((int)info.ssi_signo);
+    }
+  }
+  return NULL;
+}
+
+/**
+ * @brief Become the reaper of the orphans, and take SIGCHLD, SIGINT and SIGTERM in a thread.
+ *
+ * @param thread_name The thread logging a failure.
+ *
+ * @return 0 on success, -1 when the signals are left to the caller, e.g. to signal_exit().
+ *
+ * @details Called from the main thread before the other threads are started, so that they
+ * inherit the blocked signals.
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+int reaper_start(const char *thread_name) {
+  sigset_t set;
+  pthread_t tid;
+  if (active) {
+    return 0;
+  }
+  if (getpid() != 1 && prctl(PR_SET_CHILD_SUBREAPER, 1) != 0) {
+    LOG_WARN(LOG_MODULE_MAIN, thread_name, "Becoming the child subreaper ..Failed.. (%s)", strerror(errno));
+  }
+  reaper_signals(&set);
+  pthread_sigmask(SIG_BLOCK, &set, &original_mask);
+  signal_fd = signalfd(-1, &set, SFD_CLOEXEC);
+  if (signal_fd < 0 || pthread_create(&tid, NULL, reaper_thread, NULL) != 0) {
+    LOG_ERROR(LOG_MODULE_MAIN, thread_name, "Starting the reaper thread ..Failed.. (%s)", strerror(errno));
+    if (signal_fd >= 0) {
+      close(signal_fd);
+      signal_fd = -1;
+    }
+    pthread_sigmask(SIG_SETMASK, &original_mask, NULL);
+    return -1;
+  }
+  pthread_detach(tid);
+  pthread_mutex_lock(&reaper_lock);
+  active = 1;
+  // The children that exited before the start sent no SIGCHLD to the signalfd
+  reaper_collect();
+  pthread_mutex_unlock(&reaper_lock);
+  return 0;
+}
+
+/**
+ * @brief Tell whether the reaper thread is running.
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+int reaper_active(void) {
+  return active;
+}
+
+/**
+ * @brief Leave SIGCHLD, SIGINT and SIGTERM to the reaper thread in a thread started before it.
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+void reaper_block_signals(void) {
+  sigset_t set;
+  reaper_signals(&set);
+  pthread_sigmask(SIG_BLOCK, &set, NULL);
+}
+
+/**
+ * @brief waitpid() for a child spawned with reaper_spawn().
+ *
+ * @param pid The child.
+ * @param status Receives the exit status, if not NULL.
+ * @param options 0 or WNOHANG.
+ *
+ * @return pid once the child has exited, 0 with WNOHANG while it runs, or -1 with errno set.
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+pid_t reaper_waitpid(pid_t pid, int *status, int options) {
+  struct timespec deadline;
+  struct reaper_child *c;
+  pthread_mutex_lock(&reaper_lock);
+  c = active && pid > 0 ? reaper_find(pid) : NULL;
+  if (c == NULL) {
+    pthread_mutex_unlock(&reaper_lock);
+    return waitpid(pid, status, options);
+  }
+  for (;;) {
+    if (!c->exited) {
+      pid_t rc = waitpid(pid, &c->status, WNOHANG);
+      if (rc < 0 && errno != EINTR) {
+        c->pid = 0;
+        pthread_mutex_unlock(&reaper_lock);
+        return -1;
+      }
+      c->exited = rc == pid;
+    }
+    if (c->exited) {
+      if (status != NULL) {
+        *status = c->status;
+      }
+      c->pid = 0;
+      pthread_mutex_unlock(&reaper_lock);
+      return pid;
+    }
+    if (options & WNOHANG) {
+      pthread_mutex_unlock(&reaper_lock);
+      return 0;
+    }
+    // Woken by the reaper thread, or polled: handle_exit() may keep that thread busy
+    deadline_ms(&deadline, REAPER_POLL_MS);
+    pthread_cond_timedwait(&reaper_cond, &reaper_lock, &deadline);
+  }
+}
+
+/**
+ * @brief posix_spawn() a child whose exit status is kept for reaper_waitpid().
+ *
+ * @param path The program, run without a shell.
+ * @param actions The file actions, or NULL.
+ * @param attr The attributes; the signal mask of the process before reaper_start() is added.
+ * @param argv The arguments, NULL terminated.
+ *
+ * @return The pid of the child, or -1 with errno set.
+ *
+ * @details glibc spawns with clone(CLONE_VM | CLONE_VFORK), so the pages of the daemon are
+ * neither copied nor marked copy-on-write as with fork().
+ *
+ * @note #include <spawn.h>, for posix_spawn
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+pid_t reaper_spawn(const char *path, const posix_spawn_file_actions_t *actions, posix_spawnattr_t *attr,
+    char *const argv[]) {
+  struct reaper_child *c = NULL;
+  short flags = 0;
+  pid_t pid;
+  int rc;
+  pthread_mutex_lock(&reaper_lock);
+  if (active) {
+    c = reaper_find(0);
+    if (c == NULL) {
+      pthread_mutex_unlock(&reaper_lock);
+      errno = EAGAIN;
+      return -1;
+    }
+    posix_spawnattr_getflags(attr, &flags);
+    posix_spawnattr_setflags(attr, flags | POSIX_SPAWN_SETSIGMASK);
+    posix_spawnattr_setsigmask(attr, &original_mask);
+  }
+  rc = posix_spawn(&pid, path, actions, attr, argv, environ);
+  if (rc != 0) {
+    pthread_mutex_unlock(&reaper_lock);
+    errno = rc;
+    return -1;
+  }
+  if (c != NULL) {
+    c->pid = pid;
+    c->exited = 0;
+  }
+  pthread_mutex_unlock(&reaper_lock);
+  return pid;
+}
+
+/**
+ * @brief The number of orphans reaped since the start.
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+unsigned long reaper_orphans(void) {
+  unsigned long count;
+  pthread_mutex_lock(&reaper_lock);
+  count = orphans;
+  pthread_mutex_unlock(&reaper_lock);
+  return count;
+}
@@ -0,0 +1,56 @@
+#ifndef REAPER_H
+#define REAPER_H
+
+/**
+ * @file reaper.h
+ * @brief The duties of PID 1: reap the orphans, and take the signals in a thread of their own
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+
+#include <errno.h>
+#include <pthread.h>
+#include <signal.h>
+#include <spawn.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/prctl.h>
+#include <sys/signalfd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+extern char **environ;
+
+/* The children spawned through reaper_spawn() and not yet waited for */
+#define REAPER_OWNED_MAX 64
+/* A blocked reaper_waitpid() checks its child at least this often */
+#define REAPER_POLL_MS 100
+
+struct reaper_child {
+  pid_t pid;      /* 0 for a free slot */
+  int status;
+  int exited;
+};
+
+/**
+ * @note #include <sys/prctl.h>, for PR_SET_CHILD_SUBREAPER
+ * @note #include <sys/signalfd.h>, for signalfd
+ * @note #include <sys/wait.h>, for waitpid
+ * @note #include <spawn.h>, for posix_spawn
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+int reaper_start(const char *thread_name);
+int reaper_active(void);
+void reaper_block_signals(void);
+pid_t reaper_waitpid(pid_t pid, int *status, int options);
+pid_t reaper_spawn(const char *path, const posix_spawn_file_actions_t *actions, posix_spawnattr_t *attr,
+    char *const argv[]);
+unsigned long reaper_orphans(void);
+
+#endif /* REAPER_H */
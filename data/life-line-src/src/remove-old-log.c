@@ -1,5 +1,9 @@
 #include "remove-old-log.h"
+#include "log-archive.h"
+#include "log-binary.h"
+#include "log-level.h"
 #include "log-message.h"
+#include "log-sink.h"
 
 /**
  * @file remove-old-log.c
@@ -48,7 +52,7 @@
 void *thread_remove_old_logs_with_debug(void *arg){
   struct remove_log_args *args = (struct remove_log_args *) arg;
   char* thread_name = "Thread_remove_old_log";
-  debug_log_message_w_thread(args->debug_mode, thread_name, "..Started..");
+  LOG_DEBUG(LOG_MODULE_LOG, args->debug_mode, thread_name, "..Started..");
   while(1) {
     remove_old_logs_with_debug((const char *)args->log, "log", thread_name, args->debug_mode);
     sleep(600);
@@ -59,7 +63,8 @@ void *thread_remove_old_logs_with_debug(void *arg){
  * @brief Removes old log files in the specified directory.
  * 
  * This function scans the specified directory and removes any log files
- * that are more than one week old. The age of each file is determined by
+ * (and their .idx sidecar indexes) that are more than DAYSTODELETEFILES old, and any compressed log archives
+ * that are more than DAYSTODELETEARCHIVES old. The age of each file is determined by
  * its last modification time. If an error occurs while opening the
  * directory or removing a file, an error message will be printed to
  * standard error.
@@ -67,7 +72,6 @@ void *thread_remove_old_logs_with_debug(void *arg){
  * @param dir The path to the directory to scan.
  * 
  * @note #include <stdio.h>, for fprintf, stderr
- * @note #include <stdlib.h>, for malloc, free
  * @note #include <sys/types.h>, for DIR, opendir, readdir, closedir
  * @note #include <sys/stat.h>, for stat
  * @note #include <time.h>, for time, difftime
@@ -84,16 +88,10 @@ void *thread_remove_old_logs_with_debug(void *arg){
  */
 
 void remove_old_logs_with_debug(const char *dir, const char *extension, const char *thread_name, int debug_mode) {
-  char *s = NULL;
-  int len;
   DIR *d = opendir(dir);
   // fprintf(stderr, "Inside remove log: %s\n", dir);
   if (d == NULL) {
-    len = snprintf(NULL, 0, "«%s» Error opening directory: %s",thread_name, dir);
-    s = malloc(len + 1);
-    snprintf(s, len + 1, "«%s» Error opening directory: %s", thread_name, dir);
-    debug_log_message_w_thread(debug_mode, thread_name, s);
-    free(s);
+    LOG_DEBUG(LOG_MODULE_LOG, debug_mode, thread_name, "«%s» Error opening directory: %s", thread_name, dir);
     return;
   }
   time_t now = time(NULL);
@@ -104,7 +102,15 @@ void remove_old_logs_with_debug(const char *dir, const char *extension, const ch
       // fprintf(stderr, "Is File: %s\n", entry->d_name);
       // Check if the file has the desired extension
       char *file_extension = strrchr(entry->d_name, '.');
-      if (file_extension != NULL && strcmp(file_extension, extension) == 0) {
+      double max_age = 0;
+      if (file_extension != NULL && (strcmp(file_extension, extension) == 0 || strcmp(file_extension, LOG_BINARY_EXT) == 0 ||
+          strcmp(file_extension, LOG_SINK_INDEX_EXT) == 0)) {
+        max_age = DAYSTODELETEFILES;
+      } else if (log_archive_is_archive(entry->d_name)) {
+        // Compressed by log_archive_dir(), kept much longer
+        max_age = DAYSTODELETEARCHIVES;
+      }
+      if (max_age > 0) {
         // File has the desired extension
         char path[1024];
         sprintf(path, "%s/%s", dir, entry->d_name);
@@ -112,19 +118,11 @@ void remove_old_logs_with_debug(const char *dir, const char *extension, const ch
         struct stat statbuf;
         if (stat(path, &statbuf) == 0) {
           double age = difftime(now, statbuf.st_mtime);
-          if (age > DAYSTODELETEFILES) {
+          if (age > max_age) {
             if (remove(path) != 0) {
-              len = snprintf(NULL, 0, "Error removing file: %s", path);
-              s = malloc(len + 1);
-              snprintf(s, len + 1, "Error removing file: %s",  path);
-              debug_log_message_w_thread(debug_mode, thread_name, s);
-              free(s);
+              LOG_DEBUG(LOG_MODULE_LOG, debug_mode, thread_name, "Error removing file: %s", path);
             } else {
-              len = snprintf(NULL, 0, "Removing file: %s", path);
-              s = malloc(len + 1);
-              snprintf(s, len + 1, "Removing file: %s",  path);
-              debug_log_message_w_thread(debug_mode, thread_name, s);
-              free(s);            
+              LOG_DEBUG(LOG_MODULE_LOG, debug_mode, thread_name, "Removing file: %s", path);
             }
             // fprintf(stderr, "Old: %s, age: %f\n", dir, age);
           } else {
@@ -20,6 +20,7 @@
 
 #define SECONDSINADAY (24 * 60 * 60)
 #define DAYSTODELETEFILES (30 * SECONDSINADAY)
+#define DAYSTODELETEARCHIVES (365 * SECONDSINADAY)
 
 struct remove_log_args {
     char *log;
@@ -1,4 +1,5 @@
 #include "set-file-permission.h"
+#include "log-level.h"
 #include "log-message.h"
 
 /**
@@ -29,31 +30,19 @@
  * is logged and 1 is returned. Otherwise, a success message is logged and 0 is returned.
  *
  * @note This function requires the following include files:
- * @note #include <stdio.h> // for snprintf, NULL
- * @note #include <stdlib.h> // for malloc, free
  * @note #include <sys/stat.h> // for chmod
  *
- * @see debug_log_message_w_thread() to log debug messages.
+ * @see LOG_DEBUG() to log debug messages, formatted only when enabled.
  *
  * @author Cloudgen Wong
  * @date 2023-06-06
  */
 int setFilePermissions(const char* filename, int permissions, const char* thread_name, int debug_mode) {
   if (chmod(filename, permissions) == -1) {
-    char* log_message;
-    int len = snprintf(NULL, 0, "Set file permissions for %s ..Failed..", filename);
-    log_message = malloc(len + 1);
-    snprintf(log_message, len + 1, "Set file permissions for %s ..Failed..", filename);
-    debug_log_message_w_thread(debug_mode, thread_name, log_message);
-    free(log_message);
+    LOG_DEBUG(LOG_MODULE_PERMISSION, debug_mode, thread_name, "Set file permissions for %s ..Failed..", filename);
     return 1;
   } else {
-    char* log_message;
-    int len = snprintf(NULL, 0, "Set file permissions for %s ..Success..", filename);
-    log_message = malloc(len + 1);
-    snprintf(log_message, len + 1, "Set file permissions for %s ..Success..", filename);
-    debug_log_message_w_thread(debug_mode, thread_name, log_message);
-    free(log_message);
+    LOG_TRACE(LOG_MODULE_PERMISSION, debug_mode, thread_name, "Set file permissions for %s ..Success..", filename);
     return 0;
   }
 }
\ No newline at end of file
@@ -0,0 +1,325 @@
+#include "startup.h"
+#include "log-level.h"
+#include "log-server.h"
+#include "make-directory.h"
+#include "project.h"
+
+/**
+ * @file startup.c
+ * @brief Run the start-up of the daemon as a graph of stages, time it, and tell when it is ready
+ *
+ * startup_run() runs the stages of life_line() each in a thread, as soon as the stages they
+ * come after are done: the tunnel waits for the keys, but not for the copy of a large seed
+ * folder. When the graph is done, startup_ready() writes READY_FILE and, when the daemon was
+ * started by a service manager setting NOTIFY_SOCKET, sends it READY=1, so that a healthcheck
+ * (`test -f /run/life-line/ready`) or an orchestrator can route traffic without guessing.
+ *
+ * Replicas scaled up under load are only useful once life-line has reached its loop, so the
+ * time it takes to get there is logged once at the first tick, step by step. The kernel keeps
+ * the start time of the process in /proc/self/stat in clock ticks since the boot, so the part
+ * before main() (execve(), the dynamic loader) is only known to 1/CLK_TCK s, 10 ms usually, and
+ * rounded down: the report may be up to that much too long. The steps marked with startup_mark()
+ * use CLOCK_BOOTTIME, the same clock, to the microsecond.
+ *
+ * `life-line timing` runs the start-up, prints the report at the first tick and stops.
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+
+static struct startup_step steps[STARTUP_STEPS_MAX];
+static int step_count = 0;
+static int timing = 0;
+static int ticked = 0;
+
+struct startup_graph {
+  const struct startup_stage *stages;
+  int count;
+  unsigned int done;
+  pthread_mutex_t lock;
+  pthread_cond_t cond;
+  const char *thread_name;
+  int debug_mode;
+};
+
+struct startup_worker {
+  struct startup_graph *graph;
+  int index;
+  pthread_t tid;
+};
+
+static double startup_ms(const struct timespec *from, const struct timespec *to) {
+  return (to->tv_sec - from->tv_sec) * 1000.0 + (to->tv_nsec - from->tv_nsec) / 1000000.0;
+}
+
+/* The start of the process, in CLOCK_BOOTTIME, from field 22 of /proc/self/stat */
+static int startup_exec_time(struct timespec *at) {
+  char buf[1024];
+  unsigned long long ticks;
+  long hz = sysconf(_SC_CLK_TCK);
+  FILE *f = fopen("/proc/self/stat", "r");
+  char *p;
+  int field;
+  size_t n;
+  if (f == NULL) {
+    return -1;
+  }
+  n = fread(buf, 1, sizeof(buf) - 1, f);
+  fclose(f);
+  buf[n] = '\0';
+  // The name of the command in field 2 may hold spaces: count from its closing parenthesis
+  p = strrchr(buf, ')');
+  if (p == NULL || hz <= 0) {
+    return -1;
+  }
+  for (field = 2; field < 22 && p != NULL; field++) {
+    p = strchr(p + 1, ' ');
+  }
+  if (p == NULL || sscanf(p + 1, "%llu", &ticks) != 1) {
+    return -1;
+  }
+  at->tv_sec = ticks / hz;
+  at->tv_nsec = (long)((ticks % hz) * (1000000000L / hz));
+  return 0;
+}
+
+/**
+ * @brief Record the end of a step of the start-up.
+ *
+ * @param name A static string naming the step, e.g. "log".
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+void startup_mark(const char *name) {
+  if (step_count < STARTUP_STEPS_MAX) {
+    steps[step_count].name = name;
+    clock_gettime(CLOCK_BOOTTIME, &steps[step_count].at);
+    step_count++;
+  }
+}
+
+/**
+ * @brief Stop the daemon at its first loop tick, after printing the report.
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+void startup_timing(int on) {
+  timing = on;
+}
+
+/**
+ * @brief Format the time from the start of the process to each step marked so far.
+ *
+ * @return The length of the report, as snprintf().
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+int startup_report(char *buf, size_t size) {
+  struct timespec exec_at;
+  const struct timespec *from;
+  size_t len;
+  int i;
+  if (step_count == 0) {
+    return snprintf(buf, size, "not timed");
+  }
+  if (startup_exec_time(&exec_at) == 0) {
+    len = snprintf(buf, size, "%.1f ms (-%.0f ms) from execve to the %s", startup_ms(&exec_at, &steps[step_count - 1].at),
+        1000.0 / sysconf(_SC_CLK_TCK), steps[step_count - 1].name);
+    from = &exec_at;
+  } else {
+    len = snprintf(buf, size, "%.1f ms from main to the %s", startup_ms(&steps[0].at, &steps[step_count - 1].at),
+        steps[step_count - 1].name);
+    from = &steps[0].at;
+  }
+  for (i = 0; i < step_count && len < size; i++) {
+    len += snprintf(buf + len, size - len, "%s%s %.2f ms", i == 0 ? " (" : ", ", steps[i].name,
+        startup_ms(i == 0 ? from : &steps[i - 1].at, &steps[i].at));
+  }
+  if (len < size) {
+    len += snprintf(buf + len, size - len, ")");
+  }
+  return (int)len;
+}
+
+/**
+ * @brief Called at every tick of the loop: logs the start-up at the first one.
+ *
+ * @param thread_name The thread logging the report.
+ *
+ * @return 1 when the loop should stop, in the timing mode of startup_timing().
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+int startup_tick(const char *thread_name) {
+  char report[512];
+  if (ticked) {
+    return 0;
+  }
+  ticked = 1;
+  startup_mark("first tick");
+  startup_report(report, sizeof(report));
+  LOG_INFO(LOG_MODULE_MAIN, thread_name, "Startup: %s", report);
+  if (timing) {
+    printf("Startup: %s\n", report);
+  }
+  return timing;
+}
+
+static void *startup_stage_thread(void *arg) {
+  struct startup_worker *w = arg;
+  struct startup_graph *g = w->graph;
+  const struct startup_stage *stage = &g->stages[w->index];
+  struct timespec start, end;
+  pthread_mutex_lock(&g->lock);
+  while ((g->done & stage->after) != stage->after) {
+    pthread_cond_wait(&g->cond, &g->lock);
+  }
+  pthread_mutex_unlock(&g->lock);
+  clock_gettime(CLOCK_BOOTTIME, &start);
+  stage->run(g->thread_name, g->debug_mode);
+  clock_gettime(CLOCK_BOOTTIME, &end);
+  LOG_DEBUG(LOG_MODULE_MAIN, g->debug_mode, g->thread_name, "Startup stage %s ..Done.. in %.1f ms", stage->name,
+      startup_ms(&start, &end));
+  pthread_mutex_lock(&g->lock);
+  g->done |= STARTUP_AFTER(w->index);
+  pthread_cond_broadcast(&g->cond);
+  pthread_mutex_unlock(&g->lock);
+  return NULL;
+}
+
+/**
+ * @brief Run a graph of stages, each as soon as the stages it comes after are done.
+ *
+ * @param stages The stages; a stage may only come after stages of a lower index.
+ * @param count The number of stages, at most STARTUP_STAGES_MAX.
+ * @param thread_name The name of the thread, passed to the stages.
+ * @param debug_mode The debug mode, passed to the stages.
+ *
+ * @return 0 once every stage is done, -1 for a graph that is not valid.
+ *
+ * @details A stage whose thread cannot be created runs in the calling thread, in the order of
+ * the indexes, which the rule on the dependencies keeps valid.
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+int startup_run(const struct startup_stage *stages, int count, const char *thread_name, int debug_mode) {
+  struct startup_worker workers[STARTUP_STAGES_MAX];
+  struct startup_graph g;
+  int started[STARTUP_STAGES_MAX];
+  int i;
+  if (count <= 0 || count > STARTUP_STAGES_MAX) {
+    return -1;
+  }
+  for (i = 0; i < count; i++) {
+    if (stages[i].after >= STARTUP_AFTER(i)) {
+      LOG_ERROR(LOG_MODULE_MAIN, thread_name, "Startup stage %s comes after a later stage ..Failed..", stages[i].name);
+      return -1;
+    }
+  }
+  g.stages = stages;
+  g.count = count;
+  g.done = 0;
+  g.thread_name = thread_name;
+  g.debug_mode = debug_mode;
+  pthread_mutex_init(&g.lock, NULL);
+  pthread_cond_init(&g.cond, NULL);
+  for (i = 0; i < count; i++) {
+    workers[i].graph = &g;
+    workers[i].index = i;
+    started[i] = pthread_create(&workers[i].tid, NULL, startup_stage_thread, &workers[i]) == 0;
+    if (!started[i]) {
+      startup_stage_thread(&workers[i]);
+    }
+  }
+  for (i = 0; i < count; i++) {
+    if (started[i]) {
+      pthread_join(workers[i].tid, NULL);
+    }
+  }
+  pthread_cond_destroy(&g.cond);
+  pthread_mutex_destroy(&g.lock);
+  return 0;
+}
+
+/* sd_notify(): one datagram to the socket of the service manager; '@' names an abstract one */
+static int startup_notify(const char *socket_path, const char *message) {
+  struct sockaddr_un addr;
+  socklen_t len;
+  size_t path_len = strlen(socket_path);
+  int fd, rc;
+  if (path_len == 0 || path_len >= sizeof(addr.sun_path) || (socket_path[0] != '/' && socket_path[0] != '@')) {
+    errno = EINVAL;
+    return -1;
+  }
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  memcpy(addr.sun_path, socket_path, path_len);
+  if (addr.sun_path[0] == '@') {
+    addr.sun_path[0] = '\0';
+  }
+  len = offsetof(struct sockaddr_un, sun_path) + path_len;
+  fd = socket(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+  if (fd < 0) {
+    return -1;
+  }
+  rc = sendto(fd, message, strlen(message), MSG_NOSIGNAL, (struct sockaddr *)&addr, len) < 0 ? -1 : 0;
+  close(fd);
+  return rc;
+}
+
+/**
+ * @brief Tell that the start-up is done: write READY_FILE, and notify NOTIFY_SOCKET if set.
+ *
+ * @param thread_name The thread logging the readiness.
+ *
+ * @details READY_FILE holds the pid of the daemon, and is written to a temporary file first,
+ * so that a healthcheck never sees it partly written. Only the daemon owning the log socket
+ * writes it (see log_server_owner()): a second life-line, such as `life-line timing`, leaves
+ * the readiness of the running daemon alone.
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+void startup_ready(const char *thread_name) {
+  char message[64];
+  const char *socket_path = getenv("NOTIFY_SOCKET");
+  int fd, len;
+  len = snprintf(message, sizeof(message), "%d\n", (int)getpid());
+  if (!log_server_owner()) {
+    LOG_INFO(LOG_MODULE_MAIN, thread_name, "Startup: " READY_FILE " belongs to another life-line, left alone");
+  } else if (make_directory(RUN_DIR) == 0 && (fd = open(READY_FILE ".tmp", O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644)) >= 0) {
+    if (write(fd, message, len) == len && close(fd) == 0 && rename(READY_FILE ".tmp", READY_FILE) == 0) {
+      LOG_INFO(LOG_MODULE_MAIN, thread_name, "Startup: " READY_FILE " ..Ready..");
+    } else {
+      LOG_ERROR(LOG_MODULE_MAIN, thread_name, "Startup: writing " READY_FILE " ..Failed.. (%s)", strerror(errno));
+      unlink(READY_FILE ".tmp");
+    }
+  } else {
+    LOG_ERROR(LOG_MODULE_MAIN, thread_name, "Startup: creating " READY_FILE " ..Failed.. (%s)", strerror(errno));
+  }
+  if (socket_path != NULL) {
+    snprintf(message, sizeof(message), "READY=1\nMAINPID=%d\n", (int)getpid());
+    if (startup_notify(socket_path, message) != 0) {
+      LOG_WARN(LOG_MODULE_MAIN, thread_name, "Startup: notifying %s ..Failed.. (%s)", socket_path, strerror(errno));
+    }
+  }
+}
+
+/**
+ * @brief Withdraw the readiness, at the start of the daemon and when it stops.
+ *
+ * @details Like startup_ready(), only in the daemon owning the log socket.
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+void startup_not_ready(void) {
+  if (log_server_owner()) {
+    unlink(READY_FILE);
+  }
+}
@@ -0,0 +1,61 @@
+#ifndef STARTUP_H
+#define STARTUP_H
+
+/**
+ * @file startup.h
+ * @brief Run the start-up of the daemon as a graph of stages, time it, and tell when it is ready
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <time.h>
+#include <unistd.h>
+
+/* The steps of the start-up timed at most */
+#define STARTUP_STEPS_MAX 16
+
+struct startup_step {
+  const char *name;
+  struct timespec at;   /* CLOCK_BOOTTIME */
+};
+
+/* The stages of a graph at most, so that their dependencies fit in a bit mask */
+#define STARTUP_STAGES_MAX 16
+#define STARTUP_AFTER(stage) (1u << (stage))
+
+/* A step of life_line(), run in a thread of its own once the stages it comes after are done */
+struct startup_stage {
+  const char *name;
+  void (*run)(const char *thread_name, int debug_mode);
+  unsigned int after;   /* STARTUP_AFTER() of the stages to wait for, by index */
+};
+
+/**
+ * @note #include <time.h>, for clock_gettime, CLOCK_BOOTTIME
+ * @note #include <unistd.h>, for sysconf(_SC_CLK_TCK)
+ * @note #include <pthread.h>, for pthread_create, pthread_cond_wait
+ * @note #include <sys/un.h>, for the NOTIFY_SOCKET of startup_ready()
+ * @note #include <stddef.h>, for offsetof
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+void startup_mark(const char *name);
+void startup_timing(int on);
+int startup_tick(const char *thread_name);
+int startup_report(char *buf, size_t size);
+int startup_run(const struct startup_stage *stages, int count, const char *thread_name, int debug_mode);
+void startup_ready(const char *thread_name);
+void startup_not_ready(void);
+
+#endif /* STARTUP_H */
@@ -0,0 +1,476 @@
+/* splice(), tee(), F_SETPIPE_SZ, strchrnul() */
+#define _GNU_SOURCE
+#include "supervise.h"
+#include "io-policy.h"
+#include "log-level.h"
+#include "log-sink.h"
+#include "make-directory.h"
+#include "project.h"
+#include "reaper.h"
+#include "wait-ms.h"
+
+/**
+ * @file supervise.c
+ * @brief Run the application of the container as a supervised child of life-line
+ *
+ * `life-line run command [args...]` starts the command in its own process group with its
+ * stdout and stderr on two pipes, and keeps it running as LL_RUN_RESTART asks: never,
+ * on-failure (the default: after a non-zero exit status or a signal) or always. A restart
+ * waits SUPERVISE_BACKOFF_MIN_MS, doubled after every failed run up to
+ * SUPERVISE_BACKOFF_MAX_MS, and a run of SUPERVISE_STABLE_SECONDS resets the delay. When the
+ * command fails LL_RUN_CRASH_LOOP times (RUNS/SECONDS, 5/300 by default, 0 to disable) within
+ * the window, it is in a crash loop: the restarts stop and the container stays up for a look.
+ *
+ * The output is moved from the pipes into DATA_LOG/app/app-YYYY-MM-DD-stdout.log and
+ * -stderr.log with splice(), without a copy through user space, and the files are rotated like
+ * the log sink's: by day and by LL_LOG_MAX_SIZE. When the stream of life-line itself is a pipe,
+ * e.g. the one read by `docker logs`, the output is first duplicated into it with tee(). The
+ * app is the basename of the command, or LL_RUN_APP.
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+
+static const char *supervise_thread_name = "Thread_supervise";
+static char *const *command = NULL;
+static char app[LOG_SINK_APP_MAX];
+static enum supervise_restart restart = SUPERVISE_RESTART_ON_FAILURE;
+static int crash_loop_runs = SUPERVISE_CRASH_LOOP_RUNS;
+static int crash_loop_seconds = SUPERVISE_CRASH_LOOP_SECONDS;
+static struct supervise_stream streams[2];
+static int active = 0;
+static int stopping = 0;
+static int running = 0;
+static pid_t child = 0;
+static unsigned int starts = 0;
+static char last_exit[64] = "none";
+
+static void supervise_init_from_env(void) {
+  const char *value = getenv("LL_RUN_RESTART");
+  if (value != NULL && strcmp(value, "never") == 0) {
+    restart = SUPERVISE_RESTART_NEVER;
+  } else if (value != NULL && strcmp(value, "always") == 0) {
+    restart = SUPERVISE_RESTART_ALWAYS;
+  }
+  value = getenv("LL_RUN_CRASH_LOOP");
+  if (value != NULL && sscanf(value, "%d/%d", &crash_loop_runs, &crash_loop_seconds) < 1) {
+    crash_loop_runs = SUPERVISE_CRASH_LOOP_RUNS;
+  }
+  if (crash_loop_runs > SUPERVISE_CRASH_LOOP_RUNS_MAX) {
+    crash_loop_runs = SUPERVISE_CRASH_LOOP_RUNS_MAX;
+  }
+  value = getenv("LL_RUN_APP");
+  if (value == NULL || *value == 0 || strlen(value) >= sizeof(app)) {
+    value = strrchr(command[0], '/') != NULL ? strrchr(command[0], '/') + 1 : command[0];
+  }
+  snprintf(app, sizeof(app), "%s", value);
+}
+
+static void supervise_path(struct supervise_stream *s, const char *log_dir, int segment) {
+  if (segment == 0) {
+    snprintf(s->path, sizeof(s->path), "%s/%s-%s-%s.log", log_dir, app, s->date, s->name);
+  } else {
+    snprintf(s->path, sizeof(s->path), "%s/%s-%s-%s-%d.log", log_dir, app, s->date, s->name, segment);
+  }
+}
+
+/*
+ * Open the log file of a stream for s->date, continuing the last segment of the day when
+ * segment is -1. The file is not opened with O_APPEND, which splice() refuses: the writes go
+ * to explicit offsets from the end of the file.
+ */
+static int supervise_open(struct supervise_stream *s, int segment) {
+  char log_dir[sizeof(DATA_LOG) + LOG_SINK_APP_MAX];
+  struct stat st;
+  snprintf(log_dir, sizeof(log_dir), "%s%s", DATA_LOG, app);
+  if (s->fd >= 0) {
+    close(s->fd);
+    s->fd = -1;
+  }
+  if (segment < 0) {
+    segment = 0;
+    while (log_sink_segment_size() > 0 && segment < LOG_SINK_SEGMENTS_MAX) {
+      supervise_path(s, log_dir, segment + 1);
+      if (stat(s->path, &st) != 0) {
+        break;
+      }
+      segment++;
+    }
+  }
+  supervise_path(s, log_dir, segment);
+  s->fd = open(s->path, O_WRONLY | O_CREAT | O_CLOEXEC, 0644);
+  if (s->fd < 0 && errno == ENOENT) {
+    make_directory(log_dir);
+    s->fd = open(s->path, O_WRONLY | O_CREAT | O_CLOEXEC, 0644);
+  }
+  if (s->fd < 0) {
+    LOG_ERROR(LOG_MODULE_MAIN, supervise_thread_name, "Opening %s ..Failed.. (%s)", s->path, strerror(errno));
+    return -1;
+  }
+  s->segment = segment;
+  s->size = fstat(s->fd, &st) == 0 ? st.st_size : 0;
+  return 0;
+}
+
+/* Move to the file of the day, or to the next segment once the current one is full */
+static int supervise_rotate(struct supervise_stream *s) {
+  time_t now = time(NULL);
+  off_t segment_size = log_sink_segment_size();
+  if (s->fd >= 0 && now == s->checked && (segment_size == 0 || s->size < segment_size)) {
+    return 0;
+  }
+  if (s->fd < 0 || now != s->checked) {
+    char date[sizeof(s->date)];
+    struct tm tm;
+    s->checked = now;
+    localtime_r(&now, &tm);
+    strftime(date, sizeof(date), "%Y-%m-%d", &tm);
+    if (s->fd < 0 || strcmp(date, s->date) != 0) {
+      memcpy(s->date, date, sizeof(s->date));
+      return supervise_open(s, -1);
+    }
+  }
+  if (segment_size > 0 && s->size >= segment_size && s->segment < LOG_SINK_SEGMENTS_MAX) {
+    return supervise_open(s, s->segment + 1);
+  }
+  return 0;
+}
+
+/*
+ * Move what is waiting in the pipe of a stream into its log file. Returns the bytes moved, 0
+ * at the end of the stream, or -1 when nothing could be moved now.
+ */
+static ssize_t supervise_splice(struct supervise_stream *s) {
+  ssize_t n;
+  if (s->console >= 0 && tee(s->pipe, s->console, SUPERVISE_SPLICE_MAX, SPLICE_F_NONBLOCK) < 0 &&
+      errno != EAGAIN) {
+    // The console is gone: keep the output for the log file only
+    s->console = -1;
+  }
+  if (supervise_rotate(s) != 0) {
+    char discard[4096];
+    // Keep the application going even without a log file
+    return read(s->pipe, discard, sizeof(discard));
+  }
+  if (!s->copy) {
+    loff_t off = s->size;
+    n = splice(s->pipe, NULL, s->fd, &off, SUPERVISE_SPLICE_MAX, SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+    if (n < 0 && errno == EINVAL) {
+      LOG_WARN(LOG_MODULE_MAIN, supervise_thread_name, "splice() into %s is not supported, copying instead", s->path);
+      s->copy = 1;
+    }
+  }
+  if (s->copy) {
+    char buf[65536];
+    n = read(s->pipe, buf, sizeof(buf));
+    if (n > 0 && pwrite(s->fd, buf, n, s->size) != n) {
+      n = -1;
+    }
+  }
+  if (n < 0 && errno != EAGAIN) {
+    char discard[65536];
+    if (!s->failing) {
+      LOG_ERROR(LOG_MODULE_MAIN, supervise_thread_name, "Writing %s ..Failed.. (%s)", s->path, strerror(errno));
+    }
+    s->failing = 1;
+    // Drop the output rather than block the application on a full pipe
+    return read(s->pipe, discard, sizeof(discard));
+  }
+  if (n > 0) {
+    time_t now = time(NULL);
+    s->failing = 0;
+    s->size += n;
+    s->bytes += n;
+    io_policy_written(IO_PATH_SINK, n);
+    if (now - s->written_back >= 60) {
+      s->written_back = now;
+      io_policy_writeback(IO_PATH_SINK, s->fd);
+    }
+  }
+  return n;
+}
+
+/* The program of the command: command[0] when it holds a slash, otherwise found in PATH as execvp() would */
+static const char *supervise_program(char *path, size_t size) {
+  const char *dirs = getenv("PATH");
+  const char *p;
+  if (strchr(command[0], '/') != NULL) {
+    return command[0];
+  }
+  for (p = dirs != NULL ? dirs : "/usr/local/bin:/bin:/usr/bin";; p++) {
+    const char *end = strchrnul(p, ':');
+    int len = end - p;
+    if (snprintf(path, size, "%.*s%s%s", len, p, len > 0 ? "/" : "", command[0]) < (int)size &&
+        access(path, X_OK) == 0) {
+      return path;
+    }
+    if (*end == 0) {
+      return command[0];
+    }
+    p = end;
+  }
+}
+
+/*
+ * Start the command with its stdout and stderr on the pipes of the streams. posix_spawn() runs
+ * nothing of life-line in the child, unlike fork() from a daemon with threads holding locks; a
+ * command that cannot be run fails here, with errno set.
+ */
+static pid_t supervise_spawn(void) {
+  posix_spawn_file_actions_t actions;
+  posix_spawnattr_t attr;
+  char path[PATH_MAX];
+  sigset_t defaults;
+  int fds[2][2];
+  pid_t pid;
+  int i, err;
+  for (i = 0; i < 2; i++) {
+    if (pipe2(fds[i], O_CLOEXEC) != 0) {
+      if (i == 1) {
+        close(fds[0][0]);
+        close(fds[0][1]);
+      }
+      return -1;
+    }
+    fcntl(fds[i][0], F_SETPIPE_SZ, SUPERVISE_PIPE_SIZE);
+  }
+  posix_spawn_file_actions_init(&actions);
+  posix_spawn_file_actions_adddup2(&actions, fds[0][1], STDOUT_FILENO);
+  posix_spawn_file_actions_adddup2(&actions, fds[1][1], STDERR_FILENO);
+  posix_spawnattr_init(&attr);
+  posix_spawnattr_setpgroup(&attr, 0);
+  sigemptyset(&defaults);
+  sigaddset(&defaults, SIGPIPE);
+  posix_spawnattr_setsigdefault(&attr, &defaults);
+  posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETPGROUP | POSIX_SPAWN_SETSIGDEF);
+  pid = reaper_spawn(supervise_program(path, sizeof(path)), &actions, &attr, command);
+  err = errno;
+  posix_spawnattr_destroy(&attr);
+  posix_spawn_file_actions_destroy(&actions);
+  for (i = 0; i < 2; i++) {
+    close(fds[i][1]);
+    if (pid < 0) {
+      close(fds[i][0]);
+    } else {
+      fcntl(fds[i][0], F_SETFL, O_NONBLOCK);
+      streams[i].pipe = fds[i][0];
+    }
+  }
+  errno = err;
+  return pid;
+}
+
+/*
+ * Log the output of a run until the command has exited and its pipes are closed, or until
+ * SUPERVISE_LINGER_MS after the exit when background processes keep them open.
+ */
+static int supervise_wait(pid_t pid) {
+  struct timespec exited = {0, 0};
+  int status = 0;
+  int i;
+  while (streams[0].pipe >= 0 || streams[1].pipe >= 0 || pid > 0) {
+    struct pollfd pfd[2];
+    for (i = 0; i < 2; i++) {
+      pfd[i].fd = streams[i].pipe;
+      pfd[i].events = POLLIN;
+      pfd[i].revents = 0;
+    }
+    if (poll(pfd, 2, pid > 0 ? 1000 : 100) > 0) {
+      for (i = 0; i < 2; i++) {
+        if (pfd[i].revents != 0 && supervise_splice(&streams[i]) == 0) {
+          close(streams[i].pipe);
+          streams[i].pipe = -1;
+        }
+      }
+    }
+    // With both pipes closed there is only the exit to wait for
+    if (pid > 0 && reaper_waitpid(pid, &status, streams[0].pipe < 0 && streams[1].pipe < 0 ? 0 : WNOHANG) == pid) {
+      pid = 0;
+      __atomic_store_n(&child, 0, __ATOMIC_RELEASE);
+      clock_gettime(CLOCK_MONOTONIC, &exited);
+    } else if (pid == 0) {
+      struct timespec now;
+      clock_gettime(CLOCK_MONOTONIC, &now);
+      if ((now.tv_sec - exited.tv_sec) * 1000 + (now.tv_nsec - exited.tv_nsec) / 1000000 >= SUPERVISE_LINGER_MS) {
+        for (i = 0; i < 2; i++) {
+          if (streams[i].pipe >= 0) {
+            close(streams[i].pipe);
+            streams[i].pipe = -1;
+          }
+        }
+      }
+    }
+  }
+  return status;
+}
+
+static void *supervise_thread(void *arg) {
+  time_t failures[SUPERVISE_CRASH_LOOP_RUNS_MAX];
+  int failed_runs = 0;
+  int backoff = SUPERVISE_BACKOFF_MIN_MS;
+  (void)arg;
+  while (!__atomic_load_n(&stopping, __ATOMIC_ACQUIRE)) {
+    time_t started = time(NULL);
+    int status;
+    int failed;
+    int slept;
+    pid_t pid = supervise_spawn();
+    if (pid < 0) {
+      LOG_ERROR(LOG_MODULE_MAIN, supervise_thread_name, "Starting %s ..Failed.. (%s)", command[0], strerror(errno));
+      status = 127 << 8;
+    } else {
+      __atomic_store_n(&child, pid, __ATOMIC_RELEASE);
+      starts++;
+      LOG_INFO(LOG_MODULE_MAIN, supervise_thread_name, "Supervised %s ..Started.. (pid %d, run %u)", app, pid, starts);
+      status = supervise_wait(pid);
+    }
+    if (WIFSIGNALED(status)) {
+      snprintf(last_exit, sizeof(last_exit), "signal %d (%s)", WTERMSIG(status), strsignal(WTERMSIG(status)));
+    } else {
+      snprintf(last_exit, sizeof(last_exit), "exit status %d", WEXITSTATUS(status));
+    }
+    failed = !WIFEXITED(status) || WEXITSTATUS(status) != 0;
+    if (__atomic_load_n(&stopping, __ATOMIC_ACQUIRE)) {
+      LOG_INFO(LOG_MODULE_MAIN, supervise_thread_name, "Supervised %s ..Stopped.. (%s)", app, last_exit);
+      break;
+    }
+    if (failed) {
+      LOG_ERROR(LOG_MODULE_MAIN, supervise_thread_name, "Supervised %s ended after %ld s (%s)", app,
+        (long)(time(NULL) - started), last_exit);
+    } else {
+      LOG_INFO(LOG_MODULE_MAIN, supervise_thread_name, "Supervised %s ended after %ld s (%s)", app,
+        (long)(time(NULL) - started), last_exit);
+    }
+    if (restart == SUPERVISE_RESTART_NEVER || (restart == SUPERVISE_RESTART_ON_FAILURE && !failed)) {
+      break;
+    }
+    if (time(NULL) - started >= SUPERVISE_STABLE_SECONDS) {
+      backoff = SUPERVISE_BACKOFF_MIN_MS;
+      failed_runs = 0;
+    }
+    if (failed && crash_loop_runs > 0) {
+      // failures[] holds the end times of the last crash_loop_runs failed runs
+      failures[failed_runs++ % crash_loop_runs] = time(NULL);
+      if (failed_runs >= crash_loop_runs &&
+          time(NULL) - failures[failed_runs % crash_loop_runs] <= crash_loop_seconds) {
+        LOG_ERROR(LOG_MODULE_MAIN, supervise_thread_name,
+          "Supervised %s is in a crash loop: %d failed runs within %d s, restarts ..Stopped..", app,
+          crash_loop_runs, crash_loop_seconds);
+        break;
+      }
+    }
+    LOG_WARN(LOG_MODULE_MAIN, supervise_thread_name, "Restarting %s in %d ms", app, backoff);
+    for (slept = 0; slept < backoff && !__atomic_load_n(&stopping, __ATOMIC_ACQUIRE); slept += 100) {
+      sleep_ms(100);
+    }
+    backoff = backoff * 2 < SUPERVISE_BACKOFF_MAX_MS ? backoff * 2 : SUPERVISE_BACKOFF_MAX_MS;
+  }
+  __atomic_store_n(&running, 0, __ATOMIC_RELEASE);
+  return NULL;
+}
+
+/**
+ * @brief Start running a command under supervision, with its output in the log files.
+ *
+ * @param argv The command and its arguments, NULL terminated; kept until the end.
+ * @param thread_name The thread logging the start.
+ *
+ * @return 0 when the supervisor thread is running, -1 otherwise.
+ *
+ * @note #include <pthread.h>, for pthread_create
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+int supervise_start(char *const argv[], const char *thread_name) {
+  pthread_t tid;
+  int i;
+  if (argv == NULL || argv[0] == NULL || active) {
+    return -1;
+  }
+  command = argv;
+  supervise_init_from_env();
+  for (i = 0; i < 2; i++) {
+    struct stat st;
+    int console = i == 0 ? STDOUT_FILENO : STDERR_FILENO;
+    streams[i].name = i == 0 ? "stdout" : "stderr";
+    streams[i].pipe = -1;
+    streams[i].fd = -1;
+    streams[i].console = fstat(console, &st) == 0 && S_ISFIFO(st.st_mode) ? console : -1;
+  }
+  running = 1;
+  if (pthread_create(&tid, NULL, supervise_thread, NULL) != 0) {
+    running = 0;
+    LOG_ERROR(LOG_MODULE_MAIN, thread_name, "Supervising %s ..Failed..", command[0]);
+    return -1;
+  }
+  pthread_detach(tid);
+  active = 1;
+  return 0;
+}
+
+/**
+ * @brief Tell whether a command is supervised.
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+int supervise_active(void) {
+  return active;
+}
+
+/**
+ * @brief Stop the supervised command on exit, and log the rest of its output.
+ *
+ * @details The process group of the command gets SIGTERM, then SIGKILL when it is still
+ * running after SUPERVISE_STOP_TIMEOUT_MS.
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+void supervise_stop(void) {
+  pid_t pid;
+  int waited;
+  if (!active) {
+    return;
+  }
+  __atomic_store_n(&stopping, 1, __ATOMIC_RELEASE);
+  pid = __atomic_load_n(&child, __ATOMIC_ACQUIRE);
+  if (pid > 0) {
+    kill(-pid, SIGTERM);
+  }
+  for (waited = 0; __atomic_load_n(&running, __ATOMIC_ACQUIRE) && waited < SUPERVISE_STOP_TIMEOUT_MS; waited += 50) {
+    sleep_ms(50);
+  }
+  pid = __atomic_load_n(&child, __ATOMIC_ACQUIRE);
+  if (pid > 0) {
+    kill(-pid, SIGKILL);
+    for (waited = 0; __atomic_load_n(&running, __ATOMIC_ACQUIRE) && waited < SUPERVISE_LINGER_MS + 1000; waited += 50) {
+      sleep_ms(50);
+    }
+  }
+}
+
+/**
+ * @brief Describe the supervised command.
+ *
+ * @param buf Receives e.g. "myapp: running as pid 42, 3 runs, last exit signal 9 (Killed), 120 KB
+ * stdout, 4 KB stderr".
+ * @param size The size of buf.
+ *
+ * @return The length of the text, as snprintf().
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+int supervise_report(char *buf, size_t size) {
+  pid_t pid = __atomic_load_n(&child, __ATOMIC_ACQUIRE);
+  char state[32];
+  if (pid > 0) {
+    snprintf(state, sizeof(state), "running as pid %d", pid);
+  } else {
+    snprintf(state, sizeof(state), "%s", __atomic_load_n(&running, __ATOMIC_ACQUIRE) ? "restarting" : "not running");
+  }
+  return snprintf(buf, size, "%s: %s, %u runs, last exit %s, %llu KB stdout, %llu KB stderr", app, state, starts,
+    last_exit, streams[0].bytes / 1024, streams[1].bytes / 1024);
+}
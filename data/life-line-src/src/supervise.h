@@ -0,0 +1,81 @@
+#ifndef SUPERVISE_H
+#define SUPERVISE_H
+
+/**
+ * @file supervise.h
+ * @brief Run the application of the container as a supervised child of life-line
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <spawn.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+/* The delay before a restart, doubled after every failed run */
+#define SUPERVISE_BACKOFF_MIN_MS 1000
+#define SUPERVISE_BACKOFF_MAX_MS 60000
+/* A run lasting this long resets the delay */
+#define SUPERVISE_STABLE_SECONDS 60
+/* This many failed runs within the window is a crash loop, and stops the restarts */
+#define SUPERVISE_CRASH_LOOP_RUNS 5
+#define SUPERVISE_CRASH_LOOP_SECONDS 300
+#define SUPERVISE_CRASH_LOOP_RUNS_MAX 64
+/* On exit, the application gets SIGTERM, then SIGKILL after this delay */
+#define SUPERVISE_STOP_TIMEOUT_MS 10000
+/* Output left in the pipes by background processes is waited for this long after the exit */
+#define SUPERVISE_LINGER_MS 2000
+#define SUPERVISE_PIPE_SIZE (1024 * 1024)
+#define SUPERVISE_SPLICE_MAX (1024 * 1024)
+
+enum supervise_restart {
+  SUPERVISE_RESTART_NEVER,
+  SUPERVISE_RESTART_ON_FAILURE,   /* after a non-zero exit status or a signal */
+  SUPERVISE_RESTART_ALWAYS
+};
+
+/* stdout or stderr of the application, spliced into DATA_LOG/app/app-YYYY-MM-DD-NAME.log */
+struct supervise_stream {
+  const char *name;
+  int pipe;             /* the read end, -1 once closed */
+  int console;          /* the same stream of life-line, duplicated with tee() if a pipe, else -1 */
+  int fd;               /* the log file, -1 until the first output */
+  char date[11];
+  int segment;          /* 0 for the first file of the day, N for the -N suffix */
+  off_t size;
+  time_t checked;       /* the second the date was last checked */
+  time_t written_back;  /* see io_policy_writeback() */
+  int copy;             /* the file system refused splice(): read() and write() instead */
+  int failing;          /* the last write failed; logged once until one succeeds */
+  unsigned long long bytes;
+  char path[PATH_MAX];
+};
+
+/**
+ * @note #include <fcntl.h>, for splice, tee, F_SETPIPE_SZ
+ * @note #include <poll.h>, for poll
+ * @note #include <spawn.h>, for posix_spawn
+ * @note #include <sys/wait.h>, for waitpid
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+int supervise_start(char *const argv[], const char *thread_name);
+int supervise_active(void);
+void supervise_stop(void);
+int supervise_report(char *buf, size_t size);
+
+#endif /* SUPERVISE_H */
@@ -1,4 +1,5 @@
 #include "copy-folder.h"
+#include "log-level.h"
 #include "log-message.h"
 #include "project.h"
 #include "sync-data-folder.h"
@@ -70,8 +71,8 @@ bool folderExists(const char* folderPath) {
  *
  * @see folderExists() to check if a folder exists.
  * @see copyFolder() to copy a folder from the source to the destination.
- * @see debug_log_message_w_thread() to log debug messages with thread name.
- * @see log_message_w_thread() to write log messages with thread name.
+ * @see LOG_DEBUG() to log debug messages with thread name.
+ * @see LOG_INFO() to write log messages with thread name.
  *
  * @author Cloudgen Wong
  * @date 2023-06-06
@@ -79,12 +80,10 @@ bool folderExists(const char* folderPath) {
 int sync_data_folder(const char* thread_name, int debug_mode) {
   DIR* dir;
   struct dirent* entry;
-  int len;
-  char *s;
   // Open the root data folder
   dir = opendir(ROOT_DATA);
   if (!dir) {
-    debug_log_message_w_thread(debug_mode, thread_name, "Open root data folder: " ROOT_DATA " ..Failed..");
+    LOG_DEBUG(LOG_MODULE_COPY, debug_mode, thread_name, "Open root data folder: " ROOT_DATA " ..Failed..");
     return 1;
   } 
   int folder_copied = 0;
@@ -105,23 +104,15 @@ int sync_data_folder(const char* thread_name, int debug_mode) {
     // Copy the subfolder if it doesn't exist in the destination
     if (!folderExists(destinationFolder)) {
       copyFolder(sourceFolder, destinationFolder, thread_name, debug_mode);
-      len = snprintf(NULL, 0, "Folder copied: from %s to %s ..Success..", sourceFolder, destinationFolder);
-      s = malloc(len + 1);
-      snprintf(s, len + 1, "Folder copied: from %s to %s ..Success..", sourceFolder, destinationFolder);
-      debug_log_message_w_thread(debug_mode, thread_name, s);
+      LOG_DEBUG(LOG_MODULE_COPY, debug_mode, thread_name, "Folder copied: from %s to %s ..Success..", sourceFolder, destinationFolder);
       folder_copied = 1;
-      free(s);
     } else {
-      len = snprintf(NULL, 0, "Destination folder: %s ..Exists..", destinationFolder);
-      s = malloc(len + 1);
-      snprintf(s, len + 1, "Destination folder: %s ..Exists..", destinationFolder);
-      debug_log_message_w_thread(debug_mode, thread_name, s);
-      free(s);
+      LOG_TRACE(LOG_MODULE_COPY, debug_mode, thread_name, "Destination folder: %s ..Exists..", destinationFolder);
     }
   }
   closedir(dir);
   if (folder_copied ) {
-    log_message_w_thread(thread_name,"Data folder synchronized.");
+    LOG_INFO(LOG_MODULE_COPY, thread_name, "Data folder synchronized.");
   }
   return 0;
 }
\ No newline at end of file
@@ -0,0 +1,264 @@
+/* pipe2() */
+#define _GNU_SOURCE
+#include "task.h"
+#include "log-level.h"
+#include "reaper.h"
+
+/**
+ * @file task.c
+ * @brief Run a hook without a shell, with a deadline, and its output in the log
+ *
+ * The tunnel scripts and fix-docroot used to run through system(): a /bin/sh for every call,
+ * their output mixed into the console, no limit on how long they could block the loop of
+ * life_line(), and the exit status thrown away.
+ *
+ * task_run() spawns the program itself with posix_spawn() in a process group of its own, reads
+ * its stdout and stderr through pipes and logs them line by line, INFO and WARN respectively.
+ * At the deadline the group gets SIGTERM, then SIGKILL after TASK_KILL_GRACE_MS. The exit
+ * status is logged, and returned.
+ *
+ * A hook leaving a process in the background, like `ssh -f`, should redirect its output: the
+ * pipes are closed TASK_LINGER_MS after the exit of the hook, and the next write of such a
+ * process gets SIGPIPE.
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+
+static long long task_now_ms(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static int task_timeout_ms(const struct task *t) {
+  const char *env;
+  if (t->timeout_ms > 0) {
+    return t->timeout_ms;
+  }
+  env = getenv("LL_TASK_TIMEOUT");
+  if (env != NULL && atoi(env) > 0) {
+    return atoi(env) * 1000;
+  }
+  return TASK_TIMEOUT_MS;
+}
+
+static void task_flush_line(const struct task *t, struct task_stream *s) {
+  if (s->len == 0) {
+    return;
+  }
+  s->line[s->len] = '\0';
+  LOG_AT(t->module, s->level, 0, t->thread_name, "%s: %s", t->name, s->line);
+  s->len = 0;
+}
+
+/**
+ * @brief Log the complete lines available on a stream of task_start(); the rest waits.
+ *
+ * @details The stream is closed at EOF, after logging its last line.
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+void task_stream_read(const struct task *t, struct task_stream *s) {
+  char buf[4096];
+  ssize_t n, i;
+  for (;;) {
+    n = read(s->fd, buf, sizeof(buf));
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n < 0 && errno == EAGAIN) {
+      return;
+    }
+    if (n <= 0) {
+      task_flush_line(t, s);
+      close(s->fd);
+      s->fd = -1;
+      return;
+    }
+    for (i = 0; i < n; i++) {
+      if (buf[i] == '\n') {
+        task_flush_line(t, s);
+      } else if (buf[i] != '\r') {
+        s->line[s->len++] = buf[i];
+        if (s->len == TASK_LINE_MAX - 1) {
+          task_flush_line(t, s);
+        }
+      }
+    }
+  }
+}
+
+/**
+ * @brief Log the last line of a stream of task_start() and close it.
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+void task_stream_close(const struct task *t, struct task_stream *s) {
+  if (s->fd >= 0) {
+    task_flush_line(t, s);
+    close(s->fd);
+    s->fd = -1;
+  }
+}
+
+/**
+ * @brief Spawn a program in a process group of its own, its stdout and stderr in pipes.
+ *
+ * @param t The program.
+ * @param out Receives the read end of stdout, logged at INFO by task_stream_read().
+ * @param err Receives the read end of stderr, logged at WARN.
+ *
+ * @return The pid of the program, to wait for with reaper_waitpid(), or -1 with errno set.
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+pid_t task_start(const struct task *t, struct task_stream *out, struct task_stream *err) {
+  posix_spawn_file_actions_t actions;
+  posix_spawnattr_t attr;
+  sigset_t defaults;
+  int po[2], pe[2];
+  pid_t pid;
+  if (pipe2(po, O_CLOEXEC) != 0) {
+    return -1;
+  }
+  if (pipe2(pe, O_CLOEXEC) != 0) {
+    close(po[0]);
+    close(po[1]);
+    return -1;
+  }
+  posix_spawn_file_actions_init(&actions);
+  posix_spawn_file_actions_addopen(&actions, STDIN_FILENO, "/dev/null", O_RDONLY, 0);
+  posix_spawn_file_actions_adddup2(&actions, po[1], STDOUT_FILENO);
+  posix_spawn_file_actions_adddup2(&actions, pe[1], STDERR_FILENO);
+  posix_spawnattr_init(&attr);
+  // A group of its own, so that the children of a script are killed with it
+  posix_spawnattr_setpgroup(&attr, 0);
+  sigemptyset(&defaults);
+  sigaddset(&defaults, SIGPIPE);
+  posix_spawnattr_setsigdefault(&attr, &defaults);
+  posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETPGROUP | POSIX_SPAWN_SETSIGDEF);
+  pid = reaper_spawn(t->argv[0], &actions, &attr, t->argv);
+  posix_spawnattr_destroy(&attr);
+  posix_spawn_file_actions_destroy(&actions);
+  close(po[1]);
+  close(pe[1]);
+  if (pid < 0) {
+    close(po[0]);
+    close(pe[0]);
+    return -1;
+  }
+  fcntl(po[0], F_SETFL, fcntl(po[0], F_GETFL) | O_NONBLOCK);
+  fcntl(pe[0], F_SETFL, fcntl(pe[0], F_GETFL) | O_NONBLOCK);
+  out->fd = po[0];
+  out->level = LOG_LEVEL_INFO;
+  out->len = 0;
+  err->fd = pe[0];
+  err->level = LOG_LEVEL_WARN;
+  err->len = 0;
+  return pid;
+}
+
+static void task_report(const struct task *t, const struct task_result *r) {
+  if (r->timed_out) {
+    LOG_ERROR(t->module, t->thread_name, "%s: Timeout ..Killed.. after %.1fs", t->name, r->seconds);
+  } else if (WIFEXITED(r->status) && WEXITSTATUS(r->status) == 0) {
+    LOG_INFO(t->module, t->thread_name, "%s: Exited with status 0 in %.1fs", t->name, r->seconds);
+  } else if (WIFEXITED(r->status)) {
+    LOG_WARN(t->module, t->thread_name, "%s: Exited with status %d in %.1fs", t->name,
+        WEXITSTATUS(r->status), r->seconds);
+  } else {
+    LOG_WARN(t->module, t->thread_name, "%s: Killed by signal %d in %.1fs", t->name,
+        WTERMSIG(r->status), r->seconds);
+  }
+}
+
+/**
+ * @brief Run a program without a shell, logging its output and exit status.
+ *
+ * @param t The program, its arguments and where to log.
+ * @param result Receives the exit status, if not NULL.
+ *
+ * @return The exit code of the program, 128 + the signal that killed it, or -1 if it did not
+ * start.
+ *
+ * @details The calling thread waits for the program, at most until its deadline and the grace
+ * period of SIGKILL. stdin of the program is /dev/null.
+ *
+ * @see reaper_spawn()
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+int task_run(const struct task *t, struct task_result *result) {
+  struct task_stream out = { -1, LOG_LEVEL_INFO, 0, "" };
+  struct task_stream err = { -1, LOG_LEVEL_WARN, 0, "" };
+  struct task_result r = { -1, 0, 0 };
+  struct pollfd fds[2];
+  long long start, deadline, exited_at = 0, now;
+  int killed = 0, exited = 0, nfds;
+  pid_t pid;
+
+  start = task_now_ms();
+  deadline = start + task_timeout_ms(t);
+  pid = task_start(t, &out, &err);
+  if (pid < 0) {
+    LOG_ERROR(t->module, t->thread_name, "%s: Starting ..Failed.. (%s)", t->name, strerror(errno));
+    if (result != NULL) {
+      *result = r;
+    }
+    return -1;
+  }
+  for (;;) {
+    nfds = 0;
+    if (out.fd >= 0) {
+      fds[nfds].fd = out.fd;
+      fds[nfds++].events = POLLIN;
+    }
+    if (err.fd >= 0) {
+      fds[nfds].fd = err.fd;
+      fds[nfds++].events = POLLIN;
+    }
+    if (exited && (nfds == 0 || task_now_ms() >= exited_at + TASK_LINGER_MS)) {
+      break;
+    }
+    // Both pipes at EOF: the exit is a matter of moments
+    if (poll(fds, nfds, nfds > 0 ? TASK_POLL_MS : TASK_POLL_MS / 10) > 0) {
+      if (out.fd >= 0) {
+        task_stream_read(t, &out);
+      }
+      if (err.fd >= 0) {
+        task_stream_read(t, &err);
+      }
+    }
+    now = task_now_ms();
+    if (!exited && reaper_waitpid(pid, &r.status, WNOHANG) == pid) {
+      exited = 1;
+      exited_at = now;
+      r.seconds = (now - start) / 1000.0;
+      continue;
+    }
+    if (!exited && killed == 0 && now >= deadline) {
+      kill(-pid, SIGTERM);
+      killed = 1;
+      r.timed_out = 1;
+      deadline = now + TASK_KILL_GRACE_MS;
+    } else if (!exited && killed == 1 && now >= deadline) {
+      kill(-pid, SIGKILL);
+      killed = 2;
+    }
+  }
+  task_stream_close(t, &out);
+  task_stream_close(t, &err);
+  task_report(t, &r);
+  if (result != NULL) {
+    *result = r;
+  }
+  if (WIFEXITED(r.status)) {
+    return WEXITSTATUS(r.status);
+  }
+  return 128 + WTERMSIG(r.status);
+}
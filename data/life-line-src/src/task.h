@@ -0,0 +1,70 @@
+#ifndef TASK_H
+#define TASK_H
+
+/**
+ * @file task.h
+ * @brief Run a hook without a shell, with a deadline, and its output in the log
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <spawn.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+/* A hook still running after this long gets SIGTERM; LL_TASK_TIMEOUT sets it in seconds */
+#define TASK_TIMEOUT_MS 60000
+/* then SIGKILL after this delay */
+#define TASK_KILL_GRACE_MS 2000
+/* Output left in the pipes by background processes is waited for this long after the exit */
+#define TASK_LINGER_MS 200
+#define TASK_POLL_MS 100
+/* A longer line of output is logged in pieces */
+#define TASK_LINE_MAX 1024
+
+struct task {
+  const char *name;         /* prefixes every line logged, e.g. the path of the hook */
+  char *const *argv;        /* argv[0] is the path of the program, NULL terminated */
+  int timeout_ms;           /* 0 for LL_TASK_TIMEOUT, or TASK_TIMEOUT_MS */
+  int module;               /* the log module of the messages */
+  const char *thread_name;
+};
+
+/* stdout or stderr of a program started with task_start() */
+struct task_stream {
+  int fd;                   /* the read end, -1 once closed */
+  int level;
+  size_t len;
+  char line[TASK_LINE_MAX];
+};
+
+struct task_result {
+  int status;               /* as waitpid(), -1 if the hook did not start */
+  int timed_out;            /* killed at the deadline */
+  double seconds;
+};
+
+/**
+ * @note #include <spawn.h>, for posix_spawn_file_actions_t, posix_spawnattr_t
+ * @note #include <poll.h>, for poll
+ * @note #include <sys/wait.h>, for WIFEXITED, WEXITSTATUS, WTERMSIG
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+int task_run(const struct task *t, struct task_result *result);
+pid_t task_start(const struct task *t, struct task_stream *out, struct task_stream *err);
+void task_stream_read(const struct task *t, struct task_stream *s);
+void task_stream_close(const struct task *t, struct task_stream *s);
+
+#endif /* TASK_H */
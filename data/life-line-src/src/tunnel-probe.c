@@ -0,0 +1,212 @@
+#include "tunnel-probe.h"
+
+/**
+ * @file tunnel-probe.c
+ * @brief Probe the tunnel in-process from /proc/net/tcp, at an interval following its health
+ *
+ * The CHECK_TUNNEL of a check-tunnel script runs netstat, grep, awk and cut for every check.
+ * What it looks for is in /proc/net/tcp and /proc/net/tcp6: tunnel_probe_connected() tells
+ * whether ssh has an established TCP connection, by matching the socket inodes of
+ * /proc/PID/fd, and tunnel_probe_listening() whether the local service of the tunnel is
+ * listening. Both read the tables in blocks, a line at a time, and stop at the first match.
+ *
+ * The checks are no longer every 30 seconds: after a failure the next one comes in
+ * TUNNEL_PROBE_FAST_SECONDS, doubling while it goes on, and while the tunnel is healthy the
+ * interval doubles up to TUNNEL_PROBE_SLOW_SECONDS. A check-tunnel script keeps the checks at
+ * TUNNEL_PROBE_SECONDS: its exit status 0 does not tell as much as the probe.
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+
+static int interval = 0;
+static int failing = 0;
+static time_t next_probe = 0;
+
+struct probe_match {
+  const unsigned long *inodes;   /* the sockets of ssh, or NULL */
+  int count;
+  unsigned int state;
+  int port;                      /* the local port, or -1 for any */
+};
+
+static int probe_line(const char *line, const struct probe_match *m) {
+  unsigned int port, state;
+  unsigned long inode;
+  int i;
+  // sl local_address rem_address st tx_queue:rx_queue tr:tm->when retrnsmt uid timeout inode
+  if (sscanf(line, "%*d: %*[0-9A-Fa-f]:%x %*[0-9A-Fa-f]:%*x %x %*x:%*x %*x:%*x %*x %*u %*u %lu",
+      &port, &state, &inode) != 3 || state != m->state) {
+    return 0;
+  }
+  if (m->port >= 0 && (int)port != m->port) {
+    return 0;
+  }
+  if (m->inodes == NULL) {
+    return 1;
+  }
+  for (i = 0; i < m->count; i++) {
+    if (m->inodes[i] == inode) {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+/* 1 when a line of the table matches, 0 when none does, -1 when it cannot be read */
+static int probe_scan(const char *path, const struct probe_match *m) {
+  char buf[8192];
+  size_t len = 0;
+  ssize_t n;
+  int fd = open(path, O_RDONLY | O_CLOEXEC), found = 0;
+  if (fd < 0) {
+    return -1;
+  }
+  while (!found && (n = read(fd, buf + len, sizeof(buf) - 1 - len)) > 0) {
+    char *line = buf, *end;
+    len += n;
+    buf[len] = '\0';
+    while (!found && (end = strchr(line, '\n')) != NULL) {
+      *end = '\0';
+      found = probe_line(line, m);
+      line = end + 1;
+    }
+    // The partial line waits for the next block
+    len -= line - buf;
+    memmove(buf, line, len);
+  }
+  close(fd);
+  return found;
+}
+
+static int probe_tables(const struct probe_match *m) {
+  int v4 = probe_scan("/proc/net/tcp", m);
+  int v6;
+  if (v4 == 1) {
+    return 1;
+  }
+  v6 = probe_scan("/proc/net/tcp6", m);
+  if (v6 == 1) {
+    return 1;
+  }
+  return v4 < 0 && v6 < 0 ? -1 : 0;
+}
+
+/**
+ * @brief Tell whether a process has an established TCP connection.
+ *
+ * @param pid The process, e.g. ssh.
+ *
+ * @return 1 if so, 0 if not, -1 when /proc cannot be read.
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+int tunnel_probe_connected(pid_t pid) {
+  unsigned long inodes[TUNNEL_PROBE_SOCKETS_MAX];
+  struct probe_match m;
+  struct dirent *entry;
+  char path[64], target[64];
+  int count = 0;
+  DIR *dir;
+  snprintf(path, sizeof(path), "/proc/%d/fd", (int)pid);
+  dir = opendir(path);
+  if (dir == NULL) {
+    return -1;
+  }
+  while ((entry = readdir(dir)) != NULL && count < TUNNEL_PROBE_SOCKETS_MAX) {
+    ssize_t n;
+    if (entry->d_name[0] == '.') {
+      continue;
+    }
+    snprintf(path, sizeof(path), "/proc/%d/fd/%.16s", (int)pid, entry->d_name);
+    n = readlink(path, target, sizeof(target) - 1);
+    if (n > 0) {
+      target[n] = '\0';
+      if (sscanf(target, "socket:[%lu]", &inodes[count]) == 1) {
+        count++;
+      }
+    }
+  }
+  closedir(dir);
+  if (count == 0) {
+    return 0;
+  }
+  m.inodes = inodes;
+  m.count = count;
+  m.state = TUNNEL_PROBE_ESTABLISHED;
+  m.port = -1;
+  return probe_tables(&m);
+}
+
+/**
+ * @brief Tell whether a TCP port is listening.
+ *
+ * @return 1 if so, 0 if not, -1 when /proc cannot be read.
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+int tunnel_probe_listening(int port) {
+  struct probe_match m;
+  m.inodes = NULL;
+  m.count = 0;
+  m.state = TUNNEL_PROBE_LISTEN;
+  m.port = port;
+  return probe_tables(&m);
+}
+
+/**
+ * @brief Tell whether the tunnel is to be checked.
+ *
+ * @param now The time, as time().
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+int tunnel_probe_due(time_t now) {
+  if (next_probe == 0) {
+    // The first check, as before, 30 seconds after the start
+    next_probe = now + TUNNEL_PROBE_SECONDS;
+  }
+  return now >= next_probe;
+}
+
+/**
+ * @brief Set the next check after the result of this one.
+ *
+ * @param healthy 0 after a failure, which brings the next check to TUNNEL_PROBE_FAST_SECONDS.
+ * @param probed Set when the in-process probe alone checked the tunnel: the interval of a
+ * healthy tunnel then grows up to TUNNEL_PROBE_SLOW_SECONDS, and stays at TUNNEL_PROBE_SECONDS
+ * otherwise.
+ * @param now The time, as time().
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+void tunnel_probe_done(int healthy, int probed, time_t now) {
+  if (healthy) {
+    int slowest = probed ? TUNNEL_PROBE_SLOW_SECONDS : TUNNEL_PROBE_SECONDS;
+    interval = failing || interval < TUNNEL_PROBE_SECONDS ? TUNNEL_PROBE_SECONDS : interval * 2;
+    if (interval > slowest) {
+      interval = slowest;
+    }
+  } else {
+    interval = failing ? interval * 2 : TUNNEL_PROBE_FAST_SECONDS;
+    if (interval > TUNNEL_PROBE_SECONDS) {
+      interval = TUNNEL_PROBE_SECONDS;
+    }
+  }
+  failing = !healthy;
+  next_probe = now + interval;
+}
+
+/**
+ * @brief The seconds until the check after the last one.
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+int tunnel_probe_interval(void) {
+  return interval;
+}
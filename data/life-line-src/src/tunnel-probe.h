@@ -0,0 +1,45 @@
+#ifndef TUNNEL_PROBE_H
+#define TUNNEL_PROBE_H
+
+/**
+ * @file tunnel-probe.h
+ * @brief Probe the tunnel in-process from /proc/net/tcp, at an interval following its health
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <time.h>
+#include <unistd.h>
+
+/* The interval after a failed probe, doubled while the failures go on, up to the usual one */
+#define TUNNEL_PROBE_FAST_SECONDS 2
+#define TUNNEL_PROBE_SECONDS 30
+/* The interval doubles after every healthy probe up to this, when no script checked the tunnel */
+#define TUNNEL_PROBE_SLOW_SECONDS 300
+/* The sockets of ssh looked for at most */
+#define TUNNEL_PROBE_SOCKETS_MAX 64
+/* The TCP states of /proc/net/tcp */
+#define TUNNEL_PROBE_ESTABLISHED 0x01
+#define TUNNEL_PROBE_LISTEN 0x0A
+
+/**
+ * @note #include <dirent.h>, for opendir, to list /proc/PID/fd
+ * @note #include <fcntl.h>, for open
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+int tunnel_probe_due(time_t now);
+void tunnel_probe_done(int healthy, int probed, time_t now);
+int tunnel_probe_interval(void);
+int tunnel_probe_connected(pid_t pid);
+int tunnel_probe_listening(int port);
+
+#endif /* TUNNEL_PROBE_H */
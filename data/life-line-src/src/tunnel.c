@@ -0,0 +1,482 @@
+#include "tunnel.h"
+#include "log-level.h"
+#include "reaper.h"
+#include "task.h"
+#include "tunnel-probe.h"
+#include "wait-ms.h"
+
+/**
+ * @file tunnel.c
+ * @brief Keep the reverse SSH tunnel of tunnel.conf up with a supervised ssh -N -R
+ *
+ * Without a start-tunnel script, life-line reads TUNNEL_CONF itself and runs
+ *
+ *   ssh -N -i KEY -o ExitOnForwardFailure=yes -o ServerAliveInterval=30 ... -R FORWARD DESTINATION
+ *
+ * as its own child: a thread waits on a pidfd of ssh, so it learns of the exit at once instead
+ * of polling netstat and a PID_FILE every 30 seconds, logs the output of ssh, and restarts it.
+ * The delay before a restart doubles after every run shorter than TUNNEL_STABLE_SECONDS, up to
+ * TUNNEL_BACKOFF_MAX_MS, and a random part of it is waited ("equal jitter"), so that the
+ * replicas of a service losing their server at once do not come back at once.
+ *
+ * tunnel.conf is a shell script of assignments; only `[export] NAME=VALUE` lines are read, with
+ * the quotes removed and `$NAME` or `${NAME}` replaced by an earlier variable or the environment.
+ * It is read again before every start, so a change is taken at the next restart.
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+
+static const char *tunnel_thread_name = "Thread_tunnel";
+static char conf_file[TUNNEL_VALUE_MAX];
+static char key_file[TUNNEL_VALUE_MAX];
+static struct tunnel_conf current;
+static int active = 0;
+static int stopping = 0;
+static int running = 0;
+static pid_t child = 0;
+static unsigned int restarts = 0;
+static time_t first_start = 0;
+static time_t started = 0;
+static long long up_seconds = 0;       /* of the runs that ended */
+static char last_exit[64] = "none";
+static int unconnected = 0;            /* the probes in a row finding ssh without a connection */
+static int local_down = 0;
+
+static const char *tunnel_lookup(const struct tunnel_var *vars, int count, const char *name) {
+  int i;
+  for (i = count - 1; i >= 0; i--) {
+    if (strcmp(vars[i].name, name) == 0) {
+      return vars[i].value;
+    }
+  }
+  return getenv(name);
+}
+
+/* Copy a value without its quotes, replacing $NAME and ${NAME}; a command substitution is kept */
+static void tunnel_expand(const struct tunnel_var *vars, int count, const char *in, char *out, size_t size) {
+  size_t len = 0;
+  char quote = 0;
+  while (*in != '\0' && len + 1 < size) {
+    if (quote == 0 && (*in == '"' || *in == '\'')) {
+      quote = *in++;
+    } else if (quote != 0 && *in == quote) {
+      quote = 0;
+      in++;
+    } else if (quote == 0 && (*in == ' ' || *in == '\t' || *in == '#')) {
+      break;
+    } else if (*in == '$' && quote != '\'' && (in[1] == '{' || in[1] == '_' || (in[1] >= 'A' && in[1] <= 'Z') ||
+        (in[1] >= 'a' && in[1] <= 'z'))) {
+      char name[64];
+      const char *value;
+      size_t n = 0;
+      int braced = in[1] == '{';
+      in += braced ? 2 : 1;
+      while ((*in == '_' || (*in >= 'A' && *in <= 'Z') || (*in >= 'a' && *in <= 'z') || (*in >= '0' && *in <= '9')) &&
+          n + 1 < sizeof(name)) {
+        name[n++] = *in++;
+      }
+      name[n] = '\0';
+      if (braced && *in == '}') {
+        in++;
+      }
+      value = tunnel_lookup(vars, count, name);
+      while (value != NULL && *value != '\0' && len + 1 < size) {
+        out[len++] = *value++;
+      }
+    } else {
+      out[len++] = *in++;
+    }
+  }
+  out[len] = '\0';
+}
+
+/**
+ * @brief Read the tunnel of a tunnel.conf.
+ *
+ * @param path The file, e.g. TUNNEL_CONF.
+ * @param conf Receives what ssh needs.
+ *
+ * @return 0 on success, -1 when the file cannot be read or lacks REMOTE_SERVER, or both
+ * TUNNEL_SETTING and the REMOTE_PORT and LOCAL_PORT pair.
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+int tunnel_parse(const char *path, struct tunnel_conf *conf) {
+  struct tunnel_var vars[TUNNEL_VARS_MAX];
+  const char *server, *user, *remote_port, *local_port, *local_host, *setting, *name, *ssh_port;
+  char line[1024];
+  int count = 0, len;
+  FILE *f = fopen(path, "r");
+  if (f == NULL) {
+    return -1;
+  }
+  while (fgets(line, sizeof(line), f) != NULL && count < TUNNEL_VARS_MAX) {
+    char *p = line, *eq;
+    size_t n;
+    while (*p == ' ' || *p == '\t') {
+      p++;
+    }
+    if (strncmp(p, "export ", 7) == 0) {
+      p += 7;
+      while (*p == ' ') {
+        p++;
+      }
+    }
+    eq = strchr(p, '=');
+    if (*p == '#' || eq == NULL || eq == p || (size_t)(eq - p) >= sizeof(vars[0].name)) {
+      continue;
+    }
+    for (n = 0; p + n < eq && (p[n] == '_' || (p[n] >= 'A' && p[n] <= 'Z') || (p[n] >= 'a' && p[n] <= 'z') ||
+        (n > 0 && p[n] >= '0' && p[n] <= '9')); n++) {
+    }
+    if (p + n != eq) {
+      continue;
+    }
+    memcpy(vars[count].name, p, n);
+    vars[count].name[n] = '\0';
+    line[strcspn(line, "\r\n")] = '\0';
+    tunnel_expand(vars, count, eq + 1, vars[count].value, sizeof(vars[count].value));
+    count++;
+  }
+  fclose(f);
+  server = tunnel_lookup(vars, count, "REMOTE_SERVER");
+  user = tunnel_lookup(vars, count, "REMOTE_USER");
+  remote_port = tunnel_lookup(vars, count, "REMOTE_PORT");
+  local_port = tunnel_lookup(vars, count, "LOCAL_PORT");
+  local_host = tunnel_lookup(vars, count, "LOCAL_HOST");
+  setting = tunnel_lookup(vars, count, "TUNNEL_SETTING");
+  name = tunnel_lookup(vars, count, "TUNNEL_NAME");
+  ssh_port = tunnel_lookup(vars, count, "SSH_PORT");
+  if (server == NULL || *server == '\0') {
+    return -1;
+  }
+  // A value too long for ssh is refused rather than cut
+  if (setting != NULL && *setting != '\0') {
+    len = snprintf(conf->forward, sizeof(conf->forward), "%s", setting);
+  } else if (remote_port != NULL && *remote_port != '\0' && local_port != NULL && *local_port != '\0') {
+    len = snprintf(conf->forward, sizeof(conf->forward), "%s:%s:%s", remote_port,
+      local_host != NULL && *local_host != '\0' ? local_host : "localhost", local_port);
+  } else {
+    return -1;
+  }
+  if (len >= (int)sizeof(conf->forward)) {
+    return -1;
+  }
+  if (user != NULL && *user != '\0') {
+    len = snprintf(conf->destination, sizeof(conf->destination), "%s@%s", user, server);
+  } else {
+    len = snprintf(conf->destination, sizeof(conf->destination), "%s", server);
+  }
+  if (len >= (int)sizeof(conf->destination)) {
+    return -1;
+  }
+  len = snprintf(conf->ssh_port, sizeof(conf->ssh_port), "%s", ssh_port != NULL ? ssh_port : "");
+  if (len >= (int)sizeof(conf->ssh_port)) {
+    return -1;
+  }
+  snprintf(conf->name, sizeof(conf->name), "%s", name != NULL && *name != '\0' ? name : server);
+  return 0;
+}
+
+static int tunnel_pidfd(pid_t pid) {
+#ifdef SYS_pidfd_open
+  return (int)syscall(SYS_pidfd_open, pid, 0);
+#else
+  (void)pid;
+  errno = ENOSYS;
+  return -1;
+#endif
+}
+
+/* Wait for the exit of ssh, logging its output; 0 or its status */
+static int tunnel_wait(const struct task *t, pid_t pid, struct task_stream *out, struct task_stream *err) {
+  struct pollfd fds[3];
+  int pidfd = tunnel_pidfd(pid);
+  int status = 0, nfds, exited = 0;
+  while (!exited) {
+    nfds = 0;
+    if (pidfd >= 0) {
+      fds[nfds].fd = pidfd;
+      fds[nfds++].events = POLLIN;
+    }
+    if (out->fd >= 0) {
+      fds[nfds].fd = out->fd;
+      fds[nfds++].events = POLLIN;
+    }
+    if (err->fd >= 0) {
+      fds[nfds].fd = err->fd;
+      fds[nfds++].events = POLLIN;
+    }
+    // With a pidfd the exit wakes the poll; without, it is checked every second
+    if (poll(fds, nfds, 1000) > 0) {
+      if (out->fd >= 0) {
+        task_stream_read(t, out);
+      }
+      if (err->fd >= 0) {
+        task_stream_read(t, err);
+      }
+    }
+    if (pidfd < 0 || (fds[0].revents & POLLIN)) {
+      exited = reaper_waitpid(pid, &status, pidfd < 0 ? WNOHANG : 0) == pid;
+    }
+  }
+  if (pidfd >= 0) {
+    close(pidfd);
+  }
+  // What ssh wrote just before its exit
+  if (out->fd >= 0) {
+    task_stream_read(t, out);
+  }
+  if (err->fd >= 0) {
+    task_stream_read(t, err);
+  }
+  task_stream_close(t, out);
+  task_stream_close(t, err);
+  return status;
+}
+
+static void *tunnel_thread(void *arg) {
+  struct task_stream out, err;
+  struct tunnel_conf conf;
+  struct task t;
+  char *argv[32];
+  int backoff = TUNNEL_BACKOFF_MIN_MS, delay, slept, argc, status;
+  unsigned int seed = (unsigned int)(getpid() ^ time(NULL));
+  time_t start;
+  pid_t pid;
+  (void)arg;
+  while (!__atomic_load_n(&stopping, __ATOMIC_ACQUIRE)) {
+    if (tunnel_parse(conf_file, &conf) != 0) {
+      LOG_ERROR(LOG_MODULE_TUNNEL, tunnel_thread_name, "Tunnel: reading %s ..Failed..", conf_file);
+    } else {
+      argc = 0;
+      argv[argc++] = TUNNEL_SSH;
+      argv[argc++] = "-N";
+      argv[argc++] = "-i";
+      argv[argc++] = key_file;
+      argv[argc++] = "-o";
+      argv[argc++] = "BatchMode=yes";
+      argv[argc++] = "-o";
+      argv[argc++] = "ExitOnForwardFailure=yes";
+      argv[argc++] = "-o";
+      argv[argc++] = "ServerAliveInterval=30";
+      argv[argc++] = "-o";
+      argv[argc++] = "ServerAliveCountMax=3";
+      argv[argc++] = "-o";
+      argv[argc++] = "StrictHostKeyChecking=accept-new";
+      if (conf.ssh_port[0] != '\0') {
+        argv[argc++] = "-p";
+        argv[argc++] = conf.ssh_port;
+      }
+      argv[argc++] = "-R";
+      argv[argc++] = conf.forward;
+      argv[argc++] = conf.destination;
+      argv[argc] = NULL;
+      t.name = conf.name;
+      t.argv = argv;
+      t.timeout_ms = 0;
+      t.module = LOG_MODULE_TUNNEL;
+      t.thread_name = tunnel_thread_name;
+      pid = task_start(&t, &out, &err);
+      if (pid < 0) {
+        LOG_ERROR(LOG_MODULE_TUNNEL, tunnel_thread_name, "Tunnel %s: starting " TUNNEL_SSH " ..Failed.. (%s)", conf.name,
+          strerror(errno));
+      } else {
+        start = time(NULL);
+        current = conf;
+        __atomic_store_n(&started, start, __ATOMIC_RELEASE);
+        __atomic_store_n(&child, pid, __ATOMIC_RELEASE);
+        LOG_INFO(LOG_MODULE_TUNNEL, tunnel_thread_name, "Tunnel %s: ssh -R %s %s ..Started.. as pid %d", conf.name,
+          conf.forward, conf.destination, pid);
+        status = tunnel_wait(&t, pid, &out, &err);
+        __atomic_store_n(&child, 0, __ATOMIC_RELEASE);
+        __atomic_store_n(&started, 0, __ATOMIC_RELEASE);
+        __atomic_add_fetch(&up_seconds, time(NULL) - start, __ATOMIC_RELEASE);
+        if (WIFSIGNALED(status)) {
+          snprintf(last_exit, sizeof(last_exit), "signal %d (%s)", WTERMSIG(status), strsignal(WTERMSIG(status)));
+        } else {
+          snprintf(last_exit, sizeof(last_exit), "exit status %d", WEXITSTATUS(status));
+        }
+        if (__atomic_load_n(&stopping, __ATOMIC_ACQUIRE)) {
+          LOG_INFO(LOG_MODULE_TUNNEL, tunnel_thread_name, "Tunnel %s ..Stopped.. (%s)", conf.name, last_exit);
+          break;
+        }
+        LOG_ERROR(LOG_MODULE_TUNNEL, tunnel_thread_name, "Tunnel %s: ssh ended after %ld s (%s)", conf.name,
+          (long)(time(NULL) - start), last_exit);
+        if (time(NULL) - start >= TUNNEL_STABLE_SECONDS) {
+          backoff = TUNNEL_BACKOFF_MIN_MS;
+        }
+      }
+    }
+    // Equal jitter: half of the delay, and a random part of the other half
+    delay = backoff / 2 + (int)(rand_r(&seed) % (unsigned int)(backoff / 2 + 1));
+    LOG_WARN(LOG_MODULE_TUNNEL, tunnel_thread_name, "Tunnel: restarting in %d ms", delay);
+    for (slept = 0; slept < delay && !__atomic_load_n(&stopping, __ATOMIC_ACQUIRE); slept += 100) {
+      sleep_ms(100);
+    }
+    backoff = backoff * 2 < TUNNEL_BACKOFF_MAX_MS ? backoff * 2 : TUNNEL_BACKOFF_MAX_MS;
+    if (!__atomic_load_n(&stopping, __ATOMIC_ACQUIRE)) {
+      __atomic_add_fetch(&restarts, 1, __ATOMIC_RELEASE);
+    }
+  }
+  __atomic_store_n(&running, 0, __ATOMIC_RELEASE);
+  return NULL;
+}
+
+/**
+ * @brief Start keeping the tunnel of a tunnel.conf up, when it describes one.
+ *
+ * @param conf_path The configuration, e.g. TUNNEL_CONF.
+ * @param key_path The private key given to ssh -i.
+ * @param thread_name The thread logging the start.
+ *
+ * @return 0 when the tunnel thread is running, -1 when ssh or the configuration is missing.
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+int tunnel_start(const char *conf_path, const char *key_path, const char *thread_name) {
+  struct tunnel_conf conf;
+  pthread_t tid;
+  if (active) {
+    return 0;
+  }
+  if (access(TUNNEL_SSH, X_OK) != 0) {
+    LOG_WARN(LOG_MODULE_TUNNEL, thread_name, "Tunnel: " TUNNEL_SSH " ..Not Found..");
+    return -1;
+  }
+  if (tunnel_parse(conf_path, &conf) != 0) {
+    LOG_WARN(LOG_MODULE_TUNNEL, thread_name, "Tunnel: %s has no REMOTE_SERVER, REMOTE_PORT and LOCAL_PORT", conf_path);
+    return -1;
+  }
+  snprintf(conf_file, sizeof(conf_file), "%s", conf_path);
+  snprintf(key_file, sizeof(key_file), "%s", key_path);
+  current = conf;
+  first_start = time(NULL);
+  running = 1;
+  if (pthread_create(&tid, NULL, tunnel_thread, NULL) != 0) {
+    running = 0;
+    LOG_ERROR(LOG_MODULE_TUNNEL, thread_name, "Tunnel %s ..Failed..", conf.name);
+    return -1;
+  }
+  pthread_detach(tid);
+  active = 1;
+  return 0;
+}
+
+/**
+ * @brief Tell whether life-line keeps the tunnel up itself.
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+int tunnel_active(void) {
+  return active;
+}
+
+/**
+ * @brief Stop ssh on exit.
+ *
+ * @details ssh gets SIGTERM, then SIGKILL when it is still running after TUNNEL_STOP_TIMEOUT_MS.
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+void tunnel_stop(void) {
+  pid_t pid;
+  int waited;
+  if (!active) {
+    return;
+  }
+  __atomic_store_n(&stopping, 1, __ATOMIC_RELEASE);
+  pid = __atomic_load_n(&child, __ATOMIC_ACQUIRE);
+  if (pid > 0) {
+    kill(-pid, SIGTERM);
+  }
+  for (waited = 0; __atomic_load_n(&running, __ATOMIC_ACQUIRE) && waited < TUNNEL_STOP_TIMEOUT_MS; waited += 50) {
+    sleep_ms(50);
+  }
+  pid = __atomic_load_n(&child, __ATOMIC_ACQUIRE);
+  if (pid > 0) {
+    kill(-pid, SIGKILL);
+    for (waited = 0; __atomic_load_n(&running, __ATOMIC_ACQUIRE) && waited < 1000; waited += 50) {
+      sleep_ms(50);
+    }
+  }
+}
+
+/**
+ * @brief Probe the tunnel kept up by tunnel_start(), from /proc.
+ *
+ * @param thread_name The thread logging the changes of state.
+ *
+ * @return 1 when ssh is connected and the local port of the tunnel listening, 0 otherwise.
+ *
+ * @details ssh found without an established connection TUNNEL_PROBE_FAILURES_MAX times in a
+ * row is stuck, e.g. in the TCP connect to a server gone: it gets SIGTERM, and is restarted.
+ * A local service not listening is only logged, as the tunnel itself is fine.
+ *
+ * @see tunnel_probe_connected()
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+int tunnel_check(const char *thread_name) {
+  pid_t pid = __atomic_load_n(&child, __ATOMIC_ACQUIRE);
+  const char *colon = strrchr(current.forward, ':');
+  int connected, listening;
+  if (pid <= 0) {
+    return 0;
+  }
+  connected = tunnel_probe_connected(pid);
+  if (connected == 0) {
+    unconnected++;
+    if (unconnected >= TUNNEL_PROBE_FAILURES_MAX) {
+      LOG_ERROR(LOG_MODULE_TUNNEL, thread_name, "Tunnel %s: ssh has had no connection for %d probes ..Restarting..",
+        current.name, unconnected);
+      kill(-pid, SIGTERM);
+      unconnected = 0;
+    }
+  } else {
+    unconnected = 0;
+  }
+  listening = colon != NULL ? tunnel_probe_listening(atoi(colon + 1)) : -1;
+  if (listening == 0 && !local_down) {
+    LOG_WARN(LOG_MODULE_TUNNEL, thread_name, "Tunnel %s: local port %s ..Not Listening..", current.name, colon + 1);
+  } else if (listening == 1 && local_down) {
+    LOG_INFO(LOG_MODULE_TUNNEL, thread_name, "Tunnel %s: local port %s ..Listening..", current.name, colon + 1);
+  }
+  local_down = listening == 0;
+  return connected != 0 && listening != 0;
+}
+
+/**
+ * @brief Describe the tunnel.
+ *
+ * @param buf Receives e.g. "dev-00: 2000:localhost:80 to console.example.io up for 3600 s as pid 42,
+ * 2 restarts, 99.9% uptime, last exit exit status 255".
+ * @param size The size of buf.
+ *
+ * @return The length of the text, as snprintf().
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+int tunnel_report(char *buf, size_t size) {
+  pid_t pid = __atomic_load_n(&child, __ATOMIC_ACQUIRE);
+  time_t since = __atomic_load_n(&started, __ATOMIC_ACQUIRE);
+  time_t now = time(NULL);
+  long long up = __atomic_load_n(&up_seconds, __ATOMIC_ACQUIRE);
+  char state[64];
+  if (pid > 0 && since > 0) {
+    up += now - since;
+    snprintf(state, sizeof(state), "up for %ld s as pid %d", (long)(now - since), pid);
+  } else {
+    snprintf(state, sizeof(state), "down");
+  }
+  return snprintf(buf, size, "%s: %s to %s %s, %u restarts, %.1f%% uptime, last exit %s", current.name,
+    current.forward, current.destination, state, __atomic_load_n(&restarts, __ATOMIC_ACQUIRE),
+    now > first_start ? 100.0 * up / (now - first_start) : 100.0, last_exit);
+}
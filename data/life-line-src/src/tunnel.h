@@ -0,0 +1,67 @@
+#ifndef TUNNEL_H
+#define TUNNEL_H
+
+/**
+ * @file tunnel.h
+ * @brief Keep the reverse SSH tunnel of tunnel.conf up with a supervised ssh -N -R
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+
+#include <errno.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/syscall.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#define TUNNEL_SSH "/usr/bin/ssh"
+/* The delay before a restart, doubled after every short run, of which a random half is waited */
+#define TUNNEL_BACKOFF_MIN_MS 1000
+#define TUNNEL_BACKOFF_MAX_MS 300000
+/* A run lasting this long resets the delay */
+#define TUNNEL_STABLE_SECONDS 60
+/* On exit, ssh gets SIGTERM, then SIGKILL after this delay */
+#define TUNNEL_STOP_TIMEOUT_MS 2000
+/* Probes in a row finding ssh running without a connection before it is restarted */
+#define TUNNEL_PROBE_FAILURES_MAX 3
+/* The variables of tunnel.conf kept at most, and their length */
+#define TUNNEL_VARS_MAX 32
+#define TUNNEL_VALUE_MAX 256
+
+struct tunnel_var {
+  char name[64];
+  char value[TUNNEL_VALUE_MAX];
+};
+
+/* What ssh needs of tunnel.conf */
+struct tunnel_conf {
+  char name[TUNNEL_VALUE_MAX];          /* TUNNEL_NAME, or REMOTE_SERVER */
+  char forward[TUNNEL_VALUE_MAX];       /* TUNNEL_SETTING, or REMOTE_PORT:LOCAL_HOST:LOCAL_PORT */
+  char destination[TUNNEL_VALUE_MAX];   /* [REMOTE_USER@]REMOTE_SERVER */
+  char ssh_port[16];                    /* SSH_PORT, or empty for the default */
+};
+
+/**
+ * @note #include <poll.h>, for poll
+ * @note #include <sys/syscall.h>, for SYS_pidfd_open
+ * @note #include <pthread.h>, for pthread_create
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+int tunnel_parse(const char *path, struct tunnel_conf *conf);
+int tunnel_start(const char *conf_path, const char *key_path, const char *thread_name);
+int tunnel_active(void);
+int tunnel_check(const char *thread_name);
+void tunnel_stop(void);
+int tunnel_report(char *buf, size_t size);
+
+#endif /* TUNNEL_H */
@@ -0,0 +1,45 @@
+#include "wait-ms.h"
+
+/**
+ * @file wait-ms.c
+ * @brief Sleep, or compute the deadline of a timed wait, in milliseconds
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+
+/**
+ * @brief Sleep for ms milliseconds, resuming after a signal.
+ *
+ * @param ms The milliseconds to sleep.
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+void sleep_ms(int ms) {
+  struct timespec ts;
+  ts.tv_sec = ms / 1000;
+  ts.tv_nsec = (long)(ms % 1000) * 1000000L;
+  while (nanosleep(&ts, &ts) != 0) {
+  }
+}
+
+/**
+ * @brief The time ms milliseconds from now, for pthread_cond_timedwait().
+ *
+ * @param ts Receives the deadline, on CLOCK_REALTIME as pthread_cond_timedwait() expects of a
+ * condition variable with the default attributes.
+ * @param ms The milliseconds from now.
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+void deadline_ms(struct timespec *ts, int ms) {
+  clock_gettime(CLOCK_REALTIME, ts);
+  ts->tv_sec += ms / 1000;
+  ts->tv_nsec += (long)(ms % 1000) * 1000000L;
+  if (ts->tv_nsec >= 1000000000L) {
+    ts->tv_sec++;
+    ts->tv_nsec -= 1000000000L;
+  }
+}
@@ -0,0 +1,23 @@
+#ifndef WAIT_MS_H
+#define WAIT_MS_H
+
+/**
+ * @file wait-ms.h
+ * @brief Sleep, or compute the deadline of a timed wait, in milliseconds
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+
+#include <time.h>
+
+/**
+ * @note #include <time.h>, for nanosleep, clock_gettime
+ *
+ * @author Cloudgen Wong
+ * @date 2026-10-17
+ */
+void sleep_ms(int ms);
+void deadline_ms(struct timespec *ts, int ms);
+
+#endif /* WAIT_MS_H */
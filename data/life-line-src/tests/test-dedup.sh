@@ -0,0 +1,39 @@
+#!/bin/sh
+# Lets the daemon log "10s: Time for fix folder." three times with the default LL_LOG_DEDUP of
+# 1/600, then stops it: the life-line log must hold one copy of the message, and the
+# "last message repeated N-1 times" summary before the state line of the exit. N is counted in
+# the flight recorder, which records every message.
+test_dedup() {
+    TARGET="$(readlink -f "$1")"
+    DIR=$(mktemp -d)
+    SELF_LOG=/data/doc-root/log/life-line/life-line-$(date +%Y-%m-%d).log
+    MESSAGE="10s: Time for fix folder."
+    FROM=$(($(wc -l < "${SELF_LOG}") + 1))
+    LL_LOG_FLIGHT="${DIR}/flight" "${TARGET}" run /bin/sh -c "sleep 120" > /dev/null 2>&1 &
+    LL=$!
+    for i in $(seq 1 40); do
+        if tail -n +${FROM} "${SELF_LOG}" | grep -q "#${LL} ] .*» ${MESSAGE}\$"; then
+            break
+        fi
+        sleep 0.5
+    done
+    # The message comes back every 10 s
+    sleep 21
+    COUNT=$(LL_LOG_FLIGHT="${DIR}/flight" "${TARGET}" flight | grep -c "${MESSAGE}\$")
+    kill -TERM ${LL}
+    wait ${LL}
+    tail -n +${FROM} "${SELF_LOG}" | grep "#${LL} ] " | sed 's/^[^]]*] //; s/^.*» //' > "${DIR}/messages"
+    SUMMARY="last message repeated $((COUNT - 1)) times: ${MESSAGE}"
+    if [ ${COUNT} -lt 3 ] || [ $(grep -c "^${MESSAGE}\$" "${DIR}/messages") -ne 1 ] ||
+        [ $(grep -c "^${SUMMARY}\$" "${DIR}/messages") -ne 1 ] ||
+        [ "$(sed -n "/^${SUMMARY}\$/,/ State: /p" "${DIR}/messages" | grep -v "^last message repeated " | tail -n 1)" != \
+        "====== State: .*MAIN_LOOP* -> *END*.......... ======" ]; then
+        echo "dedup Test failed: ${COUNT} messages logged as"
+        cat "${DIR}/messages"
+        rm -rf "${DIR}"
+        exit 1
+    fi
+    rm -rf "${DIR}"
+    echo "dedup Test passed: ${COUNT} repeats written once, with their summary before the state line."
+}
+test_dedup "$1"
@@ -0,0 +1,47 @@
+#!/bin/sh
+# Logs through a life-line forwarding to `life-line collect`, kills the collector halfway and
+# starts it again: every line must reach the collector once, in order, without a gap.
+test_forward() {
+    TARGET="$(readlink -f "$1")"
+    COUNT="${2:-200}"
+    APP=ll-test-forward
+    DIR=$(mktemp -d)
+    SOCK="unix:${DIR}/collector.sock"
+    ln -s "${TARGET}" "${DIR}/ll-log-msg"
+    "${TARGET}" collect "${SOCK}" > "${DIR}/collected" 2>&1 &
+    COLLECTOR=$!
+    LL_LOG_FORWARD="${SOCK}" "${TARGET}" run /bin/sh -c "sleep 120" > /dev/null 2>&1 &
+    LL=$!
+    sleep 1
+    i=1
+    while [ $i -le ${COUNT} ]; do
+        "${DIR}/ll-log-msg" ${APP} "line $i"
+        if [ $i -eq $((COUNT / 2)) ]; then
+            # The second half waits in the log file while the collector is down
+            kill ${COLLECTOR}
+            wait ${COLLECTOR}
+        fi
+        i=$((i+1))
+    done
+    "${TARGET}" collect "${SOCK}" >> "${DIR}/collected" 2>&1 &
+    COLLECTOR=$!
+    # The forwarder reconnects within a few seconds
+    for i in 1 2 3 4 5 6 7 8 9 10 11 12 13 14 15 16 17 18 19 20; do
+        if [ $(grep -c "^#[0-9]* ${APP}: " "${DIR}/collected") -ge ${COUNT} ]; then
+            break
+        fi
+        sleep 0.5
+    done
+    kill -TERM ${LL} ${COLLECTOR}
+    wait ${LL} ${COLLECTOR}
+    RECEIVED=$(grep -c "^#[0-9]* ${APP}: " "${DIR}/collected")
+    BROKEN=$(grep "^#[0-9]* ${APP}: " "${DIR}/collected" | sed 's/.* line //' | awk '$1 != NR' | wc -l)
+    rm -rf "${DIR}" /data/doc-root/log/${APP}
+    if [ ${RECEIVED} -eq ${COUNT} ] && [ ${BROKEN} -eq 0 ]; then
+        echo "forward Test passed: ${COUNT} lines collected across a restart of the collector."
+    else
+        echo "forward Test failed: ${RECEIVED} of ${COUNT} lines collected, ${BROKEN} out of place."
+        exit 1
+    fi
+}
+test_forward "$1" "$2"
@@ -0,0 +1,121 @@
+#!/bin/sh
+# Runs the daemon with LL_LOG_ASYNC under each overflow policy. The log file of the test is a
+# FIFO nobody reads yet, so the flusher stalls on it and the ring fills up; a reader started
+# afterwards gets what the policy kept. The last case stops the daemon with the records still
+# queued: they must be written on the way out.
+ASYNC_SLOTS=256
+
+# Starts the daemon with the given policy and the log file of the test replaced by a FIFO
+async_start() {
+    rm -rf /data/doc-root/log/${APP}
+    mkdir -p /data/doc-root/log/${APP}
+    mkfifo "${LOG}"
+    LL_LOG_ASYNC="$1" "${TARGET}" run /bin/sh -c "sleep 120" > /dev/null 2>&1 &
+    LL=$!
+    for i in 1 2 3 4 5 6 7 8 9 10 11 12 13 14 15 16 17 18 19 20; do
+        if [ -f /run/life-line/ready ]; then
+            break
+        fi
+        sleep 0.5
+    done
+}
+
+# Sends lines 1 to $1 through ll-log-msg
+async_send() {
+    i=1
+    while [ $i -le $1 ]; do
+        "${DIR}/ll-log-msg" ${APP} "line $i"
+        i=$((i+1))
+    done
+}
+
+# Reads the FIFO until the daemon has stopped, then keeps the messages in ${DIR}/messages
+async_collect() {
+    cat "${LOG}" > "${DIR}/out" &
+    READER=$!
+    sleep 1
+    kill -TERM ${LL}
+    wait ${LL} ${READER}
+    sed 's/^[^]]*] //' "${DIR}/out" > "${DIR}/messages"
+}
+
+# Tells whether the daemon logged $1 dropped records since its start
+async_dropped() {
+    tail -n 200 "${SELF_LOG}" | grep -q " $1 log records ..Dropped.."
+}
+
+test_log_async() {
+    TARGET="$(readlink -f "$1")"
+    APP=ll-test-async
+    DIR=$(mktemp -d)
+    LOG=/data/doc-root/log/${APP}/${APP}-$(date +%Y-%m-%d).log
+    SELF_LOG=/data/doc-root/log/life-line/life-line-$(date +%Y-%m-%d).log
+    ln -s "${TARGET}" "${DIR}/ll-log-msg"
+    FAILED=0
+
+    # block: once the ring and the socket are full, ll-log-msg writes the FIFO itself
+    async_start block
+    async_send 300 &
+    SENDER=$!
+    sleep 2
+    cat "${LOG}" > "${DIR}/out" &
+    READER=$!
+    wait ${SENDER}
+    sleep 1
+    kill -TERM ${LL}
+    wait ${LL} ${READER}
+    if [ $(sed 's/^[^]]*] //' "${DIR}/out" | sort -u | grep -c "^line [0-9]*$") -ne 300 ] ||
+        [ $(wc -l < "${DIR}/out") -ne 300 ]; then
+        echo "log-async Test failed: block kept $(wc -l < "${DIR}/out") of 300 lines"
+        FAILED=1
+    fi
+
+    # drop: the ring keeps the oldest records, the newer ones are counted and reported. The
+    # flusher holds the few it had taken from the ring before it stalled.
+    async_start drop
+    async_send 400
+    async_collect
+    KEPT=$(wc -l < "${DIR}/messages")
+    seq 1 ${KEPT} | sed 's/^/line /' > "${DIR}/expected"
+    if [ ${KEPT} -le ${ASYNC_SLOTS} ] || [ ${KEPT} -gt $((ASYNC_SLOTS + 64)) ] ||
+        ! cmp -s "${DIR}/messages" "${DIR}/expected" || ! async_dropped $((400 - KEPT)); then
+        echo "log-async Test failed: drop kept ${KEPT} lines, up to '$(tail -n 1 "${DIR}/messages")'"
+        FAILED=1
+    fi
+
+    # drop-oldest: the ring keeps the newest records, after those the flusher held
+    async_start drop-oldest
+    async_send 400
+    async_collect
+    KEPT=$(wc -l < "${DIR}/messages")
+    seq 1 $((KEPT - ASYNC_SLOTS)) | sed 's/^/line /' > "${DIR}/expected"
+    seq $((400 - ASYNC_SLOTS + 1)) 400 | sed 's/^/line /' >> "${DIR}/expected"
+    if [ ${KEPT} -le ${ASYNC_SLOTS} ] || [ ${KEPT} -gt $((ASYNC_SLOTS + 64)) ] ||
+        ! cmp -s "${DIR}/messages" "${DIR}/expected" || ! async_dropped $((400 - KEPT)); then
+        echo "log-async Test failed: drop-oldest kept ${KEPT} lines, up to '$(tail -n 1 "${DIR}/messages")'"
+        FAILED=1
+    fi
+
+    # Drain on exit: the daemon is stopped with 100 records queued and nobody reading yet
+    async_start block
+    async_send 100
+    sleep 1
+    kill -TERM ${LL}
+    sleep 0.5
+    cat "${LOG}" > "${DIR}/out" &
+    READER=$!
+    wait ${LL} ${READER}
+    sed 's/^[^]]*] //' "${DIR}/out" > "${DIR}/messages"
+    seq 1 100 | sed 's/^/line /' > "${DIR}/expected"
+    if ! cmp -s "${DIR}/messages" "${DIR}/expected"; then
+        echo "log-async Test failed: $(wc -l < "${DIR}/messages") of 100 queued lines written on exit"
+        FAILED=1
+    fi
+
+    rm -rf "${DIR}" /data/doc-root/log/${APP}
+    if [ ${FAILED} -ne 0 ]; then
+        exit 1
+    fi
+    echo "log-async Test passed: block, drop and drop-oldest policies, queue drained on exit."
+}
+test_log_async "$1"
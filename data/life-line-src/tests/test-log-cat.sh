@@ -0,0 +1,87 @@
+#!/bin/sh
+# Writes a binary log with ll-log-pipe, decodes it with ll-log-cat to text and to JSON, then
+# damages the last block and checks that ll-log-cat skips it and reports it. Last, the length
+# of a first block is damaged so that it claims the blocks after it: those must still decode.
+# A record the daemon cannot write must be reported in its own log.
+test_log_cat() {
+    TARGET="$(readlink -f "$1")"
+    APP=ll-test-cat
+    DIR=$(mktemp -d)
+    LLB=/data/doc-root/log/${APP}/${APP}-$(date +%Y-%m-%d).llb
+    ln -s "${TARGET}" "${DIR}/ll-log-pipe"
+    ln -s "${TARGET}" "${DIR}/ll-log-cat"
+    ln -s "${TARGET}" "${DIR}/ll-log-msg"
+    rm -rf /data/doc-root/log/${APP}
+    FAILED=0
+
+    # Two runs append two blocks
+    printf 'first line\nsays "hi" \\ back\n' | LL_LOG_FORMAT=binary "${DIR}/ll-log-pipe" ${APP}
+    printf 'second block\n' | LL_LOG_FORMAT=binary "${DIR}/ll-log-pipe" ${APP}
+
+    "${DIR}/ll-log-cat" "${LLB}" > "${DIR}/text"
+    sed 's/^[^]]*] //' "${DIR}/text" > "${DIR}/messages"
+    printf 'first line\nsays "hi" \\ back\nsecond block\n' > "${DIR}/expected"
+    if ! cmp -s "${DIR}/messages" "${DIR}/expected" || [ $(grep -c "^[0-9-]* [0-9:]* ${APP} #[0-9]* ] " "${DIR}/text") -ne 3 ]; then
+        echo "log-cat Test failed: decoded as"
+        cat "${DIR}/text"
+        FAILED=1
+    fi
+
+    "${DIR}/ll-log-cat" -j "${LLB}" > "${DIR}/json"
+    if [ $(grep -c "^{\"time\":\"[^\"]*\",\"epoch\":[0-9]*,\"app\":\"${APP}\",\"pid\":[0-9]*," "${DIR}/json") -ne 3 ] ||
+        ! grep -q '"says \\"hi\\" \\\\ back"' "${DIR}/json"; then
+        echo "log-cat Test failed: decoded to JSON as"
+        cat "${DIR}/json"
+        FAILED=1
+    fi
+
+    # The last byte belongs to the message of the second block: its CRC no longer matches
+    printf 'X' | dd of="${LLB}" bs=1 seek=$(($(wc -c < "${LLB}") - 1)) conv=notrunc 2> /dev/null
+    if "${DIR}/ll-log-cat" "${LLB}" > "${DIR}/text" 2> "${DIR}/errors" || ! grep -q "1 damaged blocks skipped" "${DIR}/errors" ||
+        [ "$(sed 's/^[^]]*] //' "${DIR}/text")" != "$(head -n 2 "${DIR}/expected")" ]; then
+        echo "log-cat Test failed: a damaged block decoded as"
+        cat "${DIR}/text" "${DIR}/errors"
+        FAILED=1
+    fi
+
+    # Three blocks of one line; the first claims 64 bytes instead of its 28
+    rm -f "${LLB}"
+    for m in a b c; do
+        printf '%s\n' $m | LL_LOG_FORMAT=binary "${DIR}/ll-log-pipe" ${APP}
+    done
+    printf '\100' | dd of="${LLB}" bs=1 seek=6 conv=notrunc 2> /dev/null
+    if "${DIR}/ll-log-cat" "${LLB}" > "${DIR}/text" 2> "${DIR}/errors" || ! grep -q "1 damaged blocks skipped" "${DIR}/errors" ||
+        [ "$(sed 's/^[^]]*] //' "${DIR}/text" | tr '\n' ' ')" != "b c " ]; then
+        echo "log-cat Test failed: after a damaged block length, decoded as"
+        cat "${DIR}/text" "${DIR}/errors"
+        FAILED=1
+    fi
+
+    # A record the daemon cannot write, the .llb being a folder, is counted and reported
+    rm -f "${LLB}"
+    mkdir "${LLB}"
+    LL_LOG_FORMAT=binary "${TARGET}" run /bin/sh -c "sleep 120" > /dev/null 2>&1 &
+    LL=$!
+    for i in 1 2 3 4 5 6 7 8 9 10 11 12 13 14 15 16 17 18 19 20; do
+        if [ -f /run/life-line/ready ]; then
+            break
+        fi
+        sleep 0.5
+    done
+    "${DIR}/ll-log-msg" ${APP} "lost record"
+    sleep 0.5
+    kill -TERM ${LL}
+    wait ${LL}
+    if ! "${DIR}/ll-log-cat" -g "could not be written" /data/doc-root/log/life-line/life-line-$(date +%Y-%m-%d).llb 2> /dev/null |
+        grep -q "#${LL} ]   «Thread_main» 1 binary log records could not be written ..Dropped..\$"; then
+        echo "log-cat Test failed: a record the daemon could not write was not reported"
+        FAILED=1
+    fi
+
+    rm -rf "${DIR}" /data/doc-root/log/${APP}
+    if [ ${FAILED} -ne 0 ]; then
+        exit 1
+    fi
+    echo "log-cat Test passed: text and JSON round trip, damaged blocks skipped, unwritten record reported."
+}
+test_log_cat "$1"
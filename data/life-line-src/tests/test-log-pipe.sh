@@ -0,0 +1,38 @@
+#!/bin/sh
+# Feeds ll-log-pipe a line split across two reads, a line longer than a log line and an input
+# without its final newline, and checks the messages logged.
+test_log_pipe() {
+    TARGET="$(readlink -f "$1")"
+    APP=ll-test-pipe
+    DIR=$(mktemp -d)
+    LOG=/data/doc-root/log/${APP}/${APP}-$(date +%Y-%m-%d).log
+    ln -s "${TARGET}" "${DIR}/ll-log-pipe"
+    rm -rf /data/doc-root/log/${APP}
+    FAILED=0
+
+    (printf 'first ha'; sleep 0.3; printf 'lf\r\nsecond\n') | "${DIR}/ll-log-pipe" ${APP}
+    printf 'one\ntwo' | "${DIR}/ll-log-pipe" ${APP}
+    sed 's/^[^]]*] //' "${LOG}" > "${DIR}/messages"
+    printf 'first half\nsecond\none\ntwo\n' > "${DIR}/expected"
+    if ! cmp -s "${DIR}/messages" "${DIR}/expected"; then
+        echo "log-pipe Test failed: partial lines logged as"
+        cat "${DIR}/messages"
+        FAILED=1
+    fi
+
+    # 10000 bytes make two lines of LOG_PIPE_LINE_MAX (3840) and the rest
+    rm -f "${LOG}"
+    head -c 10000 /dev/zero | tr '\0' 'a' | "${DIR}/ll-log-pipe" ${APP}
+    LENGTHS=$(sed 's/^[^]]*] //' "${LOG}" | awk '{ printf "%d ", length($0) }')
+    if [ "${LENGTHS}" != "3840 3840 2320 " ]; then
+        echo "log-pipe Test failed: a long line logged as lines of ${LENGTHS}bytes"
+        FAILED=1
+    fi
+
+    rm -rf "${DIR}" /data/doc-root/log/${APP}
+    if [ ${FAILED} -ne 0 ]; then
+        exit 1
+    fi
+    echo "log-pipe Test passed: partial, long and unterminated lines."
+}
+test_log_pipe "$1"
@@ -0,0 +1,97 @@
+#!/bin/sh
+# Writes a past day of log in two segments, each with its .idx sidecar as the sink writes it,
+# then queries ll-log-query across the minute and the segment boundaries, by thread, and
+# again without the sidecars: the lines printed must be the same.
+APP=ll-test-query
+DAY=2026-01-15
+FOLDER=/data/doc-root/log/${APP}
+
+# Writes the 8 bytes of $1 in little endian order
+query_int64() {
+    v=$1
+    for b in 1 2 3 4 5 6 7 8; do
+        printf "\\$(printf %o $((v & 255)))"
+        v=$((v >> 8))
+    done
+}
+
+# Appends a line stamped $2 of thread $3 to the log file $1, with an index entry when the
+# line is the first of its minute in the file
+query_line() {
+    MINUTE=$(date -d "${DAY} $(echo "$2" | cut -c1-5)" +%s)
+    if [ ! -f "$1.idx" ] || [ "$(cat "$1.minute")" != "${MINUTE}" ]; then
+        { query_int64 ${MINUTE}; query_int64 $(wc -c < "$1" 2> /dev/null || echo 0); } >> "$1.idx"
+        echo ${MINUTE} > "$1.minute"
+    fi
+    printf '%s %s %s #42 ]   «%s» %s\n' "${DAY}" "$2" ${APP} "$3" "$4" >> "$1"
+}
+
+# Prints the messages ll-log-query finds for its arguments
+query() {
+    "${DIR}/ll-log-query" --app ${APP} "$@" | sed 's/^[^]]*]   «[^ ]* //'
+}
+
+test_log_query() {
+    TARGET="$(readlink -f "$1")"
+    DIR=$(mktemp -d)
+    LOG=${FOLDER}/${APP}-${DAY}.log
+    LOG1=${FOLDER}/${APP}-${DAY}-1.log
+    ln -s "${TARGET}" "${DIR}/ll-log-query"
+    rm -rf ${FOLDER}
+    mkdir -p ${FOLDER}
+    touch ${LOG} ${LOG1}
+    FAILED=0
+
+    query_line ${LOG} 10:00:05 Thread_a a1
+    query_line ${LOG} 10:00:50 Thread_b b1
+    query_line ${LOG} 10:01:00 Thread_a a2
+    query_line ${LOG} 10:01:59 Thread_b b2
+    query_line ${LOG} 10:02:00 Thread_a a3
+    echo "  continued a3" >> ${LOG}
+    query_line ${LOG1} 10:02:30 Thread_b b3
+    query_line ${LOG1} 10:03:00 Thread_a a4
+    query_line ${LOG1} 10:04:10 Thread_b b4
+    rm -f ${FOLDER}/*.minute
+
+    # A minute, its last second and the first second of the next
+    query --from "${DAY} 10:01" --to "${DAY} 10:02" > "${DIR}/minute"
+    printf 'a2\nb2\na3\n  continued a3\n' > "${DIR}/expected"
+    if ! cmp -s "${DIR}/minute" "${DIR}/expected"; then
+        echo "log-query Test failed: from 10:01 to 10:02, printed"
+        cat "${DIR}/minute"
+        FAILED=1
+    fi
+
+    # Across the segments, entered at the index of the minute before
+    query --from "${DAY} 10:01:59" --to "${DAY} 10:03:00" > "${DIR}/segments"
+    printf 'b2\na3\n  continued a3\nb3\na4\n' > "${DIR}/expected"
+    if ! cmp -s "${DIR}/segments" "${DIR}/expected"; then
+        echo "log-query Test failed: from 10:01:59 to 10:03:00, printed"
+        cat "${DIR}/segments"
+        FAILED=1
+    fi
+
+    query --from "${DAY} 10:00" --to "${DAY} 10:05" --thread Thread_a > "${DIR}/thread"
+    printf 'a1\na2\na3\n  continued a3\na4\n' > "${DIR}/expected"
+    if ! cmp -s "${DIR}/thread" "${DIR}/expected"; then
+        echo "log-query Test failed: the lines of Thread_a printed as"
+        cat "${DIR}/thread"
+        FAILED=1
+    fi
+
+    # Read from the top, the files give the same lines
+    rm -f ${FOLDER}/*.idx
+    query --from "${DAY} 10:01:59" --to "${DAY} 10:03:00" > "${DIR}/unindexed"
+    if ! cmp -s "${DIR}/segments" "${DIR}/unindexed"; then
+        echo "log-query Test failed: without the index, from 10:01:59 to 10:03:00, printed"
+        cat "${DIR}/unindexed"
+        FAILED=1
+    fi
+
+    rm -rf "${DIR}" ${FOLDER}
+    if [ ${FAILED} -ne 0 ]; then
+        exit 1
+    fi
+    echo "log-query Test passed: minute and segment boundaries, with and without the index, by thread."
+}
+test_log_query "$1"
@@ -0,0 +1,50 @@
+#!/bin/sh
+# Logs with ll-log-msg while the daemon runs: the daemon writes the one line, through the log
+# file it keeps open. Once the daemon is gone, ll-log-msg writes the file itself.
+test_log_socket() {
+    TARGET="$(readlink -f "$1")"
+    APP=ll-test-socket
+    DIR=$(mktemp -d)
+    LOG=/data/doc-root/log/${APP}/${APP}-$(date +%Y-%m-%d).log
+    ln -s "${TARGET}" "${DIR}/ll-log-msg"
+    rm -rf /data/doc-root/log/${APP}
+    FAILED=0
+
+    "${TARGET}" run /bin/sh -c "sleep 120" > /dev/null 2>&1 &
+    LL=$!
+    for i in 1 2 3 4 5 6 7 8 9 10 11 12 13 14 15 16 17 18 19 20; do
+        if [ -f /run/life-line/ready ]; then
+            break
+        fi
+        sleep 0.5
+    done
+    "${DIR}/ll-log-msg" ${APP} "through the daemon"
+    sleep 0.5
+    if [ "$(sed 's/^[^]]*] //' "${LOG}" 2> /dev/null)" != "through the daemon" ] ||
+        ! ls -l /proc/${LL}/fd | grep -q "${LOG}\$"; then
+        echo "log-socket Test failed: with the daemon running, the log holds"
+        cat "${LOG}"
+        FAILED=1
+    fi
+    kill -TERM ${LL}
+    wait ${LL}
+
+    rm -rf /data/doc-root/log/${APP}
+    if [ -e /run/life-line/log.sock ]; then
+        echo "log-socket Test failed: /run/life-line/log.sock left behind by the daemon"
+        FAILED=1
+    fi
+    "${DIR}/ll-log-msg" ${APP} "written directly"
+    if [ "$(sed 's/^[^]]*] //' "${LOG}" 2> /dev/null)" != "written directly" ]; then
+        echo "log-socket Test failed: without a daemon, the log holds"
+        cat "${LOG}"
+        FAILED=1
+    fi
+
+    rm -rf "${DIR}" /data/doc-root/log/${APP}
+    if [ ${FAILED} -ne 0 ]; then
+        exit 1
+    fi
+    echo "log-socket Test passed: one line through the daemon, written directly without it."
+}
+test_log_socket "$1"
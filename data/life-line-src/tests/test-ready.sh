@@ -0,0 +1,27 @@
+#!/bin/sh
+# Starts the daemon, waits for its readiness file, then runs `life-line timing` beside it: the
+# file must still be there, with the pid of the daemon, and go away when the daemon stops.
+test_ready() {
+    TARGET="$1"
+    READY=/run/life-line/ready
+    "${TARGET}" run /bin/sh -c "sleep 120" > /dev/null 2>&1 &
+    LL=$!
+    for i in 1 2 3 4 5 6 7 8 9 10 11 12 13 14 15 16 17 18 19 20; do
+        if [ -f ${READY} ]; then
+            break
+        fi
+        sleep 0.5
+    done
+    BEFORE=$(cat ${READY} 2> /dev/null)
+    timeout 30 "${TARGET}" timing > /dev/null 2>&1
+    AFTER=$(cat ${READY} 2> /dev/null)
+    kill -TERM ${LL}
+    wait ${LL}
+    if [ "${BEFORE}" = "${LL}" ] && [ "${AFTER}" = "${LL}" ] && [ ! -f ${READY} ]; then
+        echo "ready Test passed: ${READY} kept by the daemon while life-line timing ran."
+    else
+        echo "ready Test failed: ${READY} held '${BEFORE}', then '${AFTER}' after life-line timing, for pid ${LL}."
+        exit 1
+    fi
+}
+test_ready "$1"
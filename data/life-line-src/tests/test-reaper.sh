@@ -0,0 +1,28 @@
+#!/bin/sh
+# Spawns thousands of short-lived orphans under `life-line run` and checks that the process
+# table stays flat: none of them may be left as a zombie of life-line.
+test_reaper() {
+    TARGET="$1"
+    COUNT="${2:-3000}"
+    "${TARGET}" run /bin/sh -c "i=0; while [ \$i -lt ${COUNT} ]; do (sleep 0 &); i=\$((i+1)); done; sleep 60" > /dev/null 2>&1 &
+    LL=$!
+    MAX=0
+    # Sample the zombies while the orphans come and go
+    for i in 1 2 3 4 5 6 7 8 9 10 11 12 13 14 15 16 17 18 19 20; do
+        sleep 0.5
+        ZOMBIES=$(ps -o stat= --ppid ${LL} | grep -c '^Z')
+        if [ ${ZOMBIES} -gt ${MAX} ]; then
+            MAX=${ZOMBIES}
+        fi
+    done
+    ZOMBIES=$(ps -o stat= --ppid ${LL} | grep -c '^Z')
+    kill -TERM ${LL}
+    wait ${LL}
+    if [ ${ZOMBIES} -eq 0 ] && [ ${MAX} -lt 50 ]; then
+        echo "reaper Test passed: ${COUNT} orphans, at most ${MAX} zombies at a time."
+    else
+        echo "reaper Test failed: ${ZOMBIES} zombies left, at most ${MAX} at a time."
+        exit 1
+    fi
+}
+test_reaper "$1" "$2"
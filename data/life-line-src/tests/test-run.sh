@@ -0,0 +1,77 @@
+#!/bin/sh
+# Supervises a command that writes to stdout and stderr and fails every time: it must be
+# restarted after 1 s, then 2 s, until LL_RUN_CRASH_LOOP stops it, with its output in the
+# -stdout.log and -stderr.log files. A command that succeeds is not restarted.
+APP=ll-test-run
+
+# Runs the daemon on the command until the supervisor logs $1, and 1.5 s more to catch a
+# restart, then keeps its lines of the life-line log in ${DIR}/raw, and without their prefix
+# in ${DIR}/run
+run_until() {
+    UNTIL="$1"
+    shift
+    FROM=$(($(wc -l < "${SELF_LOG}") + 1))
+    LL_RUN_APP=${APP} LL_RUN_CRASH_LOOP=3/60 "${TARGET}" run "$@" > /dev/null 2>&1 &
+    LL=$!
+    for i in $(seq 1 40); do
+        if tail -n +${FROM} "${SELF_LOG}" | grep -q "Supervised ${APP} ${UNTIL}"; then
+            break
+        fi
+        sleep 0.5
+    done
+    sleep 1.5
+    kill -TERM ${LL}
+    wait ${LL}
+    tail -n +${FROM} "${SELF_LOG}" | grep "«Thread_supervise» " > "${DIR}/raw"
+    sed 's/^.*» //' "${DIR}/raw" > "${DIR}/run"
+}
+
+# The epoch second at which run $1 started
+run_started() {
+    date -d "$(grep "» Supervised ${APP} ..Started.. (pid [0-9]*, run $1)" "${DIR}/raw" | cut -c1-19)" +%s
+}
+
+test_run() {
+    TARGET="$(readlink -f "$1")"
+    DIR=$(mktemp -d)
+    FOLDER=/data/doc-root/log/${APP}
+    DAY=$(date +%Y-%m-%d)
+    SELF_LOG=/data/doc-root/log/life-line/life-line-${DAY}.log
+    rm -rf ${FOLDER}
+    FAILED=0
+
+    run_until "is in a crash loop" /bin/sh -c 'echo "out $$"; echo "err $$" >&2; exit 3'
+    STARTS=$(grep -c "^Supervised ${APP} ..Started.. " "${DIR}/run")
+    FIRST=$(run_started 1)
+    SECOND=$(run_started 2)
+    THIRD=$(run_started 3)
+    if [ ${STARTS} -ne 3 ] || ! grep -q "^Restarting ${APP} in 1000 ms\$" "${DIR}/run" ||
+        ! grep -q "^Restarting ${APP} in 2000 ms\$" "${DIR}/run" ||
+        ! grep -q "^Supervised ${APP} is in a crash loop: 3 failed runs within 60 s, restarts ..Stopped..\$" "${DIR}/run" ||
+        [ $((SECOND - FIRST)) -lt 1 ] || [ $((THIRD - SECOND)) -lt 2 ]; then
+        echo "run Test failed: a failing command was supervised as"
+        cat "${DIR}/run"
+        FAILED=1
+    fi
+    if [ $(grep -c "^out [0-9]*\$" ${FOLDER}/${APP}-${DAY}-stdout.log) -ne 3 ] ||
+        [ $(grep -c "^err [0-9]*\$" ${FOLDER}/${APP}-${DAY}-stderr.log) -ne 3 ] ||
+        [ $(sort -u ${FOLDER}/${APP}-${DAY}-stdout.log | wc -l) -ne 3 ]; then
+        echo "run Test failed: the output of 3 runs was logged as"
+        cat ${FOLDER}/${APP}-${DAY}-stdout.log ${FOLDER}/${APP}-${DAY}-stderr.log
+        FAILED=1
+    fi
+
+    run_until "ended after" /bin/sh -c 'exit 0'
+    if [ $(grep -c "^Supervised ${APP} ..Started.. " "${DIR}/run") -ne 1 ] || grep -q "^Restarting " "${DIR}/run"; then
+        echo "run Test failed: a command that succeeded was supervised as"
+        cat "${DIR}/run"
+        FAILED=1
+    fi
+
+    rm -rf "${DIR}" ${FOLDER}
+    if [ ${FAILED} -ne 0 ]; then
+        exit 1
+    fi
+    echo "run Test passed: restarts after 1 s and 2 s, crash loop stopped at 3 runs, output logged."
+}
+test_run "$1"
@@ -0,0 +1,53 @@
+#!/bin/sh
+# Mounts a small tmpfs on the log folder of the test and fills it up, then logs more lines
+# through ll-log-pipe than the spill queue holds, and frees the space while ll-log-pipe still
+# runs: the newest lines must be written back in order and the outage noted with the drops.
+test_spill() {
+    TARGET="$(readlink -f "$1")"
+    APP=ll-test-spill
+    DIR=$(mktemp -d)
+    FOLDER=/data/doc-root/log/${APP}
+    LOG=${FOLDER}/${APP}-$(date +%Y-%m-%d).log
+    SELF_LOG=/data/doc-root/log/life-line/life-line-$(date +%Y-%m-%d).log
+    ln -s "${TARGET}" "${DIR}/ll-log-pipe"
+    rm -rf ${FOLDER}
+    mkdir -p ${FOLDER}
+    if ! mount -t tmpfs -o size=4m tmpfs ${FOLDER}; then
+        rm -rf "${DIR}" ${FOLDER}
+        echo "spill Test failed: a tmpfs cannot be mounted on ${FOLDER}"
+        exit 1
+    fi
+    FAILED=0
+    dd if=/dev/zero of=${FOLDER}/fill bs=4k 2> /dev/null
+
+    # 5000 lines of 300 bytes while the volume is full: the queue keeps the newest 1 MB of them
+    {
+        seq 1 5000 | awk '{ printf "line %d %300s\n", $1, "" }' | tr ' ' '.'
+        sleep 1
+        rm -f ${FOLDER}/fill
+        sleep 1
+        echo "line 5001"
+    } | "${DIR}/ll-log-pipe" ${APP}
+
+    sed 's/^[^]]*] //; s/\.*$//; s/\./ /' "${LOG}" > "${DIR}/messages"
+    FIRST=$(head -n 1 "${DIR}/messages" | sed 's/^line //')
+    DROPPED=$((FIRST - 1))
+    seq ${FIRST} 5001 | sed 's/^/line /' > "${DIR}/expected"
+    if ! cmp -s "${DIR}/messages" "${DIR}/expected" || [ ${DROPPED} -lt 1000 ]; then
+        echo "spill Test failed: $(wc -l < "${DIR}/messages") lines written, from '$(head -n 1 "${DIR}/messages")' to '$(tail -n 1 "${DIR}/messages")'"
+        FAILED=1
+    fi
+    if ! tail -n 20 "${SELF_LOG}" | grep -q "] Log spill: the log volume was unwritable for [0-9.]* s, [0-9]* lines replayed, ${DROPPED} dropped\$"; then
+        echo "spill Test failed: no note of the outage with ${DROPPED} lines dropped"
+        tail -n 5 "${SELF_LOG}"
+        FAILED=1
+    fi
+
+    umount ${FOLDER}
+    rm -rf "${DIR}" ${FOLDER}
+    if [ ${FAILED} -ne 0 ]; then
+        exit 1
+    fi
+    echo "spill Test passed: ${DROPPED} lines dropped, the newest written back in order once the volume had room."
+}
+test_spill "$1"
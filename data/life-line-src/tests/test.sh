@@ -1,13 +1,14 @@
 #!/bin/sh
 test_main() {
     TARGET="$1"
+    RESULT_FILE="${RESULT_FILE:-/tmp/life-line-test-result}"
     # Read test cases from file
     while IFS= read -r line; do
         ID=$(echo $line | cut -d'|' -f1)
         SW=$(echo $line | cut -d'|' -f2)
         EXPECTED_RESULT=$(echo $line | cut -d'|' -f3)
         if [ ! -z "$ID" ]; then
-            rm ${RESULT_FILE}
+            rm -f ${RESULT_FILE}
             touch ${RESULT_FILE}
             # Run the compiled binary with the test case
             /bin/sh -c "${TARGET} \"${SW}\" > ${RESULT_FILE}"